@@ -1,4 +1,5 @@
 #include "AttoAsset.h"
+#include "AttoJobs.h"
 
 #define STB_VORBIS_HEADER_ONLY
 #include "stb_vorbis/stb_vorbis.c"
@@ -6,16 +7,59 @@
 #include <audio/AudioFile.h>
 #include <json/json.hpp>
 
+#include <chrono>
 #include <filesystem>
 #include <random>
 
 #define rgba(r, g, b, a) glm::vec4( (f32)r / 255.0f, (f32)g / 255.0f, (f32)b / 255.0f, a )
 
 namespace atto {
-    static void FindAllFiles(const char* path, const char* extension, List<LargeString>& files) {
-        for (const auto& entry : std::filesystem::recursive_directory_iterator(path)) {
-            if (entry.path().extension() == extension) {
-                files.Add(LargeString::FromLiteral(entry.path().string().c_str()));
+    // Everything found under one top level directory.
+    struct AssetScanBatch {
+        LargeString                     directory;
+        List<AssetManifestEntry>        entries;
+        List<AssetManifestDirectory>    directories;
+    };
+
+    static StringAtom AssetScanInternPath(const std::filesystem::path& path) {
+        LargeString pathString = LargeString::FromLiteral(path.string().c_str());
+        pathString.BackSlashesToSlashes();
+        return StringAtom::Intern(pathString.GetCStr());
+    }
+
+    static void AssetScanAddDirectory(AssetScanBatch& batch, const std::filesystem::directory_entry& entry) {
+        AssetManifestDirectory directory = {};
+        directory.path = AssetScanInternPath(entry.path());
+        directory.writeTime = (i64)entry.last_write_time().time_since_epoch().count();
+        batch.directories.Add(directory);
+    }
+
+    static void AssetScanAddFile(AssetScanBatch& batch, const std::filesystem::directory_entry& entry) {
+        const AssetType assetType = AssetTypeFromExtension(entry.path().extension().string().c_str());
+        if (assetType == ASSET_TYPE_INVALID) {
+            return;
+        }
+
+        AssetManifestEntry asset = {};
+        asset.type = assetType;
+        asset.path = AssetScanInternPath(entry.path());
+        asset.sizeBytes = (u64)entry.file_size();
+        asset.writeTime = (i64)entry.last_write_time().time_since_epoch().count();
+        asset.id = AssetIdFromPath(asset.path.GetCStr());
+
+        batch.entries.Add(asset);
+    }
+
+    // Job entry point, walks one top level directory. userData is the AssetScanBatch array.
+    static void AssetScanDirectory(i32 index, void* userData) {
+        AssetScanBatch& batch = ((AssetScanBatch*)userData)[index];
+        AssetScanAddDirectory(batch, std::filesystem::directory_entry(batch.directory.GetCStr()));
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(batch.directory.GetCStr())) {
+            if (entry.is_directory()) {
+                AssetScanAddDirectory(batch, entry);
+            }
+            else if (entry.is_regular_file()) {
+                AssetScanAddFile(batch, entry);
             }
         }
     }
@@ -167,7 +211,14 @@ namespace atto {
         entity.pos = glm::vec3(0, 0, 0);
         entity.ori = glm::basis::identity();
         entity.material = Material::CreateDefault();
-        return entities.Add(entity);
+        
+        EntityRef ref = entities.Add(entity);
+        Entity* result = entities.Get(ref);
+        if (result != nullptr) {
+            result->ref = ref;
+        }
+
+        return result;
     }
 
     Entity* LeEngine::EntityCreateProptypeWall(glm::vec2 pos) {
@@ -180,6 +231,14 @@ namespace atto {
         return wall;
     }
 
+    Entity* LeEngine::EntityGet(EntityRef ref) {
+        return entities.Get(ref);
+    }
+
+    void LeEngine::EntityDestroy(EntityRef ref) {
+        entities.Remove(ref);
+    }
+
     void LeEngine::UnitSetPos(Entity* unit, glm::vec2 pos) {
         unit->unit.pos = pos;
         unit->pos = glm::vec3(pos.x, 0, pos.y);
@@ -230,6 +289,10 @@ namespace atto {
     bool LeEngine::Initialize(AppState* appState) {
         app = appState;
 
+        io.Initialize();
+        if (app->useDerivedDataCache) {
+            derivedData.Open(app->derivedDataCachePath.GetCStr(), app->derivedDataCacheBytes);
+        }
         RegisterAssets();
         InitializeRenderer();
         InitializeDebug();
@@ -244,16 +307,23 @@ namespace atto {
         CameraSet(gameCamera);
         screenProjection = glm::orthoLH_ZO(0.0f, (f32)renderer.swapChainWidth, (f32)renderer.swapChainHeight, 0.0f, 0.0f, 1.0f);
 
-        buildingBase_01     = LoadMeshAsset(MeshAssetId::Create("assets/prototype/SM_Buildings_Block_Base_01"));
-        buildingBlock1x1_01 = LoadMeshAsset(MeshAssetId::Create("assets/prototype/SM_Buildings_Block_1x1_01"));
-        buildingBlock1x1_02 = LoadMeshAsset(MeshAssetId::Create("assets/prototype/SM_Buildings_Block_1x1_02"));
-        buildingBlock1x1_03 = LoadMeshAsset(MeshAssetId::Create("assets/prototype/SM_Buildings_Block_1x1_03"));
-        tank_01             = LoadMeshAsset(MeshAssetId::Create("assets/tanks/tank_01"));
-        primitiveCapsule    = LoadMeshAsset(MeshAssetId::Create("assets/primitives/capsule"));
+        buildingBase_01     = LoadMeshAssetAsync(MeshAssetId::Create("assets/prototype/SM_Buildings_Block_Base_01"));
+        buildingBlock1x1_01 = LoadMeshAssetAsync(MeshAssetId::Create("assets/prototype/SM_Buildings_Block_1x1_01"));
+        buildingBlock1x1_02 = LoadMeshAssetAsync(MeshAssetId::Create("assets/prototype/SM_Buildings_Block_1x1_02"));
+        buildingBlock1x1_03 = LoadMeshAssetAsync(MeshAssetId::Create("assets/prototype/SM_Buildings_Block_1x1_03"));
+        tank_01             = LoadMeshAssetAsync(MeshAssetId::Create("assets/tanks/tank_01"));
+        primitiveCapsule    = LoadMeshAssetAsync(MeshAssetId::Create("assets/primitives/capsule"));
         
-        textureGrid_01          = LoadTextureAsset(TextureAssetId::Create("assets/prototype/Texture_Grid_01"));
-        textureTriplanarTest    = LoadTextureAsset(TextureAssetId::Create("assets/prototype/Texture_Triplanar_Test"));
-        textureBaseTank         = LoadTextureAsset(TextureAssetId::Create("assets/tanks/textures/TF_TankFree_Base_Color_Y"));
+        const TextureAssetId textureIds[] = {
+            TextureAssetId::Create("assets/prototype/Texture_Grid_01"),
+            TextureAssetId::Create("assets/prototype/Texture_Triplanar_Test"),
+            TextureAssetId::Create("assets/tanks/textures/TF_TankFree_Base_Color_Y"),
+        };
+        TextureAsset* textures[3] = {};
+        LoadTextureAssets(textureIds, 3, textures);
+        textureGrid_01          = textures[0];
+        textureTriplanarTest    = textures[1];
+        textureBaseTank         = textures[2];
 
 #if 1
         Entity* ground = EntityCreate();
@@ -383,11 +453,17 @@ namespace atto {
         }
 
         //UIResetContext(editorState.uiContext);
-        //UIBeginWindow(editorState.uiContext, "Test", glm::vec2(0), glm::vec2(200, 200));
+        //static const StringAtom testWindowTitle = StringAtom::Intern("Test");
+        //UIBeginWindow(editorState.uiContext, testWindowTitle, glm::vec2(0), glm::vec2(200, 200));
         //UIEndWindow(editorState.uiContext);
     }
 
     void LeEngine::Render(AppState* app) {
+        frameIndex++;
+        io.Poll();
+        MeshUpdateLoads(false);
+        AssetEvictToBudget(app->assetMemoryBudgetBytes);
+
         D3D11_VIEWPORT viewport = {};
         viewport.TopLeftX = 0;
         viewport.TopLeftY = 0;
@@ -420,15 +496,30 @@ namespace atto {
             ShaderBufferUpload(renderer.shaderBufferCamera);
 
 #if 1
+            // Quantized meshes need their own input layout, only switch when the format changes.
+            ShaderAsset* boundShader = &renderer.testingShader;
             const i32 entityCount = entities.GetCount();
             for (i32 entityIndex = 0; entityIndex < entityCount; entityIndex++) {
                 Entity& entity = entities[entityIndex];
                 Material& material = entity.material;
-                if (material.mesh != nullptr) {
+                MeshAsset* mesh = material.mesh != nullptr && material.mesh->isLoaded == false ? &renderer.unitCube : material.mesh;
+                if (mesh != nullptr) {
+                    material.mesh->lastUsedFrame = frameIndex;
                     glm::mat4 tranformMatrix = glm::translate(glm::mat4(1), entity.pos) * glm::toMat4(entity.ori);
                     renderer.shaderBufferInstance.data.model = tranformMatrix;
                     renderer.shaderBufferInstance.data.mvp = renderer.shaderBufferCamera.data.projection * renderer.shaderBufferCamera.data.view * renderer.shaderBufferInstance.data.model;
 
+                    const MeshQuantization& quantization = mesh->quantization;
+                    renderer.shaderBufferInstance.data.positionOffset = glm::vec4(quantization.positionOffset[0], quantization.positionOffset[1], quantization.positionOffset[2], 0.0f);
+                    renderer.shaderBufferInstance.data.positionScale = glm::vec4(quantization.positionScale[0], quantization.positionScale[1], quantization.positionScale[2], 0.0f);
+                    renderer.shaderBufferInstance.data.uvOffsetScale = glm::vec4(quantization.uvOffset[0], quantization.uvOffset[1], quantization.uvScale[0], quantization.uvScale[1]);
+
+                    ShaderAsset* shader = MeshGetShader(mesh);
+                    if (shader != boundShader) {
+                        ShaderBind(*shader);
+                        boundShader = shader;
+                    }
+
                     renderer.shaderBufferMaterial.data.settings.x = material.useTriplanar ? 1.0f : 0.0f;
                     renderer.shaderBufferMaterial.data.settings.y = material.diffuseMap == nullptr ? 0.0f : 1.0f;
                     renderer.shaderBufferMaterial.data.diffuseColor = material.diffuseColor;
@@ -437,11 +528,12 @@ namespace atto {
                     ShaderBufferUpload(renderer.shaderBufferMaterial);
 
                     if (material.diffuseMap) {
+                        material.diffuseMap->lastUsedFrame = frameIndex;
                         TextureBind(material.diffuseMap, 0);
                     }
 
-                    MeshBind(material.mesh);
-                    MeshDraw(material.mesh);
+                    MeshBind(mesh);
+                    MeshDraw(mesh);
                 }
             }
 #else 
@@ -475,7 +567,11 @@ namespace atto {
     }
 
     void LeEngine::Shutdown() {
-
+        // The workers still point at the meshes, let them finish before anything goes away.
+        MeshUpdateLoads(true);
+        io.Shutdown();
+        derivedData.Close();
+        files.CloseAll();
     }
 
     void LeEngine::CallbackResize(i32 width, i32 height) {
@@ -538,26 +634,102 @@ namespace atto {
     }
 
     MeshAsset* LeEngine::LoadMeshAsset(MeshAssetId id) {
-        MeshAsset* meshAsset = FindAsset(meshAssets, id.ToRawId());
+        MeshAsset* meshAsset = FindAsset(meshAssets, meshAssetLookup, id.ToRawId());
         if (meshAsset == nullptr) {
             return nullptr;
         }
 
+        meshAsset->refCount++;
+        meshAsset->lastUsedFrame = frameIndex;
+
         if (meshAsset->isLoaded) {
             return meshAsset;
         }
 
+        if (meshAsset->isLoading) {
+            // Already queued, finish it now instead of importing it twice.
+            const i32 jobCount = meshLoadJobs.GetCount();
+            for (i32 jobIndex = 0; jobIndex < jobCount; jobIndex++) {
+                MeshLoadJob* job = meshLoadJobs[jobIndex];
+                if (job->mesh == meshAsset) {
+                    MeshWaitForLoad(*job);
+                    MeshFinishLoad(*job);
+                    meshLoadJobs.RemoveIndex(jobIndex);
+                    delete job;
+                    break;
+                }
+            }
+
+            return meshAsset;
+        }
+
         MeshCreate(*meshAsset);
 
         return meshAsset;
     }
 
+    MeshAsset* LeEngine::LoadMeshAssetAsync(MeshAssetId id) {
+        MeshAsset* meshAsset = FindAsset(meshAssets, meshAssetLookup, id.ToRawId());
+        if (meshAsset == nullptr) {
+            return nullptr;
+        }
+
+        meshAsset->refCount++;
+        meshAsset->lastUsedFrame = frameIndex;
+
+        if (meshAsset->isLoaded || meshAsset->isLoading) {
+            return meshAsset;
+        }
+
+        if (app->useAsyncMeshLoading) {
+            MeshCreateAsync(*meshAsset);
+        }
+        else {
+            MeshCreate(*meshAsset);
+        }
+
+        return meshAsset;
+    }
+
+    void LeEngine::MeshUpdateLoads(bool waitForAll) {
+        // Buffers are created in the order the loads were started, until the frame's budget runs out.
+        const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        const f64 budgetMS = (f64)app->meshUploadBudgetMS;
+        i32 finishedCount = 0;
+        i32 jobIndex = 0;
+        while (jobIndex < meshLoadJobs.GetCount()) {
+            MeshLoadJob* job = meshLoadJobs[jobIndex];
+            if (waitForAll) {
+                MeshWaitForLoad(*job);
+            }
+            else if (job->isReading || job->counter.value.load(std::memory_order_acquire) > 0) {
+                jobIndex++;
+                continue;
+            }
+
+            if (waitForAll == false && finishedCount > 0) {
+                const f64 elapsedMS = (f64)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count() / 1000.0;
+                if (elapsedMS >= budgetMS) {
+                    break;
+                }
+            }
+
+            MeshFinishLoad(*job);
+            meshLoadJobs.RemoveIndex(jobIndex);
+            delete job;
+            finishedCount++;
+        }
+    }
+
     TextureAsset* LeEngine::LoadTextureAsset(TextureAssetId id) {
-        TextureAsset* textureAsset = FindAsset(textureAssets, id.ToRawId());
+        TextureAsset* textureAsset = FindAsset(textureAssets, textureAssetLookup, id.ToRawId());
         if (textureAsset == nullptr) {
             return nullptr;
         }
 
+        textureAsset->refCount++;
+        textureAsset->lastUsedFrame = frameIndex;
+
         if (textureAsset->isLoaded) {
             return textureAsset;
         }
@@ -567,16 +739,211 @@ namespace atto {
         return textureAsset;
     }
     
+    void LeEngine::LoadTextureAssets(const TextureAssetId* ids, i32 count, TextureAsset** textures) {
+        ScratchScope scratch;
+        TextureImportRequest* requests = Memory::AllocateScratchStruct<TextureImportRequest>(count);
+        TextureAsset** decoding = Memory::AllocateScratchStruct<TextureAsset*>(count);
+        // Mappings and payloads must outlive TextureImportBatch, they are built in place and destructed by hand.
+        MappedFile* looseFiles = Memory::AllocateScratchStruct<MappedFile>(count);
+        List<byte>* payloads = Memory::AllocateScratchStruct<List<byte>>(count);
+        for (i32 textureIndex = 0; textureIndex < count; textureIndex++) {
+            new (looseFiles + textureIndex) MappedFile();
+            new (payloads + textureIndex) List<byte>();
+        }
+
+        // Cooked textures need no decoding and are created right away.
+        i32 requestCount = 0;
+        for (i32 textureIndex = 0; textureIndex < count; textureIndex++) {
+            TextureAsset* texture = FindAsset(textureAssets, textureAssetLookup, ids[textureIndex].ToRawId());
+            textures[textureIndex] = texture;
+            if (texture == nullptr) {
+                continue;
+            }
+
+            texture->refCount++;
+            texture->lastUsedFrame = frameIndex;
+            if (texture->isLoaded || TextureShare(*texture)) {
+                continue;
+            }
+
+            const byte* data = nullptr;
+            u64 sizeBytes = 0;
+            TextureGetSource(*texture, looseFiles[textureIndex], payloads[textureIndex], data, sizeBytes);
+
+            CookedTexture cooked = {};
+            if (data != nullptr && CookedTextureRead(data, sizeBytes, cooked)) {
+                TextureCreateFromCooked(*texture, cooked);
+                continue;
+            }
+
+            TextureImportRequest& request = requests[requestCount];
+            request = {};
+            request.data = data;
+            request.sizeBytes = sizeBytes;
+            decoding[requestCount] = texture;
+            requestCount++;
+        }
+
+        TextureImportBatch(requests, requestCount);
+
+        // Creating the textures has to stay on this thread.
+        for (i32 requestIndex = 0; requestIndex < requestCount; requestIndex++) {
+            const TextureImportRequest& request = requests[requestIndex];
+            // Duplicates within the batch were all decoded, only the first one is created.
+            if (TextureShare(*decoding[requestIndex]) == false) {
+                TextureCreateFromImage(*decoding[requestIndex], request.pixels, request.width, request.height, request.channels);
+            }
+            if (request.pixels != nullptr) {
+                TextureImportFree(request.pixels);
+            }
+        }
+
+        for (i32 textureIndex = 0; textureIndex < count; textureIndex++) {
+            looseFiles[textureIndex].~MappedFile();
+            payloads[textureIndex].~List<byte>();
+        }
+    }
+
     FontAsset* LeEngine::LoadFontAsset(FontAssetId id) {
         return nullptr;
     }
 
     AudioAsset* LeEngine::LoadAudioAsset(AudioAssetId id) {
-        return nullptr;
+        AudioAsset* audioAsset = FindAsset(audioAssets, audioAssetLookup, id.ToRawId());
+        if (audioAsset == nullptr) {
+            return nullptr;
+        }
+
+        audioAsset->refCount++;
+        audioAsset->lastUsedFrame = frameIndex;
+        if (audioAsset->sizeBytes == 0) {
+            AudioCreate(*audioAsset);
+            assetMemory.audioBytes += (u64)audioAsset->sizeBytes;
+        }
+
+        return audioAsset;
+    }
+
+    void LeEngine::FreeMeshAsset(MeshAssetId id) {
+        MeshAsset* meshAsset = FindAsset(meshAssets, meshAssetLookup, id.ToRawId());
+        if (meshAsset == nullptr) {
+            return;
+        }
+
+        Assert(meshAsset->refCount > 0, "Freeing a mesh asset more often than it was loaded");
+        meshAsset->refCount--;
+    }
+
+    void LeEngine::FreeTextureAsset(TextureAssetId id) {
+        TextureAsset* textureAsset = FindAsset(textureAssets, textureAssetLookup, id.ToRawId());
+        if (textureAsset == nullptr) {
+            return;
+        }
+
+        Assert(textureAsset->refCount > 0, "Freeing a texture asset more often than it was loaded");
+        textureAsset->refCount--;
+    }
+
+    void LeEngine::FreeAudioAsset(AudioAssetId id) {
+        AudioAsset* audioAsset = FindAsset(audioAssets, audioAssetLookup, id.ToRawId());
+        if (audioAsset == nullptr) {
+            return;
+        }
+
+        Assert(audioAsset->refCount > 0, "Freeing an audio asset more often than it was loaded");
+        audioAsset->refCount--;
+    }
+
+    const AssetMemory& LeEngine::AssetGetMemory() const {
+        return assetMemory;
+    }
+
+    // Something AssetEvictToBudget may unload, index is into the list for type.
+    struct AssetEvictCandidate {
+        u64         lastUsedFrame;
+        AssetType   type;
+        i32         index;
+    };
+
+    void LeEngine::AssetEvictToBudget(u64 budgetBytes) {
+        const u64 usedBytes = assetMemory.GetTotalBytes();
+        if (usedBytes <= budgetBytes) {
+            assetOverBudget = false;
+            return;
+        }
+
+        // Runs once a frame on the main thread, the candidates go away with the next Memory::ResetFrame.
+        TransientList<AssetEvictCandidate> candidates(Memory::GetFrameArena(), meshAssets.GetCount() + textureAssets.GetCount() + audioAssets.GetCount());
+
+        // Meshes still being imported are skipped, their job points at them.
+        const i32 meshCount = meshAssets.GetCount();
+        for (i32 meshIndex = 0; meshIndex < meshCount; meshIndex++) {
+            const MeshAsset& mesh = meshAssets[meshIndex];
+            if (mesh.refCount == 0 && mesh.isLoaded && mesh.isLoading == false) {
+                candidates.Add({ mesh.lastUsedFrame, ASSET_TYPE_MESH, meshIndex });
+            }
+        }
+
+        const i32 textureCount = textureAssets.GetCount();
+        for (i32 textureIndex = 0; textureIndex < textureCount; textureIndex++) {
+            const TextureAsset& texture = textureAssets[textureIndex];
+            if (texture.refCount == 0 && texture.isLoaded) {
+                candidates.Add({ texture.lastUsedFrame, ASSET_TYPE_TEXTURE, textureIndex });
+            }
+        }
+
+        const i32 audioCount = audioAssets.GetCount();
+        for (i32 audioIndex = 0; audioIndex < audioCount; audioIndex++) {
+            const AudioAsset& audio = audioAssets[audioIndex];
+            if (audio.refCount == 0 && audio.sizeBytes > 0) {
+                candidates.Add({ audio.lastUsedFrame, ASSET_TYPE_AUDIO, audioIndex });
+            }
+        }
+
+        RadixSort(candidates.GetData(), candidates.GetCount(), [](const AssetEvictCandidate& candidate) { return candidate.lastUsedFrame; });
+
+        i32 evictedCount = 0;
+        const i32 candidateCount = candidates.GetCount();
+        for (i32 candidateIndex = 0; candidateIndex < candidateCount && assetMemory.GetTotalBytes() > budgetBytes; candidateIndex++) {
+            const AssetEvictCandidate& candidate = candidates[candidateIndex];
+            switch (candidate.type)
+            {
+            case ASSET_TYPE_MESH:
+            {
+                ATTOTRACE("Evicting mesh: %s", meshAssets[candidate.index].path.GetCStr());
+                MeshDestroy(meshAssets[candidate.index]);
+            }break;
+            case ASSET_TYPE_TEXTURE:
+            {
+                ATTOTRACE("Evicting texture: %s", textureAssets[candidate.index].path.GetCStr());
+                TextureDestroy(textureAssets[candidate.index]);
+            }break;
+            case ASSET_TYPE_AUDIO:
+            {
+                ATTOTRACE("Evicting audio: %s", audioAssets[candidate.index].path.GetCStr());
+                AudioDestroy(audioAssets[candidate.index]);
+            }break;
+            default: break;
+            }
+
+            evictedCount++;
+        }
+
+        // This runs every frame, only log when something changed.
+        if (evictedCount > 0) {
+            ATTOINFO("Evicted %d assets, %llu of %llu bytes in use, meshes %llu, textures %llu, audio %llu, budget %llu",
+                evictedCount, assetMemory.GetTotalBytes(), usedBytes, assetMemory.meshBytes, assetMemory.textureBytes, assetMemory.audioBytes, budgetBytes);
+        }
+
+        const bool overBudget = assetMemory.GetTotalBytes() > budgetBytes;
+        if (overBudget && assetOverBudget == false) {
+            ATTOWARN("Referenced assets alone are over the asset memory budget, %llu of %llu bytes", assetMemory.GetTotalBytes(), budgetBytes);
+        }
+        assetOverBudget = overBudget;
     }
 
     void LeEngine::UIResetContext(UIContext& context) {
-        context.font = FindAsset(fontAssets, FontAssetId::Create("assets/fonts/Roboto_Regular").ToRawId());
+        context.font = FindAsset(fontAssets, fontAssetLookup, FontAssetId::Create("assets/fonts/Roboto_Regular").ToRawId());
         if (context.font->isLoaded == false) {
             FontCreate(*context.font);
         }
@@ -596,7 +963,7 @@ namespace atto {
         }
     }
 
-    void LeEngine::UIBeginWindow(UIContext& context, const char* title, const glm::vec2& firstPos, const glm::vec2& firstSize) {
+    void LeEngine::UIBeginWindow(UIContext& context, StringAtom title, const glm::vec2& firstPos, const glm::vec2& firstSize) {
         UIWindow* window = nullptr;
         const i32 windowCount = context.windows.GetCount();
         for (i32 windowIndex = 0; windowIndex < windowCount; windowIndex++) {
@@ -653,12 +1020,20 @@ namespace atto {
         renderer.context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
         renderer.context->IASetVertexBuffers(0, 1, mesh->vertexBuffer.GetAddressOf(), &mesh->vertexStride, &offset);
         if (mesh->indexBuffer != nullptr) {
-            renderer.context->IASetIndexBuffer(mesh->indexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
+            const DXGI_FORMAT indexFormat = mesh->indexStride == sizeof(u32) ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+            renderer.context->IASetIndexBuffer(mesh->indexBuffer.Get(), indexFormat, 0);
         }
     }
 
     void LeEngine::MeshDraw(MeshAsset* mesh) {
-        if (mesh->indexBuffer != nullptr) {
+        const i32 submeshCount = mesh->submeshes.GetNum();
+        if (mesh->indexBuffer != nullptr && submeshCount > 0) {
+            for (i32 submeshIndex = 0; submeshIndex < submeshCount; submeshIndex++) {
+                const MeshSubmesh& submesh = mesh->submeshes[submeshIndex];
+                renderer.context->DrawIndexed(submesh.indexCount, submesh.indexOffset, (INT)submesh.baseVertex);
+            }
+        }
+        else if (mesh->indexBuffer != nullptr) {
             renderer.context->DrawIndexed(mesh->indexCount, 0, 0);
         }
         else {
@@ -680,82 +1055,158 @@ namespace atto {
         renderer.context->PSSetShaderResources(slot, 1, texture->srv.GetAddressOf());
     }
 
-    void LeEngine::RegisterAssets() {
-        List<LargeString> meshPaths;
-        FindAllFiles(app->looseAssetPath.GetCStr(), ".obj", meshPaths);
-        FindAllFiles(app->looseAssetPath.GetCStr(), ".fbx", meshPaths);
-
-        List<LargeString> texturePaths;
-        FindAllFiles(app->looseAssetPath.GetCStr(), ".png", texturePaths);
-        FindAllFiles(app->looseAssetPath.GetCStr(), ".jpg", texturePaths);
+    void LeEngine::RegisterAssetEntry(const AssetManifestEntry& entry) {
+        switch (entry.type)
+        {
+        case ASSET_TYPE_MESH:
+        {
+            MeshAsset asset = MeshAsset::CreateDefault();
+            asset.id = entry.id;
+            asset.path = entry.path;
+            RegisterAsset(meshAssets, meshAssetLookup, asset);
+            ATTOTRACE("Found mesh asset: %s", entry.path.GetCStr());
+        }break;
+        case ASSET_TYPE_TEXTURE:
+        {
+            TextureAsset asset = TextureAsset::CreateDefault();
+            asset.id = entry.id;
+            asset.path = entry.path;
+            RegisterAsset(textureAssets, textureAssetLookup, asset);
+            ATTOTRACE("Found texture asset: %s", entry.path.GetCStr());
+        }break;
+        case ASSET_TYPE_AUDIO:
+        {
+            AudioAsset asset = AudioAsset::CreateDefault();
+            asset.id = entry.id;
+            asset.path = entry.path;
+            RegisterAsset(audioAssets, audioAssetLookup, asset);
+            ATTOTRACE("Found audio asset: %s", entry.path.GetCStr());
+        }break;
+        case ASSET_TYPE_FONT:
+        {
+            FontAsset asset = FontAsset::CreateDefault();
+            asset.id = entry.id;
+            asset.path = entry.path;
+            RegisterAsset(fontAssets, fontAssetLookup, asset);
+            ATTOTRACE("Found font asset: %s", entry.path.GetCStr());
+        }break;
+        default:
+        {
+            ATTOERROR("Asset %s has an unsupported type %d", entry.path.GetCStr(), (i32)entry.type);
+        }break;
+        }
+    }
 
-        List<LargeString> audioPaths;
-        FindAllFiles(app->looseAssetPath.GetCStr(), ".ogg", audioPaths);
-        FindAllFiles(app->looseAssetPath.GetCStr(), ".wav", audioPaths);
+    bool LeEngine::RegisterPackedAssets(const char* packPath) {
+        std::error_code error;
+        if (std::filesystem::exists(packPath, error) == false) {
+            ATTOINFO("No asset pack at %s, using loose assets", packPath);
+            return false;
+        }
 
-        List<LargeString> fontPaths;
-        FindAllFiles(app->looseAssetPath.GetCStr(), ".ttf", fontPaths);
+        if (assetPack.Open(packPath) == false) {
+            return false;
+        }
 
-        const i32 meshCount = meshPaths.GetNum();
-        for (i32 meshPathIndex = 0; meshPathIndex < meshCount; ++meshPathIndex) {
-            MeshAsset asset = MeshAsset::CreateDefault();
+        const i32 entryCount = assetPack.GetEntryCount();
+        StringAtom::Reserve(entryCount);
+        for (i32 entryIndex = 0; entryIndex < entryCount; entryIndex++) {
+            const AssetPackEntry& packEntry = assetPack.GetEntry(entryIndex);
+
+            AssetManifestEntry entry = {};
+            entry.id = AssetId::Create(packEntry.id);
+            entry.type = (AssetType)packEntry.type;
+            entry.path = StringAtom::Intern(assetPack.GetPath(packEntry), (i32)packEntry.pathLength);
+            entry.sizeBytes = packEntry.sizeBytes;
+            RegisterAssetEntry(entry);
+        }
 
-            LargeString path = meshPaths[meshPathIndex];
-            path.BackSlashesToSlashes();
-            asset.path = path;
-            path.StripFileExtension();
-            asset.id = AssetId::Create(path.GetCStr());
+        return true;
+    }
 
-            meshAssets.Add(asset);
+    void LeEngine::RegisterAssets() {
+        const std::chrono::high_resolution_clock::time_point scanStart = std::chrono::high_resolution_clock::now();
 
-            ATTOTRACE("Found mesh asset: %s", path.GetCStr());
+        if (app->useLooseAssets == false && RegisterPackedAssets(app->assetPackPath.GetCStr())) {
+            const f64 loadMS = (f64)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - scanStart).count() / 1000.0;
+            ATTOINFO("Registered %d assets from pack %s in %.3f ms", assetPack.GetEntryCount(), app->assetPackPath.GetCStr(), loadMS);
+            return;
         }
 
-        const i32 textureCount = texturePaths.GetNum();
-        for (i32 texturePathIndex = 0; texturePathIndex < textureCount; ++texturePathIndex) {
-            TextureAsset asset = TextureAsset::CreateDefault();
-
-            LargeString path = texturePaths[texturePathIndex];
-            path.BackSlashesToSlashes();
-            asset.path = path;
-            path.StripFileExtension();
-            asset.id = AssetId::Create(path.GetCStr());
+        // Building a pack needs the full list of files, so it always takes the scan below.
+        const LargeString manifestPath = AssetManifestGetPath();
+        if (app->useAssetManifest && app->buildAssetPack == false && AssetManifestLoad(manifestPath.GetCStr())) {
+            const f64 loadMS = (f64)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - scanStart).count() / 1000.0;
+            ATTOINFO("Registered assets from manifest %s in %.3f ms", manifestPath.GetCStr(), loadMS);
+            return;
+        }
 
-            textureAssets.Add(asset);
+        // Files at the top level are picked up right away, every top level directory becomes its own batch.
+        ScratchScope scratch;
+        AssetScanBatch rootBatch = {};
+        AssetScanAddDirectory(rootBatch, std::filesystem::directory_entry(app->looseAssetPath.GetCStr()));
+        TransientList<LargeString> directories(Memory::GetScratchArena(), 16);
+        for (const auto& entry : std::filesystem::directory_iterator(app->looseAssetPath.GetCStr())) {
+            if (entry.is_directory()) {
+                directories.Add(LargeString::FromLiteral(entry.path().string().c_str()));
+            }
+            else if (entry.is_regular_file()) {
+                AssetScanAddFile(rootBatch, entry);
+            }
+        }
 
-            ATTOTRACE("Found texture asset: %s", path.GetCStr());
+        // The batches own Lists, they are constructed in place and destructed before the scope gives the memory back.
+        const i32 directoryCount = directories.GetCount();
+        AssetScanBatch* batches = Memory::AllocateScratchStruct<AssetScanBatch>(directoryCount);
+        for (i32 directoryIndex = 0; directoryIndex < directoryCount; directoryIndex++) {
+            new (batches + directoryIndex) AssetScanBatch();
+            batches[directoryIndex].directory = directories[directoryIndex];
         }
 
-        const i32 audioCount = audioPaths.GetNum();
-        for (i32 audioPathIndex = 0; audioPathIndex < audioCount; ++audioPathIndex) {
-            AudioAsset asset = AudioAsset::CreateDefault();;
+        const bool scanInParallel = app->useParallelAssetScan && Jobs::GetWorkerCount() > 0 && directoryCount > 1;
+        if (scanInParallel) {
+            Jobs::ParallelFor(directoryCount, AssetScanDirectory, batches);
+        }
+        else {
+            for (i32 directoryIndex = 0; directoryIndex < directoryCount; directoryIndex++) {
+                AssetScanDirectory(directoryIndex, batches);
+            }
+        }
 
-            LargeString path = audioPaths[audioPathIndex];
-            path.BackSlashesToSlashes();
-            asset.path = path;
-            path.StripFileExtension();
-            asset.id = AssetId::Create(path.GetCStr());
+        // Register on this thread, in directory order, so the asset lists don't depend on worker timing.
+        List<AssetManifestEntry> manifestEntries;
+        List<AssetManifestDirectory> manifestDirectories;
+        for (i32 batchIndex = -1; batchIndex < directoryCount; batchIndex++) {
+            const AssetScanBatch& batch = batchIndex < 0 ? rootBatch : batches[batchIndex];
+            const i32 entryCount = batch.entries.GetNum();
+            for (i32 entryIndex = 0; entryIndex < entryCount; entryIndex++) {
+                RegisterAssetEntry(batch.entries[entryIndex]);
+            }
 
-            audioAssets.Add(asset);
+            manifestEntries.Add(batch.entries);
+            manifestDirectories.Add(batch.directories);
+        }
 
-            ATTOTRACE("Found audio asset: %s", path.GetCStr());
+        for (i32 directoryIndex = 0; directoryIndex < directoryCount; directoryIndex++) {
+            batches[directoryIndex].~AssetScanBatch();
         }
 
-        const i32 fontCount = fontPaths.GetNum();
-        for (i32 fontPathIndex = 0; fontPathIndex < fontCount; ++fontPathIndex) {
-            FontAsset asset = FontAsset::CreateDefault();
-            
-            LargeString path = fontPaths[fontPathIndex];
-            path.BackSlashesToSlashes();
-            asset.path = path;
-            path.StripFileExtension();
-            asset.id = AssetId::Create(path.GetCStr());
+        const f64 scanMS = (f64)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - scanStart).count() / 1000.0;
+        ATTOINFO("Registered %d asset files from %d directories in %.2f ms%s",
+            manifestEntries.GetNum(), manifestDirectories.GetNum(), scanMS, scanInParallel ? " (parallel)" : "");
 
-            fontAssets.Add(asset);
+        if (app->useAssetManifest) {
+            AssetManifestSave(manifestPath.GetCStr(), manifestDirectories, manifestEntries);
+        }
 
-            ATTOTRACE("Found font asset: %s", path.GetCStr());
+        if (app->buildAssetPack && AssetPackWriter::WriteFiles(app->assetPackPath.GetCStr(), manifestEntries)) {
+            ATTOINFO("Wrote asset pack %s, %d assets", app->assetPackPath.GetCStr(), manifestEntries.GetNum());
         }
 
+        const StringAtomStats atomStats = StringAtom::GetStats();
+        ATTOINFO("Interned %d strings, %llu bytes of string pool and %llu bytes of index",
+            atomStats.atomCount, atomStats.poolBytes, atomStats.indexBytes);
+
         //// TODO: Hard coded string !!
         //std::ifstream spritesRegisterFile("assets/sprites.json");
         //if (spritesRegisterFile.is_open()) {
@@ -790,8 +1241,8 @@ namespace atto {
     }
 
     void PackedAssetFile::GetData(byte* data, i32 size) {
-        Assert(currentOffset + size <= storedData.GetNum(), "PackedAssetFile::Get: currentOffset + size > storedData.GetNum()");
-        byte* p = storedData.GetData() + currentOffset;
+        Assert(currentOffset + size <= loadedSize, "PackedAssetFile::Get: currentOffset + size > loadedSize");
+        const byte* p = loadedData + currentOffset;
         std::memcpy(data, p, size);
         currentOffset += size;
     }
@@ -834,20 +1285,13 @@ namespace atto {
     }
 
     bool PackedAssetFile::Load(const char* name) {
-        std::ifstream file(name, std::ios::binary);
-        if (!file.is_open()) {
-            ATTOERROR("PackedAssetFile::Load -> Could not open file %s", name);
+        if (loadedFile.Open(name) == false) {
             return false;
         }
 
-        file.seekg(0, std::ios::end);
-        const i32 size = (i32)file.tellg();
-        file.seekg(0, std::ios::beg);
-
-        storedData.SetNum(size, true);
-        file.read((char*)storedData.GetData(), size);
-        file.close();
-
+        loadedData = loadedFile.GetData();
+        loadedSize = (i32)loadedFile.GetSize();
+        currentOffset = 0;
         isLoading = true;
 
         return true;
@@ -855,6 +1299,37 @@ namespace atto {
 
     void PackedAssetFile::Finished() {
         storedData.Clear();
+        loadedFile.Close();
+        loadedData = nullptr;
+        loadedSize = 0;
+    }
+
+    void PackedAssetFile::PutString(const char* str, i32 length) {
+        Put(length);
+        PutData((byte*)str, length);
+    }
+
+    // Returns a pointer into the loaded data, it is not null terminated. Returns nullptr if the data is cut short.
+    const char* PackedAssetFile::GetString(i32& length) {
+        length = 0;
+        if (CanGet(sizeof(i32)) == false) {
+            return nullptr;
+        }
+
+        Get(length);
+        if (CanGet(length) == false) {
+            length = 0;
+            return nullptr;
+        }
+
+        const char* str = (const char*)(loadedData + currentOffset);
+        currentOffset += length;
+
+        return str;
+    }
+
+    bool PackedAssetFile::CanGet(i32 size) const {
+        return size >= 0 && currentOffset + size <= loadedSize;
     }
 
 }
@@ -2,6 +2,13 @@
 
 #include "AttoLib.h"
 #include "AttoLua.h"
+#include "AttoAssetTypes.h"
+#include "AttoAssetCooked.h"
+#include "AttoAssetImport.h"
+#include "AttoAssetPack.h"
+#include "AttoAsyncIO.h"
+#include "AttoDerivedDataCache.h"
+#include "AttoJobs.h"
 
 #include <wrl.h>
 namespace wrl = Microsoft::WRL;
@@ -115,102 +122,87 @@ namespace atto
         glm::vec2 point;
     };
 
-    enum AssetType {
-        ASSET_TYPE_INVALID = 0,
-        ASSET_TYPE_MESH,
-        ASSET_TYPE_TEXTURE,
-        ASSET_TYPE_AUDIO,
-        ASSET_TYPE_FONT,
-        ASSET_TYPE_SPRITE,
-        ASSET_TYPE_TILESHEET,
-        ASSET_TYPE_COUNT
-    };
-
-    struct AssetId {
-        inline static AssetId Create(const char* str) {
-            AssetId id;
-            id.id = StringHash::Hash(str);
-            return id; 
-        }
-
-        inline static AssetId Create(u32 idNumber) {
-            AssetId id;
-            id.id = idNumber;
-            return id;
-        }
-
-        inline b8 IsValid() const { return id != 0; }
-
-        inline b8 operator ==(const AssetId& other) const { return id == other.id; }
-        inline b8 operator !=(const AssetId& other) const { return id != other.id; }
-
-        u32 id;
-    };
-
-    template<u32 _type_>
-    class TypedAssetId {
-    public:
-        inline static TypedAssetId<_type_> Create(const char* str) {
-            TypedAssetId<_type_> id;
-            id.id = StringHash::Hash(str);
-            return id;
-        }
-
-        inline b8 IsValid() const { return id != 0; }
-        inline u32 GetValue() const { return id; }
-        inline AssetId ToRawId() const { return AssetId::Create(id); }
-
-        inline b8 operator ==(const AssetId& other) const { return id == other.id; }
-        inline b8 operator !=(const AssetId& other) const { return id != other.id; }
-
-        u32 id;
-    };
-    
-    typedef TypedAssetId<ASSET_TYPE_MESH>    MeshAssetId;
-    typedef TypedAssetId<ASSET_TYPE_TEXTURE> TextureAssetId;
-    typedef TypedAssetId<ASSET_TYPE_AUDIO>   AudioAssetId;
-    typedef TypedAssetId<ASSET_TYPE_FONT>    FontAssetId;
-    
-    struct MeshData {
-        SmallString name;
-        List<glm::vec3> positions;
-        List<glm::vec3> normals;
-        List<glm::vec2> uvs;
-        List<u16> indices;
-    };
-
     struct MeshAsset {
         AssetId                         id;
         bool                            isLoaded;
+        // Set while a job is importing the mesh, isLoaded is set once the render thread has created the buffers.
+        bool                            isLoading;
+        // Load calls without a matching Free. Only meshes nobody holds can be evicted.
+        i32                             refCount;
+        u64                             lastUsedFrame;
+        // Pack offset of the payload the buffers came from, 0 for loose files. Meshes with the same payload share buffers.
+        u64                             payloadOffset;
         wrl::ComPtr<ID3D11Buffer>       vertexBuffer;
         wrl::ComPtr<ID3D11Buffer>       indexBuffer;
         u32                             vertexCount;
         u32                             vertexStride;
         u32                             indexCount;
-        LargeString                     path;
+        u32                             indexStride;
+        MeshVertexFormat                vertexFormat;
+        MeshQuantization                quantization;
+        // One draw per submesh, all sharing the buffers above. Empty means a single draw over every index.
+        List<MeshSubmesh>               submeshes;
+        StringAtom                      path;
 
         static MeshAsset CreateDefault() {
             MeshAsset meshAsset = {};
             return meshAsset;
         }
+
+        u64 GetSizeBytes() const {
+            return (u64)vertexCount * vertexStride + (u64)indexCount * indexStride;
+        }
+    };
+
+    // A mesh being imported on the job workers. The worker fills in packed, the render thread creates the
+    // buffers from it once the counter reaches zero.
+    struct MeshLoadJob {
+        MeshAsset*                      mesh;
+        // Pack payloads are resolved on the worker, compressed ones are decoded into payload first.
+        const AssetPack*                pack;
+        const AssetPackEntry*           packEntry;
+        // Async loads read the stored entry through AsyncIO first, the job is only submitted once the read is done.
+        // A failed read leaves stored empty and the worker falls back to the mapping.
+        List<byte>                      stored;
+        bool                            isReading;
+        List<byte>                      payload;
+        const byte*                     data;
+        u64                             sizeBytes;
+        // Meshes that are not cooked get cooked into this, or read back from derivedData, packed then points into it.
+        DerivedDataCache*               derivedData;
+        List<byte>                      blob;
+        MeshPacked                      packed;
+        bool                            succeeded;
+        JobCounter                      counter;
     };
     
     struct TextureAsset {
         AssetId                                 id;
         bool                                    isLoaded;
+        i32                                     refCount;
+        u64                                     lastUsedFrame;
+        // Pack offset of the payload the texture came from, 0 for loose files. Textures with the same payload share it.
+        u64                                     payloadOffset;
         wrl::ComPtr<ID3D11Texture2D>            texture;
         wrl::ComPtr<ID3D11ShaderResourceView>   srv;
         i32                                     slot;
         i32                                     width;
         i32                                     height;
         i32                                     channels;
+        TextureFormat                           format;
+        i32                                     mipCount;
         bool                                    generateMipMaps;
-        LargeString                             path;
+        StringAtom                              path;
 
         static TextureAsset CreateDefault() {
             TextureAsset textureAsset = {};
+            textureAsset.generateMipMaps = true;
             return textureAsset;
         }
+
+        u64 GetSizeBytes() const {
+            return isLoaded ? TextureFormatGetMipOffset(format, width, height, mipCount) : 0;
+        }
     };
 
     enum ShaderInputLayout {
@@ -218,6 +210,8 @@ namespace atto
         INPUT_LAYOUT_BASIC_FONT,
         INPUT_LAYOUT_DRAW_2D,
         INPUT_LAYOUT_POSITION_NORMAL_UV,
+        INPUT_LAYOUT_POSITION_NORMAL_UV_QUANTIZED,
+        INPUT_LAYOUT_POSITION_NORMAL_UV_QUANTIZED_HALF,
     };
 
     struct ShaderAsset {
@@ -246,6 +240,11 @@ namespace atto
     struct ShaderBufferInstance {
         Float4Align glm::mat4 mvp;
         Float4Align glm::mat4 model;
+        // Quantized meshes only, see MeshQuantization. xyz used.
+        Float4Align glm::vec4 positionOffset;
+        Float4Align glm::vec4 positionScale;
+        // xy = uv offset, zw = uv scale.
+        Float4Align glm::vec4 uvOffsetScale;
     };
 
     struct ShaderBufferCamera {
@@ -268,12 +267,19 @@ namespace atto
 
     struct AudioAsset {
         AssetId     id;
+        i32         refCount;
+        u64         lastUsedFrame;
         u32         bufferHandle;
         i32         channels;
         i32         sampleRate;
         i32         sizeBytes;
         i32         bitDepth;
-        LargeString path;
+        StringAtom  path;
+        // Open for loose wav files, samples points into the view.
+        FileHandle  file;
+        // Decoded samples for ogg, and the decoded payload for compressed pack entries.
+        List<byte>  payload;
+        const byte* samples;
         
         static AudioAsset CreateDefault() {
             return {};
@@ -294,23 +300,27 @@ namespace atto
     struct FontAsset {
         AssetId                                 id;
         bool                                    isLoaded;
-        LargeString                             path;
+        StringAtom                              path;
         stbtt_fontinfo                          info;
         FixedList<stbtt_bakedchar, 96>          chardata;
         i32                                     ascent;
         i32                                     descent;
         i32                                     lineGap;
         f32                                     fontSize;
+        // info points into one of these, the decoded pack payload when it was compressed or the loose file.
+        List<byte>                              payload;
+        FileHandle                              file;
         wrl::ComPtr<ID3D11Texture2D>            texture;
         wrl::ComPtr<ID3D11ShaderResourceView>   srv;
 
         static FontAsset CreateDefault() {
             FontAsset fontAsset = {};
-            fontAsset.fontSize = 24;
+            fontAsset.fontSize = FONT_DEFAULT_SIZE;
             return fontAsset;
         }
     };
 
+    // Put appends to storedData for Save. Load maps the file and Get parses straight out of the mapping.
     class PackedAssetFile {
     public:
         void        PutData(byte* data, i32 size);
@@ -327,9 +337,16 @@ namespace atto
 
         void        Finished();
 
+        void        PutString(const char* str, i32 length);
+        const char* GetString(i32& length);
+        bool        CanGet(i32 size) const;
+
         bool        isLoading = false;
         i32         currentOffset = 0;
         List<byte>  storedData;
+        MappedFile  loadedFile;
+        const byte* loadedData = nullptr;
+        i32         loadedSize = 0;
 
         template<typename _type_>
         void Serialize(_type_& value) {
@@ -364,8 +381,8 @@ namespace atto
         template<typename _type_>
         void Get(_type_& data) {
             const i32 size = sizeof(_type_);
-            Assert(currentOffset + size <= storedData.GetNum(), "PackedAssetFile::Get: currentOffset + size > storedData.GetNum()");
-            byte* p = storedData.GetData() + currentOffset;
+            Assert(currentOffset + size <= loadedSize, "PackedAssetFile::Get: currentOffset + size > loadedSize");
+            const byte* p = loadedData + currentOffset;
             std::memcpy((void*)&data, p, size);
             currentOffset += size;
         }
@@ -425,6 +442,21 @@ namespace atto
         wrl::ComPtr< ID3D11BlendState> additiveBlend;
     };
 
+    // Pack payload offset to the asset holding the GPU resources made from that payload.
+    template<typename _type_>
+    using AssetPayloadLookup = FixedHashMap<u64, _type_*, 4096>;
+
+    // Bytes held by loaded assets, per type. Renderer owned meshes like the unit cube are not counted.
+    struct AssetMemory {
+        u64     meshBytes;
+        u64     textureBytes;
+        u64     audioBytes;
+
+        u64 GetTotalBytes() const {
+            return meshBytes + textureBytes + audioBytes;
+        }
+    };
+
     struct GlobalRenderer {
         wrl::ComPtr<IDXGIFactory2>              factory;
         wrl::ComPtr<ID3D11Device>               device;
@@ -439,6 +471,8 @@ namespace atto
         MeshAsset                               unitCube;
         MeshAsset                               unitHex;
         ShaderAsset                             testingShader;
+        ShaderAsset                             testingShaderQuantized;
+        ShaderAsset                             testingShaderQuantizedHalf;
         ShaderBuffer<ShaderBufferInstance>      shaderBufferInstance;
         ShaderBuffer<ShaderBufferCamera>        shaderBufferCamera;
         ShaderBuffer<ShaderBufferMaterial>      shaderBufferMaterial;
@@ -602,7 +636,7 @@ namespace atto
     };
 
     struct UIWindow {
-        SmallString     title;
+        StringAtom      title;
         glm::vec2       pos;
         glm::vec2       dims;
         glm::vec2       dragOffset;
@@ -704,11 +738,6 @@ namespace atto
         }
     };
 
-    struct EntityRef {
-        u32 index;
-        u32 generation;
-    };
-
     struct Unit {
         bool active;
         bool isSelected;
@@ -743,6 +772,7 @@ namespace atto
     };
 
     struct Entity {
+        EntityRef       ref;
         glm::vec3       pos;
         glm::basis      ori;
         Material        material;
@@ -783,17 +813,30 @@ namespace atto
 
         Entity*                             EntityCreate();
         Entity*                             EntityCreateProptypeWall(glm::vec2 pos);
+        Entity*                             EntityGet(EntityRef ref);
+        void                                EntityDestroy(EntityRef ref);
         
         void                                UnitSetPos(Entity *unit, glm::vec2 pos);
         glm::vec2                           UnitSteerSeekCurrentTarget(const Unit& unit);
         glm::vec2                           UnitSteerSeekCurrentTargetKinematic(const Unit& unit);
 
         void                                RegisterAssets();
+        void                                RegisterAssetEntry(const AssetManifestEntry& entry);
+        bool                                RegisterPackedAssets(const char* packPath);
+
+        LargeString                         AssetManifestGetPath() const;
+        bool                                AssetManifestLoad(const char* manifestPath);
+        void                                AssetManifestSave(const char* manifestPath, const List<AssetManifestDirectory>& directories, const List<AssetManifestEntry>& entries);
 
         MeshAsset*                          LoadMeshAsset(MeshAssetId id);
+        // Returns right away, the mesh is imported on the job workers and its buffers are created during a later
+        // Render. Until then it draws as the placeholder cube.
+        MeshAsset*                          LoadMeshAssetAsync(MeshAssetId id);
         void                                FreeMeshAsset(MeshAssetId id);
 
         TextureAsset*                       LoadTextureAsset(TextureAssetId id);
+        // Decodes every texture that is not cooked in parallel first, textures[i] is nullptr for unknown ids.
+        void                                LoadTextureAssets(const TextureAssetId* ids, i32 count, TextureAsset** textures);
         void                                FreeTextureAsset(TextureAssetId id);
 
         FontAsset*                          LoadFontAsset(FontAssetId id);
@@ -801,6 +844,11 @@ namespace atto
         AudioAsset*                         LoadAudioAsset(AudioAssetId id);
         void                                FreeAudioAsset(AudioAssetId id);
 
+        // Every Load adds a reference and every Free drops one. Assets nobody references stay loaded until the
+        // memory budget is exceeded, then the least recently used ones are unloaded first.
+        const AssetMemory&                  AssetGetMemory() const;
+        void                                AssetEvictToBudget(u64 budgetBytes);
+
         Speaker                             AudioPlay(AudioAssetId audioAssetId, bool looping = false, f32 volume = 1.0f);
         void                                AudioPause(Speaker speaker);
         void                                AudioStop(Speaker speaker);
@@ -809,7 +857,8 @@ namespace atto
 
         void                                UIResetContext(UIContext& context);
         void                                UIRender(UIContext& context);
-        void                                UIBeginWindow(UIContext& context, const char* title, const glm::vec2& firstPos, const glm::vec2& firstSize);
+        // Windows are found by title with one integer compare each, intern the title once and keep the atom around.
+        void                                UIBeginWindow(UIContext& context, StringAtom title, const glm::vec2& firstPos, const glm::vec2& firstSize);
         void                                UIEndWindow(UIContext& context);
         void                                UIBeginMainMenuBar(UIContext& context);
         bool                                UIBeginMenu(UIContext& context, const char* text);
@@ -831,8 +880,6 @@ namespace atto
         bool                                InitializeDraw2D();
         bool                                InitializeAudio();
 
-        byte*                               LoadEntireFile(const char *path, i32 &fileSize);
-
         void                                ShaderGetInputLayout(ShaderInputLayout layout, FixedList<D3D11_INPUT_ELEMENT_DESC, 8> & list);
         ID3DBlob*                           ShaderCompileFile(const char* path, const char* entry, const char* target);
         ID3DBlob*                           ShaderCompileSource(const char* source, const char* entry, const char* target);
@@ -847,13 +894,31 @@ namespace atto
         void                                MeshCreateUnitQuad(MeshAsset& quad);
         void                                MeshCreateUnitCube(MeshAsset& cube);
         void                                MeshCreateHex(MeshAsset& hex, f32 outerRadius, f32 innerRadius);
-        void                                MeshDataPackPNT(const MeshData &meshData, const glm::mat3 &scalingMatrix, List<f32> &data);
         void                                MeshCreate(MeshAsset& mesh);
+        void                                MeshCreateAsync(MeshAsset& mesh);
+        void                                MeshFinishLoad(MeshLoadJob& job);
+        void                                MeshWaitForLoad(MeshLoadJob& job);
+        void                                MeshUpdateLoads(bool waitForAll);
+        // Takes the buffers of a loaded mesh with a byte identical pack payload, true if there was one.
+        bool                                MeshShare(MeshAsset& mesh);
+        void                                MeshDestroy(MeshAsset& mesh);
+        bool                                MeshCreateBuffers(MeshAsset& mesh, const MeshPacked& packed);
+        ShaderAsset*                        MeshGetShader(MeshAsset* mesh);
         void                                MeshBind(MeshAsset* mesh);
         void                                MeshDraw(MeshAsset* mesh);
 
+        // Compressed pack payloads are decoded into storage, loose files are mapped with looseFile.
+        void                                TextureGetSource(TextureAsset& texture, MappedFile& looseFile, List<byte>& storage, const byte*& data, u64& sizeBytes);
         void                                TextureCreate(TextureAsset& texture);
+        // Takes the texture of a loaded texture with a byte identical pack payload, true if there was one.
+        bool                                TextureShare(TextureAsset& texture);
+        void                                TextureCreateFromCooked(TextureAsset& texture, const CookedTexture& cooked);
+        // pixels are straight from TextureImport, nullptr logs the failure.
+        void                                TextureCreateFromImage(TextureAsset& texture, const byte* pixels, i32 width, i32 height, i32 channels);
+        void                                TextureCreateFromLevels(TextureAsset& texture, const byte* pixels, i32 availableMipCount);
+        bool                                TextureCreateFromMips(TextureAsset& texture, const byte* mips, i32 mipCount);
         void                                TextureBind(TextureAsset* texture, i32 slot);
+        void                                TextureDestroy(TextureAsset& texture);
         
         void                                FontCreate(FontAsset& font);
         f32                                 FontWidth(FontAsset* fontAsset, const char* text);
@@ -868,6 +933,7 @@ namespace atto
         void                                Draw2DCircle(glm::vec2 pos, f32 r, glm::vec4 color = glm::vec4(1, 1, 1, 1));
 
         void                                AudioCreate(AudioAsset& audio);
+        void                                AudioDestroy(AudioAsset& audio);
 
 #if     ATTO_DEBUG_RENDERING
         void                                DebugRender();
@@ -877,7 +943,10 @@ namespace atto
         void                                DebugAddRay(Ray ray);
 #endif
 
-        template<typename _type_> _type_*   FindAsset(FixedList<_type_, 2048> & assetList, AssetId id);
+        template<typename _type_> _type_*   FindAsset(FixedStorageList<_type_, 2048> & assetList, AssetLookup & lookup, AssetId id);
+        template<typename _type_> _type_*   RegisterAsset(FixedStorageList<_type_, 2048> & assetList, AssetLookup & lookup, const _type_ & asset);
+        // Call before an asset drops its GPU resources. True when nothing else shares them and their bytes should be released.
+        template<typename _type_> bool      ReleasePayload(FixedStorageList<_type_, 2048> & assetList, AssetPayloadLookup<_type_> & holders, _type_ & asset);
 
         AppState*                           app;
 
@@ -899,13 +968,29 @@ namespace atto
         TextureAsset*                       textureTriplanarTest;
         TextureAsset*                       textureBaseTank;
 
-        FixedList<MeshAsset,    2048>       meshAssets;
-        FixedList<TextureAsset, 2048>       textureAssets;
-        FixedList<FontAsset,    2048>       fontAssets;
-        FixedList<AudioAsset,   2048>       audioAssets;
+        FixedStorageList<MeshAsset,    2048> meshAssets;
+        FixedStorageList<TextureAsset, 2048> textureAssets;
+        FixedStorageList<FontAsset,    2048> fontAssets;
+        FixedStorageList<AudioAsset,   2048> audioAssets;
+        AssetLookup                         meshAssetLookup;
+        AssetLookup                         textureAssetLookup;
+        AssetLookup                         fontAssetLookup;
+        AssetLookup                         audioAssetLookup;
+        AssetPack                           assetPack;
+        FileService                         files;
+        AsyncIO                             io;
+        DerivedDataCache                    derivedData;
+        FixedList<MeshLoadJob*,   64>       meshLoadJobs;
+        // The loaded asset that owns the GPU resources made from each pack payload, duplicates share them.
+        AssetPayloadLookup<MeshAsset>       meshPayloadHolders;
+        AssetPayloadLookup<TextureAsset>    texturePayloadHolders;
+        AssetMemory                         assetMemory;
+        // Set while referenced assets alone are over budget, so AssetEvictToBudget only warns when that starts.
+        bool                                assetOverBudget = false;
+        u64                                 frameIndex;
 
         FixedList<Speaker,       64>        speakers;
-        FixedList<Entity,      2048>        entities;
+        FixedFreeList<Entity,  2048>        entities;
     };
 
     template<typename _type_>
@@ -941,13 +1026,10 @@ namespace atto
     }
 
     template<typename _type_>
-    _type_* LeEngine::FindAsset(FixedList<_type_, 2048> & assetList, AssetId id) {
-        const i32 assetListCount = assetList.GetCount();
-        for (i32 assetIndex = 0; assetIndex < assetListCount; assetIndex++) {
-            _type_* asset = &assetList[assetIndex];
-            if (asset->id == id) {
-                return asset;
-            }
+    _type_* LeEngine::FindAsset(FixedStorageList<_type_, 2048> & assetList, AssetLookup & lookup, AssetId id) {
+        const i32* assetIndex = lookup.Find(id.id);
+        if (assetIndex != nullptr) {
+            return &assetList[*assetIndex];
         }
         
         ATTOERROR("Could not find asset with id %d", id.id);
@@ -955,4 +1037,66 @@ namespace atto
         return nullptr;
     }
 
+    template<typename _type_>
+    _type_* LeEngine::RegisterAsset(FixedStorageList<_type_, 2048> & assetList, AssetLookup & lookup, const _type_ & asset) {
+        const i32* existingIndex = lookup.Find(asset.id.id);
+        if (existingIndex != nullptr) {
+            _type_* existing = &assetList[*existingIndex];
+            if (existing->path != asset.path) {
+                // Ids are made from the path without its extension, files that only differ by extension share one.
+                LargeString existingName = LargeString::FromLiteral(existing->path.GetCStr());
+                LargeString assetName = LargeString::FromLiteral(asset.path.GetCStr());
+                existingName.StripFileExtension();
+                assetName.StripFileExtension();
+                if (existingName == assetName) {
+                    ATTOERROR("Duplicate asset name, %s and %s are both %s. %s is not registered",
+                        existing->path.GetCStr(), asset.path.GetCStr(), assetName.GetCStr(), asset.path.GetCStr());
+                }
+                else {
+                    ATTOERROR("Asset id hash collision, %s and %s both hash to %u. %s is not registered",
+                        existing->path.GetCStr(), asset.path.GetCStr(), asset.id.id, asset.path.GetCStr());
+                }
+                return nullptr;
+            }
+
+            return existing;
+        }
+
+        if (assetList.IsFull() || lookup.IsFull()) {
+            ATTOERROR("Asset list is full, could not register %s", asset.path.GetCStr());
+            return nullptr;
+        }
+
+        const i32 assetIndex = assetList.GetCount();
+        lookup.Add(asset.id.id, assetIndex);
+
+        return assetList.Add(asset);
+    }
+
+    template<typename _type_>
+    bool LeEngine::ReleasePayload(FixedStorageList<_type_, 2048> & assetList, AssetPayloadLookup<_type_> & holders, _type_ & asset) {
+        _type_** holder = asset.payloadOffset != 0 ? holders.Find(asset.payloadOffset) : nullptr;
+        if (holder == nullptr) {
+            return true;
+        }
+
+        // Sharing it, the holder accounts for the bytes.
+        if (*holder != &asset) {
+            return false;
+        }
+
+        const i32 assetCount = assetList.GetCount();
+        for (i32 assetIndex = 0; assetIndex < assetCount; assetIndex++) {
+            _type_* other = &assetList[assetIndex];
+            if (other != &asset && other->isLoaded && other->payloadOffset == asset.payloadOffset) {
+                *holder = other;
+                return false;
+            }
+        }
+
+        holders.Remove(asset.payloadOffset);
+
+        return true;
+    }
+
 }
@@ -0,0 +1,293 @@
+#include "AttoAssetCooked.h"
+
+namespace atto
+{
+    static void CookedPut(List<byte>& blob, const void* data, u64 sizeBytes) {
+        const i32 offset = blob.GetNum();
+        blob.SetNum(offset + (i32)sizeBytes, false);
+        memcpy(blob.GetData() + offset, data, sizeBytes);
+    }
+
+    static void CookedPutHeader(List<byte>& blob, AssetType type, u32 cookFlags, u64 sourceSizeBytes, i64 sourceWriteTime, u64 bodySizeBytes) {
+        CookedAssetHeader header = {};
+        header.magic = COOKED_ASSET_MAGIC;
+        header.version = COOKED_ASSET_VERSION;
+        header.type = (u32)type;
+        header.cookFlags = cookFlags;
+        header.sourceSizeBytes = sourceSizeBytes;
+        header.sourceWriteTime = sourceWriteTime;
+
+        blob.Clear();
+        blob.Reserve((i32)(sizeof(header) + bodySizeBytes));
+        CookedPut(blob, &header, sizeof(header));
+    }
+
+    const CookedAssetHeader* CookedAssetGetHeader(const byte* data, u64 sizeBytes) {
+        if (sizeBytes < sizeof(CookedAssetHeader)) {
+            return nullptr;
+        }
+
+        const CookedAssetHeader* header = (const CookedAssetHeader*)data;
+        if (header->magic != COOKED_ASSET_MAGIC || header->version != COOKED_ASSET_VERSION) {
+            return nullptr;
+        }
+
+        return header;
+    }
+
+    bool CookedMeshRead(const byte* data, u64 sizeBytes, MeshPacked& mesh) {
+        const CookedAssetHeader* header = CookedAssetGetHeader(data, sizeBytes);
+        if (header == nullptr || header->type != ASSET_TYPE_MESH || sizeBytes < sizeof(CookedAssetHeader) + sizeof(CookedMeshHeader)) {
+            return false;
+        }
+
+        const CookedMeshHeader* meshHeader = (const CookedMeshHeader*)(data + sizeof(CookedAssetHeader));
+        const u64 submeshBytes = sizeof(MeshSubmesh) * (u64)meshHeader->submeshCount;
+        const u64 vertexBytes = (u64)meshHeader->vertexCount * meshHeader->vertexStride;
+        const u64 indexBytes = (u64)meshHeader->indexCount * meshHeader->indexStride;
+        if (meshHeader->vertexFormat >= MESH_VERTEX_FORMAT_COUNT || meshHeader->vertexStride != MeshVertexFormatGetStride((MeshVertexFormat)meshHeader->vertexFormat) ||
+            (meshHeader->indexStride != sizeof(u16) && meshHeader->indexStride != sizeof(u32)) ||
+            sizeof(CookedAssetHeader) + sizeof(CookedMeshHeader) + submeshBytes + vertexBytes + indexBytes != sizeBytes) {
+            return false;
+        }
+
+        const MeshSubmesh* submeshes = (const MeshSubmesh*)(meshHeader + 1);
+        for (u32 submeshIndex = 0; submeshIndex < meshHeader->submeshCount; submeshIndex++) {
+            const MeshSubmesh& submesh = submeshes[submeshIndex];
+            if ((u64)submesh.indexOffset + submesh.indexCount > meshHeader->indexCount || submesh.baseVertex > meshHeader->vertexCount) {
+                return false;
+            }
+        }
+
+        mesh.vertexFormat = (MeshVertexFormat)meshHeader->vertexFormat;
+        mesh.quantization = meshHeader->quantization;
+        mesh.submeshes = submeshes;
+        mesh.submeshCount = meshHeader->submeshCount;
+        mesh.vertices = (const byte*)submeshes + submeshBytes;
+        mesh.vertexCount = meshHeader->vertexCount;
+        mesh.indices = (const byte*)mesh.vertices + vertexBytes;
+        mesh.indexCount = meshHeader->indexCount;
+        mesh.indexStride = meshHeader->indexStride;
+
+        return true;
+    }
+
+    bool CookedTextureRead(const byte* data, u64 sizeBytes, CookedTexture& texture) {
+        const CookedAssetHeader* header = CookedAssetGetHeader(data, sizeBytes);
+        if (header == nullptr || header->type != ASSET_TYPE_TEXTURE || sizeBytes < sizeof(CookedAssetHeader) + sizeof(CookedTextureHeader)) {
+            return false;
+        }
+
+        const CookedTextureHeader* textureHeader = (const CookedTextureHeader*)(data + sizeof(CookedAssetHeader));
+        if (textureHeader->width <= 0 || textureHeader->height <= 0 || textureHeader->format >= TEXTURE_FORMAT_COUNT) {
+            return false;
+        }
+
+        const TextureFormat format = (TextureFormat)textureHeader->format;
+        if (textureHeader->rowPitch != (i32)TextureFormatGetRowPitch(format, textureHeader->width) ||
+            textureHeader->mipCount < 1 || textureHeader->mipCount > TextureMipGetCount(textureHeader->width, textureHeader->height) ||
+            sizeof(CookedAssetHeader) + sizeof(CookedTextureHeader) + TextureFormatGetMipOffset(format, textureHeader->width, textureHeader->height, textureHeader->mipCount) != sizeBytes) {
+            return false;
+        }
+
+        texture.header = textureHeader;
+        texture.pixels = (const byte*)(textureHeader + 1);
+
+        return true;
+    }
+
+    bool CookedFontRead(const byte* data, u64 sizeBytes, CookedFont& font) {
+        const CookedAssetHeader* header = CookedAssetGetHeader(data, sizeBytes);
+        if (header == nullptr || header->type != ASSET_TYPE_FONT || sizeBytes < sizeof(CookedAssetHeader) + sizeof(CookedFontHeader)) {
+            return false;
+        }
+
+        const CookedFontHeader* fontHeader = (const CookedFontHeader*)(data + sizeof(CookedAssetHeader));
+        const u64 chardataBytes = sizeof(stbtt_bakedchar) * (u64)fontHeader->charCount;
+        const u64 atlasBytes = (u64)fontHeader->atlasSize * fontHeader->atlasSize;
+        if (fontHeader->charCount != FONT_CHAR_COUNT || fontHeader->firstChar != FONT_FIRST_CHAR || fontHeader->atlasSize != FONT_ATLAS_SIZE ||
+            sizeof(CookedAssetHeader) + sizeof(CookedFontHeader) + chardataBytes + atlasBytes + fontHeader->ttfSizeBytes != sizeBytes) {
+            return false;
+        }
+
+        font.header = fontHeader;
+        font.chardata = (const stbtt_bakedchar*)(fontHeader + 1);
+        font.atlas = (const byte*)(font.chardata + fontHeader->charCount);
+        font.ttf = font.atlas + atlasBytes;
+
+        return true;
+    }
+
+    static bool CookMesh(const char* path, const byte* source, u64 sourceSizeBytes, i64 sourceWriteTime, const CookSettings& settings, List<byte>& blob) {
+        List<MeshData> meshes;
+        if (MeshImport(path, source, sourceSizeBytes, meshes, settings.meshOptimize) == false) {
+            return false;
+        }
+
+        ScratchScope scratch;
+        MeshPacked packed = {};
+        MeshPackModel(meshes, MeshImportGetScale(path), settings.meshVertexFormat, packed);
+
+        CookedMeshHeader meshHeader = {};
+        meshHeader.vertexCount = packed.vertexCount;
+        meshHeader.vertexStride = MeshVertexFormatGetStride(packed.vertexFormat);
+        meshHeader.indexCount = packed.indexCount;
+        meshHeader.indexStride = packed.indexStride;
+        meshHeader.vertexFormat = packed.vertexFormat;
+        meshHeader.submeshCount = packed.submeshCount;
+        meshHeader.quantization = packed.quantization;
+
+        const u64 submeshBytes = sizeof(MeshSubmesh) * (u64)packed.submeshCount;
+        const u64 vertexBytes = (u64)meshHeader.vertexStride * meshHeader.vertexCount;
+        const u64 indexBytes = (u64)meshHeader.indexStride * meshHeader.indexCount;
+        CookedPutHeader(blob, ASSET_TYPE_MESH, CookAssetGetFlags(ASSET_TYPE_MESH, settings), sourceSizeBytes, sourceWriteTime,
+            sizeof(meshHeader) + submeshBytes + vertexBytes + indexBytes);
+        CookedPut(blob, &meshHeader, sizeof(meshHeader));
+        CookedPut(blob, packed.submeshes, submeshBytes);
+        CookedPut(blob, packed.vertices, vertexBytes);
+        CookedPut(blob, packed.indices, indexBytes);
+
+        return true;
+    }
+
+    static bool CookTexture(const char* path, const byte* source, u64 sourceSizeBytes, i64 sourceWriteTime, const CookSettings& settings, List<byte>& blob) {
+        CookedTextureHeader textureHeader = {};
+        byte* pixels = TextureImportRGBA8(source, sourceSizeBytes, textureHeader.width, textureHeader.height, textureHeader.channels);
+        if (pixels == nullptr) {
+            ATTOERROR("Could not cook %s, the image failed to decode", path);
+            return false;
+        }
+
+        TextureFormat format = settings.textureFormat;
+        if (TextureFormatIsCompressed(format) && (textureHeader.width % 4 != 0 || textureHeader.height % 4 != 0)) {
+            ATTOWARN("%s is %dx%d, block compressed textures need sizes that are a multiple of 4, keeping it RGBA8", path, textureHeader.width, textureHeader.height);
+            format = TEXTURE_FORMAT_RGBA8;
+        }
+
+        textureHeader.rowPitch = (i32)TextureFormatGetRowPitch(format, textureHeader.width);
+        textureHeader.mipCount = settings.textureMips ? TextureMipGetCount(textureHeader.width, textureHeader.height) : 1;
+        textureHeader.mipFilter = settings.textureMipSettings.filter;
+        textureHeader.srgb = settings.textureMipSettings.srgb ? 1 : 0;
+        textureHeader.format = format;
+
+        const u64 levelBytes = (u64)textureHeader.width * textureHeader.height * 4;
+        const u64 chainBytes = TextureMipGetChainSizeBytes(textureHeader.width, textureHeader.height, textureHeader.mipCount);
+        const u64 cookedBytes = TextureFormatGetMipOffset(format, textureHeader.width, textureHeader.height, textureHeader.mipCount);
+        CookedPutHeader(blob, ASSET_TYPE_TEXTURE, CookAssetGetFlags(ASSET_TYPE_TEXTURE, settings), sourceSizeBytes, sourceWriteTime, sizeof(textureHeader) + cookedBytes);
+        CookedPut(blob, &textureHeader, sizeof(textureHeader));
+        const i32 chainOffset = blob.GetNum();
+
+        if (format == TEXTURE_FORMAT_RGBA8) {
+            // The mips are filtered straight into the blob, right behind level 0.
+            CookedPut(blob, pixels, levelBytes);
+            blob.SetNum(chainOffset + (i32)chainBytes, false);
+            TextureImportFree(pixels);
+
+            TextureMipGenerateChain(blob.GetData() + chainOffset, textureHeader.width, textureHeader.height, textureHeader.mipCount, settings.textureMipSettings);
+
+            return true;
+        }
+
+        // Mips are filtered from the RGBA8 levels, every level is compressed on its own.
+        List<byte> chain;
+        chain.SetNum((i32)chainBytes);
+        memcpy(chain.GetData(), pixels, levelBytes);
+        TextureImportFree(pixels);
+        TextureMipGenerateChain(chain.GetData(), textureHeader.width, textureHeader.height, textureHeader.mipCount, settings.textureMipSettings);
+
+        blob.SetNum(chainOffset + (i32)cookedBytes, false);
+        TextureCompressSettings compressSettings = {};
+        compressSettings.format = format;
+        compressSettings.quality = settings.textureCompressQuality;
+        for (i32 mip = 0; mip < textureHeader.mipCount; mip++) {
+            TextureCompress(chain.GetData() + TextureMipGetOffset(textureHeader.width, textureHeader.height, mip),
+                TextureMipGetSize(textureHeader.width, mip), TextureMipGetSize(textureHeader.height, mip),
+                blob.GetData() + chainOffset + TextureFormatGetMipOffset(format, textureHeader.width, textureHeader.height, mip), compressSettings);
+        }
+
+        if (settings.textureReport) {
+            // BC4 only keeps red and BC1 drops alpha, compare only what the format stores.
+            const i32 channelCount = format == TEXTURE_FORMAT_BC4 ? 1 : (format == TEXTURE_FORMAT_BC1 ? 3 : 4);
+            List<byte> decoded;
+            decoded.SetNum((i32)levelBytes);
+            TextureDecompress(blob.GetData() + chainOffset, textureHeader.width, textureHeader.height, format, decoded.GetData());
+            ATTOINFO("%s: %dx%d %s %s, %.2f dB PSNR, %llu -> %llu bytes", path, textureHeader.width, textureHeader.height, TextureFormatToString(format),
+                TextureCompressQualityToString(settings.textureCompressQuality), TextureComputePSNR(chain.GetData(), decoded.GetData(), textureHeader.width, textureHeader.height, channelCount),
+                chainBytes, cookedBytes);
+        }
+
+        return true;
+    }
+
+    static bool CookFont(const char* path, const byte* source, u64 sourceSizeBytes, i64 sourceWriteTime, List<byte>& blob) {
+        CookedFontHeader fontHeader = {};
+        fontHeader.fontSize = FONT_DEFAULT_SIZE;
+        fontHeader.atlasSize = FONT_ATLAS_SIZE;
+        fontHeader.firstChar = FONT_FIRST_CHAR;
+        fontHeader.charCount = FONT_CHAR_COUNT;
+        fontHeader.ttfSizeBytes = (u32)sourceSizeBytes;
+
+        ScratchScope scratch;
+        stbtt_bakedchar* chardata = Memory::AllocateScratchStruct<stbtt_bakedchar>(FONT_CHAR_COUNT);
+        byte* atlas = Memory::AllocateScratchStruct<byte>(FONT_ATLAS_SIZE * FONT_ATLAS_SIZE);
+        if (FontImportBake(source, fontHeader.fontSize, atlas, chardata, fontHeader.ascent, fontHeader.descent, fontHeader.lineGap) == false) {
+            ATTOERROR("Could not cook %s", path);
+            return false;
+        }
+
+        const u64 chardataBytes = sizeof(stbtt_bakedchar) * FONT_CHAR_COUNT;
+        const u64 atlasBytes = FONT_ATLAS_SIZE * FONT_ATLAS_SIZE;
+        CookedPutHeader(blob, ASSET_TYPE_FONT, 0, sourceSizeBytes, sourceWriteTime, sizeof(fontHeader) + chardataBytes + atlasBytes + sourceSizeBytes);
+        CookedPut(blob, &fontHeader, sizeof(fontHeader));
+        CookedPut(blob, chardata, chardataBytes);
+        CookedPut(blob, atlas, atlasBytes);
+        CookedPut(blob, source, sourceSizeBytes);
+
+        return true;
+    }
+
+    u32 CookAssetGetFlags(AssetType type, const CookSettings& settings) {
+        switch (type)
+        {
+        case ASSET_TYPE_MESH:
+        {
+            // Optimize flags in the low bits, the vertex format above them.
+            return settings.meshOptimize.flags | ((u32)settings.meshVertexFormat << 16);
+        }
+        case ASSET_TYPE_TEXTURE:
+        {
+            // Mip settings in the low bits, compression above them. The mip kernel is left out on purpose, they all
+            // produce the same texels.
+            const u32 mipFlags = settings.textureMips ? 1 | ((u32)settings.textureMipSettings.filter << 1) | ((settings.textureMipSettings.srgb ? 1u : 0u) << 8) : 0;
+            return mipFlags | ((u32)settings.textureFormat << 16) | ((u32)settings.textureCompressQuality << 24);
+        }
+        default:
+        {
+            return 0;
+        }
+        }
+    }
+
+    bool CookAsset(AssetType type, const char* path, const byte* source, u64 sourceSizeBytes, i64 sourceWriteTime,
+                   const CookSettings& settings, List<byte>& blob) {
+        switch (type)
+        {
+        case ASSET_TYPE_MESH:
+        {
+            return CookMesh(path, source, sourceSizeBytes, sourceWriteTime, settings, blob);
+        }
+        case ASSET_TYPE_TEXTURE:
+        {
+            return CookTexture(path, source, sourceSizeBytes, sourceWriteTime, settings, blob);
+        }
+        case ASSET_TYPE_FONT:
+        {
+            return CookFont(path, source, sourceSizeBytes, sourceWriteTime, blob);
+        }
+        default:
+        {
+            return false;
+        }
+        }
+    }
+}
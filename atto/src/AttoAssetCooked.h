@@ -0,0 +1,109 @@
+#pragma once
+
+#include "AttoAssetTypes.h"
+#include "AttoAssetImport.h"
+#include "AttoTextureCompress.h"
+#include "AttoTextureMips.h"
+
+#include <stb_truetype/stb_truetype.h>
+
+namespace atto
+{
+    static constexpr u32 COOKED_ASSET_MAGIC = 0x4B435441; // "ATCK"
+    static constexpr u32 COOKED_ASSET_VERSION = 6;
+
+    // Every cooked blob starts with this. The source size, write time and cook flags are what AttoCook compares
+    // to decide whether a source has to be cooked again.
+    struct CookedAssetHeader {
+        u32 magic;
+        u32 version;
+        u32 type;
+        u32 cookFlags;
+        u64 sourceSizeBytes;
+        i64 sourceWriteTime;
+    };
+
+    // Followed by submeshCount MeshSubmeshes, vertexCount vertices in vertexFormat with the import scale applied and
+    // then indexCount indices of indexStride bytes. quantization is only used by the quantized formats. cookFlags
+    // holds the MeshOptimizeFlags the mesh was reordered with and the vertex format.
+    struct CookedMeshHeader {
+        u32                 vertexCount;
+        u32                 vertexStride;
+        u32                 indexCount;
+        u32                 indexStride;
+        u32                 vertexFormat;
+        u32                 submeshCount;
+        MeshQuantization    quantization;
+    };
+
+    // Followed by mipCount levels in format, see TextureFormatGetMipOffset. Every level is stored last row first
+    // and rowPitch is the pitch of level 0, in rows of blocks for the compressed formats. cookFlags holds the mip
+    // and compression settings.
+    struct CookedTextureHeader {
+        i32 width;
+        i32 height;
+        i32 channels;
+        i32 rowPitch;
+        i32 mipCount;
+        u32 mipFilter;
+        u32 srgb;
+        u32 format;
+    };
+
+    // Followed by charCount baked chars, the atlasSize * atlasSize R8 atlas and then the ttf file itself,
+    // which is still needed at runtime for advances and kerning.
+    struct CookedFontHeader {
+        f32 fontSize;
+        i32 ascent;
+        i32 descent;
+        i32 lineGap;
+        i32 atlasSize;
+        i32 firstChar;
+        i32 charCount;
+        u32 ttfSizeBytes;
+    };
+
+    static_assert(sizeof(CookedAssetHeader) == 32, "Cooked headers are written as is, they must not change size");
+    static_assert(sizeof(CookedMeshHeader) == 64, "Cooked headers are written as is, they must not change size");
+    static_assert(sizeof(CookedTextureHeader) == 32, "Cooked headers are written as is, they must not change size");
+    static_assert(sizeof(CookedFontHeader) == 32, "Cooked headers are written as is, they must not change size");
+
+    // Views into a cooked blob, nothing is copied. Cooked meshes are read straight into a MeshPacked.
+    struct CookedTexture {
+        const CookedTextureHeader*  header;
+        const byte*                 pixels;
+    };
+
+    struct CookedFont {
+        const CookedFontHeader*     header;
+        const stbtt_bakedchar*      chardata;
+        const byte*                 atlas;
+        const byte*                 ttf;
+    };
+
+    // nullptr for anything that isn't a cooked blob of the current version, like a raw source file in a pack.
+    const CookedAssetHeader*    CookedAssetGetHeader(const byte* data, u64 sizeBytes);
+    bool                        CookedMeshRead(const byte* data, u64 sizeBytes, MeshPacked& mesh);
+    bool                        CookedTextureRead(const byte* data, u64 sizeBytes, CookedTexture& texture);
+    bool                        CookedFontRead(const byte* data, u64 sizeBytes, CookedFont& font);
+
+    struct CookSettings {
+        MeshOptimizeSettings    meshOptimize;
+        MeshVertexFormat        meshVertexFormat = MESH_VERTEX_FORMAT_PNT;
+        // Cooked textures carry their whole mip chain so loading them is a single immutable create.
+        bool                    textureMips = true;
+        TextureMipSettings      textureMipSettings;
+        // Block compressed formats need both sizes to be a multiple of 4, other textures stay RGBA8.
+        TextureFormat           textureFormat = TEXTURE_FORMAT_RGBA8;
+        TextureCompressQuality  textureCompressQuality = TEXTURE_COMPRESS_QUALITY_DEFAULT;
+        // Log the PSNR of level 0 for every texture that gets compressed.
+        bool                    textureReport = false;
+    };
+
+    // Source file contents in, cooked blob out. Returns false for types that have nothing to cook (audio) and
+    // for sources that fail to import, those are packed as they are.
+    bool                        CookAsset(AssetType type, const char* path, const byte* source, u64 sourceSizeBytes, i64 sourceWriteTime,
+                                          const CookSettings& settings, List<byte>& blob);
+    // What ends up in CookedAssetHeader::cookFlags for a given type.
+    u32                         CookAssetGetFlags(AssetType type, const CookSettings& settings);
+}
@@ -0,0 +1,422 @@
+#include "AttoAssetImport.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image/std_image.h>
+
+#define STB_TRUETYPE_IMPLEMENTATION
+#include <stb_truetype/stb_truetype.h>
+
+#include "AttoJobs.h"
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define IMPORT_TARGET_SSSE3
+#else
+#define IMPORT_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+
+namespace atto
+{
+    static void ProcessMesh(aiMesh* mesh, const aiScene* scene, MeshData& resultingMesh) {
+        resultingMesh.positions.Reserve(mesh->mNumVertices);
+        resultingMesh.normals.Reserve(mesh->mNumVertices);
+        resultingMesh.uvs.Reserve(mesh->mNumVertices);
+        resultingMesh.indices.Reserve(mesh->mNumFaces * 3);
+
+        for (u32 vertexIndex = 0; vertexIndex < mesh->mNumVertices; vertexIndex++) {
+            glm::vec3 position = {};
+            position.x = mesh->mVertices[vertexIndex].x;
+            position.y = mesh->mVertices[vertexIndex].y;
+            position.z = mesh->mVertices[vertexIndex].z;
+
+            position = position;
+
+            glm::vec3 normal = {};
+            normal.x = mesh->mNormals[vertexIndex].x;
+            normal.y = mesh->mNormals[vertexIndex].y;
+            normal.z = mesh->mNormals[vertexIndex].z;
+
+            glm::vec3 tex = {};
+            tex.x = mesh->mTextureCoords[0][vertexIndex].x;
+            tex.y = mesh->mTextureCoords[0][vertexIndex].y;
+
+            resultingMesh.positions.Add(position);
+            resultingMesh.normals.Add(normal);
+            resultingMesh.uvs.Add(tex);
+        }
+
+        for (u32 faceIndex = 0; faceIndex < mesh->mNumFaces; faceIndex++) {
+            aiFace face = mesh->mFaces[faceIndex];
+            for (u32 index = 0; index < face.mNumIndices; index++) {
+                Assert(face.mNumIndices == 3, "Not triangluated");
+                resultingMesh.indices.Add(face.mIndices[index]);
+            }
+        }
+    }
+
+    static void ProcessNode(aiNode* node, const aiScene* scene, List<MeshData>& meshes) {
+        for (u32 i = 0; i < node->mNumMeshes; i++) {
+            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+
+            MeshData &meshData = meshes.Alloc();
+            meshData.name = mesh->mName.C_Str();
+            meshData.materialIndex = mesh->mMaterialIndex;
+            
+            ProcessMesh(mesh, scene, meshData);
+        }
+
+        for (u32 i = 0; i < node->mNumChildren; i++) {
+            ProcessNode(node->mChildren[i], scene, meshes);
+        }
+    }
+
+    void MeshDataPackPNT(const MeshData& meshData, const glm::mat3& scalingMatrix, TransientList<f32>& data) {
+        Assert(meshData.positions.GetNum() == meshData.normals.GetNum(), "Positions and normals must be the same size");
+        Assert(meshData.positions.GetNum() == meshData.uvs.GetNum(), "Positions and uvs must be the same size");
+
+        const i32 vertexCount = meshData.positions.GetNum();
+        data.Reserve(data.GetCount() + vertexCount * (3 + 3 + 2));
+        for (i32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++) {
+            glm::vec3 position = scalingMatrix * meshData.positions[vertexIndex];
+            
+            data.Add(position.x);
+            data.Add(position.y);
+            data.Add(position.z);
+
+            data.Add(meshData.normals[vertexIndex].x);
+            data.Add(meshData.normals[vertexIndex].y);
+            data.Add(meshData.normals[vertexIndex].z);
+
+            data.Add(meshData.uvs[vertexIndex].x);
+            data.Add(meshData.uvs[vertexIndex].y);
+        }
+    }
+
+    void MeshDataOptimize(MeshData& meshData, const MeshOptimizeSettings& settings, MeshOptimizeReport* report) {
+        const i32 vertexCount = meshData.positions.GetNum();
+        const i32 indexCount = meshData.indices.GetNum();
+
+        u32* indices = meshData.indices.GetData();
+
+        if (report != nullptr) {
+            report->before = MeshAnalyzeVertexCache(indices, indexCount, vertexCount);
+        }
+
+        if (settings.flags & MESH_OPTIMIZE_VERTEX_CACHE) {
+            MeshOptimizeVertexCache(indices, indexCount, vertexCount);
+        }
+
+        if (settings.flags & MESH_OPTIMIZE_OVERDRAW) {
+            static_assert(sizeof(glm::vec3) == sizeof(f32) * 3, "Positions are passed on as packed floats");
+            MeshOptimizeOverdraw(indices, indexCount, (const f32*)meshData.positions.GetData(), vertexCount, settings.overdrawThreshold);
+        }
+
+        if (settings.flags & MESH_OPTIMIZE_VERTEX_FETCH) {
+            ScratchScope scratch;
+            i32* remap = Memory::AllocateScratchStruct<i32>(vertexCount);
+            const i32 usedVertexCount = MeshOptimizeVertexFetch(indices, indexCount, vertexCount, remap);
+
+            List<glm::vec3> positions;
+            List<glm::vec3> normals;
+            List<glm::vec2> uvs;
+            positions.SetNum(usedVertexCount, false);
+            normals.SetNum(usedVertexCount, false);
+            uvs.SetNum(usedVertexCount, false);
+            for (i32 vertex = 0; vertex < vertexCount; vertex++) {
+                const i32 target = remap[vertex];
+                if (target >= 0) {
+                    positions[target] = meshData.positions[vertex];
+                    normals[target] = meshData.normals[vertex];
+                    uvs[target] = meshData.uvs[vertex];
+                }
+            }
+
+            meshData.positions = std::move(positions);
+            meshData.normals = std::move(normals);
+            meshData.uvs = std::move(uvs);
+        }
+
+        if (report != nullptr) {
+            report->after = MeshAnalyzeVertexCache(indices, indexCount, meshData.positions.GetNum());
+        }
+    }
+
+    void MeshPackModel(const List<MeshData>& meshes, const glm::mat3& scalingMatrix, MeshVertexFormat vertexFormat, MeshPacked& packed) {
+        const i32 meshCount = meshes.GetNum();
+        u32 vertexCount = 0;
+        u32 indexCount = 0;
+        u32 indexStride = sizeof(u16);
+        for (i32 meshIndex = 0; meshIndex < meshCount; meshIndex++) {
+            const u32 meshVertexCount = (u32)meshes[meshIndex].positions.GetNum();
+            vertexCount += meshVertexCount;
+            indexCount += (u32)meshes[meshIndex].indices.GetNum();
+            // Indices are relative to each submesh, so only a single huge submesh needs 32 bits.
+            if (meshVertexCount > UINT16_MAX + 1) {
+                indexStride = sizeof(u32);
+            }
+        }
+
+        MeshSubmesh* submeshes = Memory::AllocateScratchStruct<MeshSubmesh>(meshCount);
+        TransientList<f32> vertices(Memory::GetScratchArena(), (i32)vertexCount * MESH_PNT_FLOATS_PER_VERTEX);
+        byte* indices = (byte*)Memory::AllocateScratch((u64)indexCount * indexStride);
+
+        u32 indexOffset = 0;
+        for (i32 meshIndex = 0; meshIndex < meshCount; meshIndex++) {
+            const MeshData& meshData = meshes[meshIndex];
+            MeshSubmesh& submesh = submeshes[meshIndex];
+            submesh.indexOffset = indexOffset;
+            submesh.indexCount = (u32)meshData.indices.GetNum();
+            submesh.baseVertex = (u32)(vertices.GetCount() / MESH_PNT_FLOATS_PER_VERTEX);
+            submesh.materialIndex = meshData.materialIndex;
+
+            MeshDataPackPNT(meshData, scalingMatrix, vertices);
+
+            if (indexStride == sizeof(u32)) {
+                memcpy(indices + (u64)indexOffset * indexStride, meshData.indices.GetData(), sizeof(u32) * (u64)submesh.indexCount);
+            }
+            else {
+                u16* indices16 = (u16*)indices + indexOffset;
+                for (u32 index = 0; index < submesh.indexCount; index++) {
+                    indices16[index] = (u16)meshData.indices[index];
+                }
+            }
+
+            indexOffset += submesh.indexCount;
+        }
+
+        packed = {};
+        packed.vertexFormat = vertexFormat;
+        packed.vertices = vertices.GetData();
+        packed.vertexCount = vertexCount;
+        packed.indices = indices;
+        packed.indexCount = indexCount;
+        packed.indexStride = indexStride;
+        packed.submeshes = submeshes;
+        packed.submeshCount = (u32)meshCount;
+
+        if (vertexFormat != MESH_VERTEX_FORMAT_PNT) {
+            MeshQuantizedVertex* quantized = Memory::AllocateScratchStruct<MeshQuantizedVertex>((i32)vertexCount);
+            MeshQuantizationCompute(vertices.GetData(), (i32)vertexCount, vertexFormat, packed.quantization);
+            MeshEncodeQuantized(vertices.GetData(), (i32)vertexCount, vertexFormat, packed.quantization, quantized);
+            packed.vertices = quantized;
+        }
+    }
+
+    u32 MeshImportGetFlags() {
+        return aiProcess_Triangulate | aiProcess_JoinIdenticalVertices;
+    }
+
+    bool MeshImport(const char* path, const byte* data, u64 sizeBytes, List<MeshData>& meshes, const MeshOptimizeSettings& settings) {
+        const u32 importFlags = MeshImportGetFlags();
+        Assimp::Importer importer;
+        const aiScene* scene = nullptr;
+        if (data != nullptr) {
+            // Assimp picks the importer from the hint, which is the file extension without the dot.
+            const char* extension = strrchr(path, '.');
+            scene = importer.ReadFileFromMemory(data, (size_t)sizeBytes, importFlags, extension != nullptr ? extension + 1 : "");
+        }
+        else {
+            scene = importer.ReadFile(path, importFlags);
+        }
+
+        if (scene == nullptr || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+            ATTOFATAL("ERROR::ASSIMP::%s", importer.GetErrorString());
+            return false;
+        }
+
+        ProcessNode(scene->mRootNode, scene, meshes);
+
+        const i32 meshCount = meshes.GetNum();
+        for (i32 meshIndex = 0; meshIndex < meshCount; meshIndex++) {
+            MeshData& meshData = meshes[meshIndex];
+            MeshOptimizeReport report = {};
+            MeshDataOptimize(meshData, settings, settings.report ? &report : nullptr);
+            if (settings.report) {
+                ATTOINFO("%s '%s': %d triangles, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", path, meshData.name.GetCStr(), meshData.indices.GetNum() / 3,
+                    report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr);
+            }
+        }
+
+        return true;
+    }
+
+    glm::mat3 MeshImportGetScale(const char* path) {
+        const i32 pathLength = (i32)strlen(path);
+        if (pathLength >= 3 && strcmp(path + pathLength - 3, "fbx") == 0) {
+            return glm::mat3(glm::scale(glm::mat4(1), glm::vec3(0.01f)));
+        }
+
+        return glm::mat3(1);
+    }
+
+    byte* TextureImport(const byte* data, u64 sizeBytes, i32& width, i32& height, i32& channels) {
+        byte* pixels = stbi_load_from_memory(data, (i32)sizeBytes, &width, &height, &channels, 0);
+        if (pixels == nullptr) {
+            return nullptr;
+        }
+
+        // stbi_set_flip_vertically_on_load is global state, flipping here keeps decoding thread safe.
+        const i32 rowBytes = width * channels;
+        ScratchScope scratch;
+        byte* row = Memory::AllocateScratchStruct<byte>(rowBytes);
+        for (i32 top = 0, bottom = height - 1; top < bottom; top++, bottom--) {
+            byte* topRow = pixels + (u64)top * rowBytes;
+            byte* bottomRow = pixels + (u64)bottom * rowBytes;
+            memcpy(row, topRow, rowBytes);
+            memcpy(topRow, bottomRow, rowBytes);
+            memcpy(bottomRow, row, rowBytes);
+        }
+
+        return pixels;
+    }
+
+    byte* TextureImportRGBA8(const byte* data, u64 sizeBytes, i32& width, i32& height, i32& channels) {
+        byte* pixels = TextureImport(data, sizeBytes, width, height, channels);
+        if (pixels == nullptr || channels == 4) {
+            return pixels;
+        }
+
+        // stb_image allocates with malloc, so TextureImportFree works on either buffer.
+        const u64 texelCount = (u64)width * height;
+        byte* rgba = (byte*)malloc(texelCount * 4);
+        TextureExpandRGBA8(pixels, channels, texelCount, rgba);
+        stbi_image_free(pixels);
+
+        return rgba;
+    }
+
+    void TextureImportFree(byte* pixels) {
+        stbi_image_free(pixels);
+    }
+
+    static bool ImportCpuHasSSSE3() {
+#if defined(_MSC_VER)
+        i32 info[4] = {};
+        __cpuid(info, 1);
+        return (info[2] & (1 << 9)) != 0;
+#else
+        return __builtin_cpu_supports("ssse3");
+#endif
+    }
+
+    static void TextureExpandScalar(const byte* source, i32 channels, u64 texelCount, byte* rgba) {
+        for (u64 texel = 0; texel < texelCount; texel++) {
+            const byte* in = source + texel * channels;
+            byte* out = rgba + texel * 4;
+            switch (channels)
+            {
+            case 1: out[0] = in[0]; out[1] = in[0]; out[2] = in[0]; out[3] = 255; break;
+            case 2: out[0] = in[0]; out[1] = in[0]; out[2] = in[0]; out[3] = in[1]; break;
+            case 3: out[0] = in[0]; out[1] = in[1]; out[2] = in[2]; out[3] = 255; break;
+            default: memcpy(out, in, 4); break;
+            }
+        }
+    }
+
+    // 16 grey texels in, 64 bytes out. Interleaving grey with itself and with 255 builds the two halves of every texel.
+    static u64 TextureExpandGreySSE(const byte* source, u64 texelCount, byte* rgba) {
+        const __m128i opaque = _mm_set1_epi8((char)0xFF);
+        u64 texel = 0;
+        for (; texel + 16 <= texelCount; texel += 16) {
+            const __m128i grey = _mm_loadu_si128((const __m128i*)(source + texel));
+            const __m128i greyGreyLow = _mm_unpacklo_epi8(grey, grey);
+            const __m128i greyGreyHigh = _mm_unpackhi_epi8(grey, grey);
+            const __m128i greyAlphaLow = _mm_unpacklo_epi8(grey, opaque);
+            const __m128i greyAlphaHigh = _mm_unpackhi_epi8(grey, opaque);
+            __m128i* out = (__m128i*)(rgba + texel * 4);
+            _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(greyGreyLow, greyAlphaLow));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(greyGreyLow, greyAlphaLow));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(greyGreyHigh, greyAlphaHigh));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(greyGreyHigh, greyAlphaHigh));
+        }
+        return texel;
+    }
+
+    // 8 grey alpha texels in, 32 bytes out. The source pair is already the upper half of the texel.
+    static u64 TextureExpandGreyAlphaSSE(const byte* source, u64 texelCount, byte* rgba) {
+        const __m128i greyMask = _mm_set1_epi16(0x00FF);
+        u64 texel = 0;
+        for (; texel + 8 <= texelCount; texel += 8) {
+            const __m128i greyAlpha = _mm_loadu_si128((const __m128i*)(source + texel * 2));
+            const __m128i grey = _mm_and_si128(greyAlpha, greyMask);
+            const __m128i greyGrey = _mm_or_si128(grey, _mm_slli_epi16(grey, 8));
+            __m128i* out = (__m128i*)(rgba + texel * 4);
+            _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(greyGrey, greyAlpha));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(greyGrey, greyAlpha));
+        }
+        return texel;
+    }
+
+    // 4 RGB texels per shuffle. Every load reads 16 bytes for the 12 it uses, so the loop stops while 6 texels remain.
+    IMPORT_TARGET_SSSE3 static u64 TextureExpandRGBSSSE3(const byte* source, u64 texelCount, byte* rgba) {
+        const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m128i opaque = _mm_set1_epi32((i32)0xFF000000);
+        u64 texel = 0;
+        for (; texel + 6 <= texelCount; texel += 4) {
+            const __m128i rgb = _mm_loadu_si128((const __m128i*)(source + texel * 3));
+            _mm_storeu_si128((__m128i*)(rgba + texel * 4), _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), opaque));
+        }
+        return texel;
+    }
+
+    void TextureExpandRGBA8(const byte* source, i32 channels, u64 texelCount, byte* rgba) {
+        static const bool hasSSSE3 = ImportCpuHasSSSE3();
+
+        u64 done = 0;
+        switch (channels)
+        {
+        case 1: done = TextureExpandGreySSE(source, texelCount, rgba); break;
+        case 2: done = TextureExpandGreyAlphaSSE(source, texelCount, rgba); break;
+        case 3: done = hasSSSE3 ? TextureExpandRGBSSSE3(source, texelCount, rgba) : 0; break;
+        default: break;
+        }
+
+        TextureExpandScalar(source + done * channels, channels, texelCount - done, rgba + done * 4);
+    }
+
+    struct TextureImportBatchContext {
+        TextureImportRequest*   requests;
+        i32                     count;
+        i32                     stride;
+    };
+
+    // Every job decodes requests index, index + stride, ... so no more than stride decode at once.
+    static void TextureImportBatchJob(i32 index, void* userData) {
+        const TextureImportBatchContext* context = (const TextureImportBatchContext*)userData;
+        for (i32 requestIndex = index; requestIndex < context->count; requestIndex += context->stride) {
+            TextureImportRequest& request = context->requests[requestIndex];
+            request.pixels = request.data != nullptr ? TextureImport(request.data, request.sizeBytes, request.width, request.height, request.channels) : nullptr;
+        }
+    }
+
+    void TextureImportBatch(TextureImportRequest* requests, i32 count, i32 threadCount) {
+        TextureImportBatchContext context = {};
+        context.requests = requests;
+        context.count = count;
+        context.stride = threadCount > 0 && threadCount < count ? threadCount : count;
+        if (count > 0) {
+            Jobs::ParallelFor(context.stride, TextureImportBatchJob, &context);
+        }
+    }
+
+    bool FontImportBake(const byte* ttf, f32 fontSize, byte* atlas, stbtt_bakedchar* chardata, i32& ascent, i32& descent, i32& lineGap) {
+        stbtt_fontinfo info = {};
+        if (stbtt_InitFont(&info, ttf, 0) == 0) {
+            ATTOERROR("Could not init font");
+            return false;
+        }
+
+        stbtt_GetFontVMetrics(&info, &ascent, &descent, &lineGap);
+
+        // A negative result means not every character fit, the ones that did are still usable.
+        stbtt_BakeFontBitmap(ttf, 0, fontSize, atlas, FONT_ATLAS_SIZE, FONT_ATLAS_SIZE, FONT_FIRST_CHAR, FONT_CHAR_COUNT, chardata);
+
+        return true;
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "AttoLib.h"
+#include "AttoMeshOptimize.h"
+#include "AttoMeshQuantize.h"
+
+#include <stb_truetype/stb_truetype.h>
+
+namespace atto
+{
+    // Source file decoding, shared by the engine and AttoCook. Nothing in here touches the GPU and
+    // everything is safe to call from several threads at once.
+
+    struct MeshData {
+        SmallString name;
+        u32 materialIndex;
+        List<glm::vec3> positions;
+        List<glm::vec3> normals;
+        List<glm::vec2> uvs;
+        List<u32> indices;
+    };
+
+    // One imported mesh inside a model's shared buffers. Indices are relative to baseVertex.
+    struct MeshSubmesh {
+        u32 indexOffset;
+        u32 indexCount;
+        u32 baseVertex;
+        u32 materialIndex;
+    };
+
+    // A whole model in one vertex and one index buffer, as cooked and as handed to the renderer.
+    struct MeshPacked {
+        MeshVertexFormat    vertexFormat;
+        MeshQuantization    quantization;
+        const void*         vertices;
+        u32                 vertexCount;
+        const void*         indices;
+        u32                 indexCount;
+        // 2 unless a submesh has more vertices than u16 indices can reach.
+        u32                 indexStride;
+        const MeshSubmesh*  submeshes;
+        u32                 submeshCount;
+    };
+
+    static constexpr f32 FONT_DEFAULT_SIZE = 24.0f;
+    static constexpr i32 FONT_ATLAS_SIZE = 256;
+    static constexpr i32 FONT_FIRST_CHAR = 32;
+    static constexpr i32 FONT_CHAR_COUNT = 96;
+
+    // With data == nullptr the file is read from path, otherwise data is the file contents and path only picks the importer.
+    // Every imported mesh goes through MeshDataOptimize with the given settings.
+    bool        MeshImport(const char* path, const byte* data, u64 sizeBytes, List<MeshData>& meshes, const MeshOptimizeSettings& settings = MeshOptimizeSettings());
+    // The aiPostProcessSteps MeshImport asks Assimp for.
+    u32         MeshImportGetFlags();
+    // Reorders triangles and vertices as asked for by settings.flags, report may be nullptr.
+    void        MeshDataOptimize(MeshData& meshData, const MeshOptimizeSettings& settings, MeshOptimizeReport* report);
+    // FBX files are authored in centimetres.
+    glm::mat3   MeshImportGetScale(const char* path);
+    void        MeshDataPackPNT(const MeshData& meshData, const glm::mat3& scalingMatrix, TransientList<f32>& data);
+    // Packs every mesh into shared buffers in vertexFormat. Everything packed points into the scratch arena, keep a
+    // ScratchScope open around it for as long as packed is used.
+    void        MeshPackModel(const List<MeshData>& meshes, const glm::mat3& scalingMatrix, MeshVertexFormat vertexFormat, MeshPacked& packed);
+
+    // Decodes keeping the source channel count (1 grey, 2 grey alpha, 3 RGB, 4 RGBA) with the last row first, which
+    // is what the renderer expects. Safe to call from any thread. Free the result with TextureImportFree.
+    byte*       TextureImport(const byte* data, u64 sizeBytes, i32& width, i32& height, i32& channels);
+    // Same as TextureImport, then expanded to RGBA8. channels is still the source channel count.
+    byte*       TextureImportRGBA8(const byte* data, u64 sizeBytes, i32& width, i32& height, i32& channels);
+    void        TextureImportFree(byte* pixels);
+    // Expands texels with fewer than 4 channels the way stb_image does, grey goes to RGB and missing alpha is opaque.
+    void        TextureExpandRGBA8(const byte* source, i32 channels, u64 texelCount, byte* rgba);
+
+    struct TextureImportRequest {
+        const byte*     data;
+        u64             sizeBytes;
+        // Written by TextureImportBatch, pixels is nullptr when the image could not be decoded.
+        byte*           pixels;
+        i32             width;
+        i32             height;
+        i32             channels;
+    };
+
+    // Decodes every request with TextureImport on the job workers. threadCount limits how many decode at once,
+    // 0 or less uses every worker and the calling thread.
+    void        TextureImportBatch(TextureImportRequest* requests, i32 count, i32 threadCount = 0);
+
+    // Bakes FONT_CHAR_COUNT characters from FONT_FIRST_CHAR into a FONT_ATLAS_SIZE square R8 atlas.
+    bool        FontImportBake(const byte* ttf, f32 fontSize, byte* atlas, stbtt_bakedchar* chardata, i32& ascent, i32& descent, i32& lineGap);
+}
@@ -0,0 +1,168 @@
+#include "AttoAsset.h"
+
+#include <filesystem>
+
+namespace atto
+{
+    static constexpr u32 ASSET_MANIFEST_MAGIC = 0x464D5441; // "ATMF"
+    static constexpr u32 ASSET_MANIFEST_VERSION = 1;
+
+    // Layout, all little endian:
+    //  u32 magic, u32 version, string root
+    //  i32 directoryCount, { string path, i64 writeTime } * directoryCount
+    //  i32 entryCount, { u32 id, u32 type, u64 sizeBytes, i64 writeTime, string path } * entryCount
+    // Strings are an i32 length followed by the characters, no terminator.
+    static constexpr i32 ASSET_MANIFEST_ENTRY_FIXED_BYTES = sizeof(u32) + sizeof(u32) + sizeof(u64) + sizeof(i64);
+
+    static i64 AssetManifestWriteTime(const char* path, bool& exists) {
+        std::error_code error;
+        const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path, error);
+        exists = !error;
+
+        return exists ? (i64)writeTime.time_since_epoch().count() : 0;
+    }
+
+    LargeString LeEngine::AssetManifestGetPath() const {
+        // Lives next to the asset root, not inside it, so that writing it doesn't change the times it records.
+        const char* root = app->looseAssetPath.GetCStr();
+        i32 rootLength = app->looseAssetPath.GetLength();
+        while (rootLength > 0 && (root[rootLength - 1] == '/' || root[rootLength - 1] == '\\')) {
+            rootLength--;
+        }
+
+        return StringFormat::Large("%.*s.manifest", rootLength, root);
+    }
+
+    // Only directory write times are checked. Adding, removing or renaming a file changes the write time of its
+    // directory, so that is enough to know the set of assets is unchanged. The stored file sizes and write
+    // times are as of the last full scan.
+    bool LeEngine::AssetManifestLoad(const char* manifestPath) {
+        std::error_code error;
+        if (std::filesystem::exists(manifestPath, error) == false) {
+            ATTOINFO("No asset manifest at %s, scanning %s", manifestPath, app->looseAssetPath.GetCStr());
+            return false;
+        }
+
+        PackedAssetFile file;
+        if (file.Load(manifestPath) == false) {
+            return false;
+        }
+
+        u32 magic = 0;
+        u32 version = 0;
+        if (file.CanGet(sizeof(magic) + sizeof(version)) == false) {
+            ATTOWARN("Asset manifest %s is truncated", manifestPath);
+            return false;
+        }
+
+        file.Get(magic);
+        file.Get(version);
+        if (magic != ASSET_MANIFEST_MAGIC || version != ASSET_MANIFEST_VERSION) {
+            ATTOINFO("Asset manifest %s is from another version, rescanning", manifestPath);
+            return false;
+        }
+
+        i32 rootLength = 0;
+        const char* root = file.GetString(rootLength);
+        if (root == nullptr || rootLength != app->looseAssetPath.GetLength() || memcmp(root, app->looseAssetPath.GetCStr(), rootLength) != 0) {
+            ATTOINFO("Asset manifest %s was written for another asset root, rescanning", manifestPath);
+            return false;
+        }
+
+        i32 directoryCount = 0;
+        if (file.CanGet(sizeof(directoryCount)) == false) {
+            return false;
+        }
+
+        file.Get(directoryCount);
+        for (i32 directoryIndex = 0; directoryIndex < directoryCount; directoryIndex++) {
+            i32 pathLength = 0;
+            const char* pathData = file.GetString(pathLength);
+            i64 writeTime = 0;
+            if (pathData == nullptr || file.CanGet(sizeof(writeTime)) == false) {
+                ATTOWARN("Asset manifest %s is truncated", manifestPath);
+                return false;
+            }
+            file.Get(writeTime);
+
+            const StringAtom path = StringAtom::Intern(pathData, pathLength);
+
+            bool exists = false;
+            if (AssetManifestWriteTime(path.GetCStr(), exists) != writeTime || exists == false) {
+                ATTOINFO("Asset manifest is stale, %s changed", path.GetCStr());
+                return false;
+            }
+        }
+
+        // Read everything before registering anything, a bad manifest must not leave the asset lists half filled.
+        i32 entryCount = 0;
+        if (file.CanGet(sizeof(entryCount)) == false) {
+            return false;
+        }
+
+        file.Get(entryCount);
+        StringAtom::Reserve(entryCount);
+        List<AssetManifestEntry> entries;
+        entries.Reserve(entryCount);
+        for (i32 entryIndex = 0; entryIndex < entryCount; entryIndex++) {
+            if (file.CanGet(ASSET_MANIFEST_ENTRY_FIXED_BYTES) == false) {
+                ATTOWARN("Asset manifest %s is truncated", manifestPath);
+                return false;
+            }
+
+            AssetManifestEntry entry = {};
+            u32 type = 0;
+            file.Get(entry.id.id);
+            file.Get(type);
+            file.Get(entry.sizeBytes);
+            file.Get(entry.writeTime);
+            entry.type = (AssetType)type;
+
+            i32 pathLength = 0;
+            const char* path = file.GetString(pathLength);
+            if (path == nullptr) {
+                ATTOWARN("Asset manifest %s is truncated", manifestPath);
+                return false;
+            }
+            entry.path = StringAtom::Intern(path, pathLength);
+
+            entries.Add(entry);
+        }
+
+        for (i32 entryIndex = 0; entryIndex < entryCount; entryIndex++) {
+            RegisterAssetEntry(entries[entryIndex]);
+        }
+
+        return true;
+    }
+
+    void LeEngine::AssetManifestSave(const char* manifestPath, const List<AssetManifestDirectory>& directories, const List<AssetManifestEntry>& entries) {
+        PackedAssetFile file;
+        file.Put(ASSET_MANIFEST_MAGIC);
+        file.Put(ASSET_MANIFEST_VERSION);
+        file.PutString(app->looseAssetPath.GetCStr(), app->looseAssetPath.GetLength());
+
+        const i32 directoryCount = directories.GetNum();
+        file.Put(directoryCount);
+        for (i32 directoryIndex = 0; directoryIndex < directoryCount; directoryIndex++) {
+            const AssetManifestDirectory& directory = directories[directoryIndex];
+            file.PutString(directory.path.GetCStr(), directory.path.GetLength());
+            file.Put(directory.writeTime);
+        }
+
+        const i32 entryCount = entries.GetNum();
+        file.Put(entryCount);
+        for (i32 entryIndex = 0; entryIndex < entryCount; entryIndex++) {
+            const AssetManifestEntry& entry = entries[entryIndex];
+            file.Put(entry.id.id);
+            file.Put((u32)entry.type);
+            file.Put(entry.sizeBytes);
+            file.Put(entry.writeTime);
+            file.PutString(entry.path.GetCStr(), entry.path.GetLength());
+        }
+
+        if (file.Save(manifestPath)) {
+            ATTOINFO("Wrote asset manifest %s, %d assets in %d directories", manifestPath, entryCount, directoryCount);
+        }
+    }
+}
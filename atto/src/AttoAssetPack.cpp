@@ -0,0 +1,320 @@
+#include "AttoAssetPack.h"
+#include "AttoLib.h"
+
+namespace atto
+{
+    bool AssetPackWriter::Begin(const char* path, LZLevel level) {
+        packPath = LargeString::FromLiteral(path);
+        compression = level;
+        offset = 0;
+        rawBytes = 0;
+        storedBytes = 0;
+        duplicateCount = 0;
+        duplicateBytes = 0;
+        entries.Clear();
+        strings.Clear();
+        payloads.Clear();
+
+        // Opened for reading too, duplicates are checked against what was written.
+        stream.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!stream.is_open()) {
+            ATTOERROR("AssetPackWriter::Begin -> Could not open file %s", path);
+            return false;
+        }
+
+        // Zeroed until End succeeds, so a pack that was never finished fails the magic check.
+        const AssetPackHeader header = {};
+        stream.write((const char*)&header, sizeof(header));
+        offset = sizeof(header);
+
+        return WritePadding();
+    }
+
+    bool AssetPackWriter::Add(AssetId id, AssetType type, const char* path, const void* data, u64 sizeBytes) {
+        if (sizeBytes > ASSET_PACK_MAX_PAYLOAD_BYTES) {
+            ATTOERROR("AssetPackWriter::Add -> %s is %llu bytes, payloads can't be larger than %llu", path, sizeBytes, ASSET_PACK_MAX_PAYLOAD_BYTES);
+            return false;
+        }
+
+        const i32 pathLength = (i32)strlen(path);
+
+        AssetPackEntry entry = {};
+        entry.id = id.id;
+        entry.type = (u32)type;
+        entry.offset = offset;
+        entry.sizeBytes = sizeBytes;
+        entry.pathOffset = (u32)strings.GetNum();
+        entry.pathLength = (u32)pathLength;
+        entry.storedSizeBytes = sizeBytes;
+        entry.compression = LZ_LEVEL_NONE;
+
+        const u64 hash = StringHash::XXHash64((const char*)data, sizeBytes);
+        const i32 duplicateIndex = FindDuplicate(hash, data, sizeBytes);
+        if (duplicateIndex >= 0) {
+            const AssetPackEntry& original = entries[duplicateIndex];
+            entry.offset = original.offset;
+            entry.storedSizeBytes = original.storedSizeBytes;
+            entry.compression = original.compression;
+            ATTOINFO("AssetPackWriter -> %s is identical to %s, stored once", path, strings.GetData() + original.pathOffset);
+        }
+        else if (compression != LZ_LEVEL_NONE && sizeBytes > 0 && sizeBytes <= ASSET_PACK_MAX_PAYLOAD_BYTES - ASSET_PACK_MAX_PAYLOAD_BYTES / 16) {
+            // Only worth a decode on load if it saves more than a sixteenth. The encoder's working buffer is a
+            // little larger than the input, payloads near the limit are stored as they are.
+            LZCompressChunks((const byte*)data, sizeBytes, compressed, compression);
+            if ((u64)compressed.GetNum() < sizeBytes - sizeBytes / 16) {
+                entry.storedSizeBytes = (u64)compressed.GetNum();
+                entry.compression = compression;
+            }
+        }
+
+        for (i32 charIndex = 0; charIndex <= pathLength; charIndex++) {
+            strings.Add(path[charIndex]);
+        }
+
+        rawBytes += sizeBytes;
+        if (duplicateIndex >= 0) {
+            entries.Add(entry);
+            duplicateCount++;
+            duplicateBytes += entry.storedSizeBytes;
+            return true;
+        }
+
+        payloads.Add({ hash, sizeBytes, entries.GetNum() });
+        entries.Add(entry);
+
+        const void* stored = entry.compression != LZ_LEVEL_NONE ? (const void*)compressed.GetData() : data;
+        stream.write((const char*)stored, (std::streamsize)entry.storedSizeBytes);
+        offset += entry.storedSizeBytes;
+        storedBytes += entry.storedSizeBytes;
+
+        return WritePadding();
+    }
+
+    bool AssetPackWriter::AddFile(const AssetManifestEntry& entry) {
+        MappedFile source;
+        if (source.Open(entry.path.GetCStr()) == false) {
+            return false;
+        }
+
+        return Add(entry.id, entry.type, entry.path.GetCStr(), source.GetData(), source.GetSize());
+    }
+
+    bool AssetPackWriter::End() {
+        entries.IntroSort([](const AssetPackEntry& a, const AssetPackEntry& b) {
+            return a.id < b.id;
+        });
+
+        const i32 entryCount = entries.GetNum();
+        for (i32 entryIndex = 1; entryIndex < entryCount; entryIndex++) {
+            if (entries[entryIndex].id == entries[entryIndex - 1].id) {
+                ATTOERROR("AssetPackWriter::End -> %s and %s both have id %u, %s is not usable",
+                    strings.GetData() + entries[entryIndex - 1].pathOffset, strings.GetData() + entries[entryIndex].pathOffset,
+                    entries[entryIndex].id, packPath.GetCStr());
+                stream.close();
+                return false;
+            }
+        }
+
+        AssetPackHeader header = {};
+        header.magic = ASSET_PACK_MAGIC;
+        header.version = ASSET_PACK_VERSION;
+        header.entryCount = (u32)entryCount;
+        header.payloadAlignment = ASSET_PACK_PAYLOAD_ALIGNMENT;
+        header.tocOffset = offset;
+        header.stringsOffset = header.tocOffset + sizeof(AssetPackEntry) * (u64)entryCount;
+        header.stringsSizeBytes = (u64)strings.GetNum();
+        header.fileSizeBytes = header.stringsOffset + header.stringsSizeBytes;
+
+        stream.write((const char*)entries.GetData(), (std::streamsize)(sizeof(AssetPackEntry) * (u64)entryCount));
+        stream.write(strings.GetData(), (std::streamsize)strings.GetNum());
+        stream.seekp(0, std::ios::beg);
+        stream.write((const char*)&header, sizeof(header));
+        stream.close();
+
+        if (stream.fail()) {
+            ATTOERROR("AssetPackWriter::End -> Could not write %s", packPath.GetCStr());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool AssetPackWriter::WriteFiles(const char* packPath, const List<AssetManifestEntry>& entries, LZLevel compression) {
+        AssetPackWriter writer;
+        if (writer.Begin(packPath, compression) == false) {
+            return false;
+        }
+
+        const i32 entryCount = entries.GetNum();
+        for (i32 entryIndex = 0; entryIndex < entryCount; entryIndex++) {
+            if (writer.AddFile(entries[entryIndex]) == false) {
+                writer.stream.close();
+                return false;
+            }
+        }
+
+        return writer.End();
+    }
+
+    i32 AssetPackWriter::FindDuplicate(u64 hash, const void* data, u64 sizeBytes) {
+        // A linear scan over 24 byte records, packs hold thousands of payloads, not millions.
+        const i32 payloadCount = payloads.GetNum();
+        for (i32 payloadIndex = 0; payloadIndex < payloadCount; payloadIndex++) {
+            const Payload& payload = payloads[payloadIndex];
+            if (payload.hash != hash || payload.sizeBytes != sizeBytes) {
+                continue;
+            }
+
+            const AssetPackEntry& original = entries[payload.entryIndex];
+            readBack.SetNum((i32)original.storedSizeBytes);
+            stream.seekg((std::streamoff)original.offset, std::ios::beg);
+            stream.read((char*)readBack.GetData(), (std::streamsize)original.storedSizeBytes);
+            if (stream.fail()) {
+                // Left failed, every later write would silently go nowhere. Stored again instead of shared.
+                ATTOWARN("AssetPackWriter -> Could not read back %s from %s, not checked for duplicates",
+                    strings.GetData() + original.pathOffset, packPath.GetCStr());
+                stream.clear();
+                stream.seekp((std::streamoff)offset, std::ios::beg);
+                return -1;
+            }
+            stream.seekp((std::streamoff)offset, std::ios::beg);
+
+            bool identical = false;
+            if (original.compression == LZ_LEVEL_NONE) {
+                identical = sizeBytes == 0 || memcmp(readBack.GetData(), data, sizeBytes) == 0;
+            }
+            else {
+                List<byte> decoded;
+                decoded.SetNum((i32)sizeBytes);
+                identical = LZDecompressChunks(readBack.GetData(), original.storedSizeBytes, decoded.GetData(), sizeBytes) &&
+                    memcmp(decoded.GetData(), data, sizeBytes) == 0;
+            }
+
+            if (identical) {
+                return payload.entryIndex;
+            }
+        }
+
+        return -1;
+    }
+
+    bool AssetPackWriter::WritePadding() {
+        static const char zeros[ASSET_PACK_PAYLOAD_ALIGNMENT] = {};
+        const u64 alignedOffset = AlignUpWithMask(offset, ASSET_PACK_PAYLOAD_ALIGNMENT - 1);
+        stream.write(zeros, (std::streamsize)(alignedOffset - offset));
+        offset = alignedOffset;
+
+        if (stream.fail()) {
+            ATTOERROR("AssetPackWriter -> Could not write %s", packPath.GetCStr());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool AssetPack::Open(const char* packPath) {
+        Close();
+
+        if (file.Open(packPath) == false) {
+            return false;
+        }
+
+        const byte* data = file.GetData();
+        const u64 size = file.GetSize();
+        const AssetPackHeader* packHeader = (const AssetPackHeader*)data;
+        if (size < sizeof(AssetPackHeader) || packHeader->magic != ASSET_PACK_MAGIC || packHeader->version != ASSET_PACK_VERSION) {
+            ATTOERROR("AssetPack::Open -> %s is not an asset pack or is from another version", packPath);
+            Close();
+            return false;
+        }
+
+        const u64 tocSizeBytes = sizeof(AssetPackEntry) * (u64)packHeader->entryCount;
+        const bool layoutValid =
+            packHeader->fileSizeBytes == size &&
+            packHeader->tocOffset % alignof(AssetPackEntry) == 0 &&
+            packHeader->tocOffset <= size && tocSizeBytes <= size - packHeader->tocOffset &&
+            packHeader->stringsOffset <= size && packHeader->stringsSizeBytes <= size - packHeader->stringsOffset;
+        if (layoutValid == false) {
+            ATTOERROR("AssetPack::Open -> %s is truncated or corrupt", packPath);
+            Close();
+            return false;
+        }
+
+        const AssetPackEntry* packEntries = (const AssetPackEntry*)(data + packHeader->tocOffset);
+        const char* packStrings = (const char*)(data + packHeader->stringsOffset);
+        for (u32 entryIndex = 0; entryIndex < packHeader->entryCount; entryIndex++) {
+            const AssetPackEntry& entry = packEntries[entryIndex];
+            const bool entryValid =
+                entry.offset <= packHeader->tocOffset && entry.storedSizeBytes <= packHeader->tocOffset - entry.offset &&
+                entry.sizeBytes <= ASSET_PACK_MAX_PAYLOAD_BYTES && entry.storedSizeBytes <= ASSET_PACK_MAX_PAYLOAD_BYTES &&
+                entry.compression < LZ_LEVEL_COUNT &&
+                (entry.compression != LZ_LEVEL_NONE || entry.storedSizeBytes == entry.sizeBytes) &&
+                (u64)entry.pathOffset + entry.pathLength < packHeader->stringsSizeBytes &&
+                packStrings[entry.pathOffset + entry.pathLength] == '\0' &&
+                (entryIndex == 0 || packEntries[entryIndex - 1].id < entry.id);
+            if (entryValid == false) {
+                ATTOERROR("AssetPack::Open -> %s has a bad table of contents entry %u", packPath, entryIndex);
+                Close();
+                return false;
+            }
+        }
+
+        header = packHeader;
+        entries = packEntries;
+        strings = packStrings;
+        this->packPath = LargeString::FromLiteral(packPath);
+
+        return true;
+    }
+
+    void AssetPack::Close() {
+        file.Close();
+        packPath.Clear();
+        header = nullptr;
+        entries = nullptr;
+        strings = nullptr;
+    }
+
+    const AssetPackEntry* AssetPack::Find(AssetId id) const {
+        i32 low = 0;
+        i32 high = GetEntryCount() - 1;
+        while (low <= high) {
+            const i32 mid = low + (high - low) / 2;
+            const u32 midId = entries[mid].id;
+            if (midId < id.id) {
+                low = mid + 1;
+            }
+            else if (midId > id.id) {
+                high = mid - 1;
+            }
+            else {
+                return &entries[mid];
+            }
+        }
+
+        return nullptr;
+    }
+
+    const byte* AssetPack::GetPayload(const AssetPackEntry& entry, List<byte>& storage) const {
+        return DecodePayload(entry, file.GetData() + entry.offset, storage);
+    }
+
+    const byte* AssetPack::DecodePayload(const AssetPackEntry& entry, const byte* stored, List<byte>& storage) const {
+        if (entry.compression == LZ_LEVEL_NONE) {
+            return stored;
+        }
+
+        storage.SetNum((i32)entry.sizeBytes);
+        if (LZDecompressChunks(stored, entry.storedSizeBytes, storage.GetData(), entry.sizeBytes) == false) {
+            ATTOERROR("AssetPack::GetPayload -> %s is corrupt", GetPath(entry));
+            storage.Clear();
+            return nullptr;
+        }
+
+        return storage.GetData();
+    }
+
+    const char* AssetPack::GetPath(const AssetPackEntry& entry) const {
+        return strings + entry.pathOffset;
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "AttoAssetTypes.h"
+#include "AttoCompression.h"
+#include "AttoMappedFile.h"
+
+#include <fstream>
+
+namespace atto
+{
+    static constexpr u32 ASSET_PACK_MAGIC = 0x4B505441; // "ATPK"
+    static constexpr u32 ASSET_PACK_VERSION = 2;
+    static constexpr u32 ASSET_PACK_PAYLOAD_ALIGNMENT = 64;
+    // Payloads are decoded into and read back through List<byte>, which is sized with an i32.
+    static constexpr u64 ASSET_PACK_MAX_PAYLOAD_BYTES = 0x7FFFFFFF;
+
+    // Layout, all little endian:
+    //  AssetPackHeader
+    //  Payloads, each one starting on a payloadAlignment boundary
+    //  AssetPackEntry * entryCount, sorted by id
+    //  Paths, null terminated
+    // The table of contents is written last so payloads can be streamed in without knowing the entry count up front.
+    // Payloads that shrink enough are stored in LZCompressChunks framing, sizeBytes is always the size once decoded.
+    // Byte identical payloads are stored once, their entries share an offset.
+    struct AssetPackHeader {
+        u32 magic;
+        u32 version;
+        u32 entryCount;
+        u32 payloadAlignment;
+        u64 tocOffset;
+        u64 stringsOffset;
+        u64 stringsSizeBytes;
+        u64 fileSizeBytes;
+    };
+
+    struct AssetPackEntry {
+        u32 id;
+        u32 type;
+        u64 offset;
+        u64 sizeBytes;
+        u32 pathOffset;
+        u32 pathLength;
+        u64 storedSizeBytes;
+        u32 compression;
+        u32 reserved;
+    };
+
+    static_assert(sizeof(AssetPackHeader) == 48, "AssetPackHeader is written as is, it must not change size");
+    static_assert(sizeof(AssetPackEntry) == 48, "AssetPackEntry is written as is, it must not change size");
+
+    // Payloads go straight to disk as they are added, only the table of contents and the payload hashes are kept
+    // until End. A payload whose hash and size match an earlier one is read back and compared before it is shared.
+    class AssetPackWriter {
+    public:
+        bool                        Begin(const char* packPath, LZLevel compression = LZ_LEVEL_FAST);
+        bool                        Add(AssetId id, AssetType type, const char* path, const void* data, u64 sizeBytes);
+        bool                        AddFile(const AssetManifestEntry& entry);
+        bool                        End();
+
+        // Packs every file in entries, read from entry.path.
+        static bool                 WriteFiles(const char* packPath, const List<AssetManifestEntry>& entries, LZLevel compression = LZ_LEVEL_FAST);
+
+        inline u64                  GetRawBytes() const { return rawBytes; }
+        inline u64                  GetStoredBytes() const { return storedBytes; }
+        inline i32                  GetDuplicateCount() const { return duplicateCount; }
+        // Stored bytes that duplicates would have taken up.
+        inline u64                  GetDuplicateBytes() const { return duplicateBytes; }
+
+    private:
+        struct Payload {
+            u64                     hash;
+            u64                     sizeBytes;
+            i32                     entryIndex;
+        };
+
+        i32                         FindDuplicate(u64 hash, const void* data, u64 sizeBytes);
+        bool                        WritePadding();
+
+        LargeString                 packPath;
+        LZLevel                     compression = LZ_LEVEL_FAST;
+        u64                         rawBytes = 0;
+        u64                         storedBytes = 0;
+        List<byte>                  compressed;
+        List<byte>                  readBack;
+        std::fstream                stream;
+        u64                         offset = 0;
+        List<AssetPackEntry>        entries;
+        List<Payload>               payloads;
+        i32                         duplicateCount = 0;
+        u64                         duplicateBytes = 0;
+        List<char>                  strings;
+    };
+
+    // Read only view of a pack file. Everything is checked once on Open, after that Find is a binary search
+    // over the table of contents and uncompressed payloads are pointers into the mapping, valid until Close.
+    class AssetPack {
+    public:
+        bool                        Open(const char* packPath);
+        void                        Close();
+
+        inline bool                 IsOpen() const { return header != nullptr; }
+        inline i32                  GetEntryCount() const { return header != nullptr ? (i32)header->entryCount : 0; }
+        inline const AssetPackEntry& GetEntry(i32 index) const { return entries[index]; }
+
+        const AssetPackEntry*       Find(AssetId id) const;
+        // Points into the mapping for stored entries, compressed ones are decoded into storage. nullptr when the
+        // payload is corrupt.
+        const byte*                 GetPayload(const AssetPackEntry& entry, List<byte>& storage) const;
+        // GetPayload for a copy of the stored bytes that was read some other way, like through AsyncIO.
+        const byte*                 DecodePayload(const AssetPackEntry& entry, const byte* stored, List<byte>& storage) const;
+        const char*                 GetPath(const AssetPackEntry& entry) const;
+        // The pack file itself, for reading entries through AsyncIO instead of the mapping.
+        inline const char*          GetPackPath() const { return packPath.GetCStr(); }
+
+    private:
+        LargeString                 packPath;
+        MappedFile                  file;
+        const AssetPackHeader*      header = nullptr;
+        const AssetPackEntry*       entries = nullptr;
+        const char*                 strings = nullptr;
+    };
+}
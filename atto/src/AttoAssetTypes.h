@@ -0,0 +1,104 @@
+#pragma once
+
+#include "AttoContainers.h"
+
+namespace atto
+{
+    enum AssetType {
+        ASSET_TYPE_INVALID = 0,
+        ASSET_TYPE_MESH,
+        ASSET_TYPE_TEXTURE,
+        ASSET_TYPE_AUDIO,
+        ASSET_TYPE_FONT,
+        ASSET_TYPE_SPRITE,
+        ASSET_TYPE_TILESHEET,
+        ASSET_TYPE_COUNT
+    };
+
+    struct AssetId {
+        inline static constexpr AssetId Create(const char* str) {
+            AssetId id = {};
+            id.id = StringHash::Hash(str);
+            return id; 
+        }
+
+        inline static constexpr AssetId Create(u32 idNumber) {
+            AssetId id = {};
+            id.id = idNumber;
+            return id;
+        }
+
+        inline b8 IsValid() const { return id != 0; }
+
+        inline b8 operator ==(const AssetId& other) const { return id == other.id; }
+        inline b8 operator !=(const AssetId& other) const { return id != other.id; }
+
+        u32 id;
+    };
+
+    template<u32 _type_>
+    class TypedAssetId {
+    public:
+        inline static constexpr TypedAssetId<_type_> Create(const char* str) {
+            TypedAssetId<_type_> id = {};
+            id.id = StringHash::Hash(str);
+            return id;
+        }
+
+        inline b8 IsValid() const { return id != 0; }
+        inline u32 GetValue() const { return id; }
+        inline constexpr AssetId ToRawId() const { return AssetId::Create(id); }
+
+        inline b8 operator ==(const AssetId& other) const { return id == other.id; }
+        inline b8 operator !=(const AssetId& other) const { return id != other.id; }
+
+        u32 id;
+    };
+    
+    typedef TypedAssetId<ASSET_TYPE_MESH>    MeshAssetId;
+    typedef TypedAssetId<ASSET_TYPE_TEXTURE> TextureAssetId;
+    typedef TypedAssetId<ASSET_TYPE_AUDIO>   AudioAssetId;
+    typedef TypedAssetId<ASSET_TYPE_FONT>    FontAssetId;
+
+    // Maps an AssetId to its index in the owning asset list.
+    typedef FixedHashMap<u32, i32, 4096>     AssetLookup;
+
+    // One loose asset file, as found by the directory scan or read back from the manifest.
+    struct AssetManifestEntry {
+        AssetId     id;
+        AssetType   type;
+        StringAtom  path;
+        u64         sizeBytes;
+        i64         writeTime;
+    };
+
+    // Every directory under the asset root is recorded so the manifest can be revalidated without walking the tree.
+    struct AssetManifestDirectory {
+        StringAtom  path;
+        i64         writeTime;
+    };
+
+    inline AssetType AssetTypeFromExtension(const char* extension) {
+        if (strcmp(extension, ".obj") == 0 || strcmp(extension, ".fbx") == 0) {
+            return ASSET_TYPE_MESH;
+        }
+        if (strcmp(extension, ".png") == 0 || strcmp(extension, ".jpg") == 0) {
+            return ASSET_TYPE_TEXTURE;
+        }
+        if (strcmp(extension, ".ogg") == 0 || strcmp(extension, ".wav") == 0) {
+            return ASSET_TYPE_AUDIO;
+        }
+        if (strcmp(extension, ".ttf") == 0) {
+            return ASSET_TYPE_FONT;
+        }
+
+        return ASSET_TYPE_INVALID;
+    }
+
+    // Ids are the path without its extension, so "assets/fonts/Roboto_Regular.ttf" is FontAssetId::Create("assets/fonts/Roboto_Regular").
+    inline AssetId AssetIdFromPath(const char* path) {
+        LargeString idPath = LargeString::FromLiteral(path);
+        idPath.StripFileExtension();
+        return AssetId::Create(idPath.GetCStr());
+    }
+}
@@ -0,0 +1,533 @@
+#include "AttoAsyncIO.h"
+#include "AttoLib.h"
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define ATTO_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#else
+#define ATTO_IO_URING 0
+#endif
+
+namespace atto
+{
+    // A single read call moves at most this much, bigger reads are split. io_uring lengths are 32 bit, ReadFile's too.
+    static constexpr u64 IO_MAX_READ_BYTES = 1ull << 30;
+    static constexpr i32 IO_DEFAULT_THREAD_COUNT = 4;
+
+    static i64 IOFileOpen(const char* path) {
+#if _WIN32
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+        return file == INVALID_HANDLE_VALUE ? -1 : (i64)(intptr_t)file;
+#else
+        return (i64)open(path, O_RDONLY | O_CLOEXEC);
+#endif
+    }
+
+    static void IOFileClose(i64 handle) {
+#if _WIN32
+        CloseHandle((HANDLE)(intptr_t)handle);
+#else
+        close((i32)handle);
+#endif
+    }
+
+    // Positional and blocking, several threads can read the same handle at once. Stops early at the end of the file.
+    static bool IOFileRead(i64 handle, u64 offset, byte* destination, u64 sizeBytes, u64& bytesRead) {
+        while (bytesRead < sizeBytes) {
+            const u64 remaining = sizeBytes - bytesRead;
+            const u64 readBytes = remaining < IO_MAX_READ_BYTES ? remaining : IO_MAX_READ_BYTES;
+#if _WIN32
+            const u64 readOffset = offset + bytesRead;
+            OVERLAPPED overlapped = {};
+            overlapped.Offset = (DWORD)readOffset;
+            overlapped.OffsetHigh = (DWORD)(readOffset >> 32);
+            DWORD readCount = 0;
+            if (ReadFile((HANDLE)(intptr_t)handle, destination + bytesRead, (DWORD)readBytes, &readCount, &overlapped) == FALSE) {
+                return GetLastError() == ERROR_HANDLE_EOF;
+            }
+            const i64 result = (i64)readCount;
+#else
+            const i64 result = (i64)pread((i32)handle, destination + bytesRead, (size_t)readBytes, (off_t)(offset + bytesRead));
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result < 0) {
+                return false;
+            }
+#endif
+            if (result == 0) {
+                break;
+            }
+
+            bytesRead += (u64)result;
+        }
+
+        return true;
+    }
+
+    IORead IOReadPackEntry(const AssetPack& pack, const AssetPackEntry& entry, void* destination, IOCompleteFunc onComplete, void* userData) {
+        IORead read = {};
+        read.path = pack.GetPackPath();
+        read.offset = entry.offset;
+        read.sizeBytes = entry.storedSizeBytes;
+        read.destination = destination;
+        read.onComplete = onComplete;
+        read.userData = userData;
+
+        return read;
+    }
+
+    const char* IOBackendToString(IOBackend backend) {
+        switch (backend) {
+            case IO_BACKEND_NONE: return "none";
+            case IO_BACKEND_IO_URING: return "io_uring";
+            case IO_BACKEND_THREADS: return "threads";
+        }
+
+        return "unknown";
+    }
+
+    AsyncIO::~AsyncIO() {
+        Shutdown();
+    }
+
+    bool AsyncIO::Initialize(bool allowIOUring, i32 threadCount) {
+        Assert(backend == IO_BACKEND_NONE, "AsyncIO already initialized");
+
+        for (i32 slotIndex = 0; slotIndex < IO_MAX_IN_FLIGHT; slotIndex++) {
+            freeSlots[slotIndex] = IO_MAX_IN_FLIGHT - 1 - slotIndex;
+        }
+        freeSlotCount = IO_MAX_IN_FLIGHT;
+
+        if (allowIOUring && RingInitialize()) {
+            backend = IO_BACKEND_IO_URING;
+        }
+        else {
+            if (threadCount <= 0) {
+                threadCount = IO_DEFAULT_THREAD_COUNT;
+            }
+
+            threadsShuttingDown = false;
+            threads.reserve(threadCount);
+            for (i32 threadIndex = 0; threadIndex < threadCount; threadIndex++) {
+                threads.emplace_back(&AsyncIO::ThreadMain, this);
+            }
+            backend = IO_BACKEND_THREADS;
+        }
+
+        ATTOINFO("AsyncIO started on %s", IOBackendToString(backend));
+
+        return true;
+    }
+
+    void AsyncIO::Shutdown() {
+        if (backend == IO_BACKEND_NONE) {
+            return;
+        }
+
+        // The kernel or the threads are still writing into the destinations.
+        WaitAll();
+
+        if (backend == IO_BACKEND_IO_URING) {
+            RingShutdown();
+        }
+        else {
+            {
+                std::lock_guard<std::mutex> lock(requestMutex);
+                threadsShuttingDown = true;
+            }
+            requestAvailable.notify_all();
+
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+            threads.clear();
+        }
+
+        const i32 openFileCount = openFiles.GetNum();
+        for (i32 fileIndex = 0; fileIndex < openFileCount; fileIndex++) {
+            IOFileClose(openFiles[fileIndex].handle);
+        }
+        openFiles.Clear();
+        pending.Clear();
+        pendingHead = 0;
+        backend = IO_BACKEND_NONE;
+    }
+
+    void AsyncIO::Submit(const IORead* reads, i32 count) {
+        Assert(backend != IO_BACKEND_NONE, "AsyncIO::Submit before Initialize");
+
+        for (i32 readIndex = 0; readIndex < count; readIndex++) {
+            PendingRead pendingRead = {};
+            pendingRead.read = reads[readIndex];
+            pendingRead.handle = OpenCached(reads[readIndex].path);
+            // The caller's path doesn't have to outlive Submit.
+            pendingRead.read.path = nullptr;
+            pending.Add(pendingRead);
+        }
+
+        Dispatch();
+    }
+
+    i32 AsyncIO::Poll() {
+        i32 completed = Dispatch();
+        completed += Reap(false);
+        // Slots the completions gave back go straight out again.
+        completed += Dispatch();
+
+        return completed;
+    }
+
+    void AsyncIO::WaitAll() {
+        while (freeSlotCount < IO_MAX_IN_FLIGHT || pendingHead < pending.GetNum()) {
+            Dispatch();
+            Reap(true);
+        }
+    }
+
+    AsyncIOStats AsyncIO::GetStats() const {
+        AsyncIOStats stats = {};
+        stats.inFlight = IO_MAX_IN_FLIGHT - freeSlotCount;
+        stats.queued = pending.GetNum() - pendingHead;
+        stats.completedCount = completedCount;
+        stats.bytesRead = bytesRead;
+
+        return stats;
+    }
+
+    i64 AsyncIO::OpenCached(const char* path) {
+        const i32 openFileCount = openFiles.GetNum();
+        for (i32 fileIndex = 0; fileIndex < openFileCount; fileIndex++) {
+            if (openFiles[fileIndex].path == path) {
+                return openFiles[fileIndex].handle;
+            }
+        }
+
+        const i64 handle = IOFileOpen(path);
+        if (handle < 0) {
+            ATTOERROR("AsyncIO -> Could not open file %s", path);
+            return -1;
+        }
+
+        OpenFile openFile = {};
+        openFile.path = LargeString::FromLiteral(path);
+        openFile.handle = handle;
+        openFiles.Add(openFile);
+
+        return handle;
+    }
+
+    i32 AsyncIO::Dispatch() {
+        i32 completed = 0;
+        while (pendingHead < pending.GetNum() && freeSlotCount > 0) {
+            // Copied out, onComplete may Submit more and move pending.
+            const PendingRead pendingRead = pending[pendingHead++];
+
+            const i32 slotIndex = freeSlots[--freeSlotCount];
+            Slot& slot = slots[slotIndex];
+            slot.read = pendingRead.read;
+            slot.handle = pendingRead.handle;
+            slot.bytesRead = 0;
+
+            if (slot.handle < 0 || slot.read.sizeBytes == 0) {
+                Complete(slotIndex, slot.handle >= 0);
+                completed++;
+                continue;
+            }
+
+            if (backend == IO_BACKEND_IO_URING) {
+                RingSend(slotIndex);
+            }
+            else {
+                {
+                    std::lock_guard<std::mutex> lock(requestMutex);
+                    requests[(requestHead + requestCount) % IO_MAX_IN_FLIGHT] = slotIndex;
+                    requestCount++;
+                }
+                requestAvailable.notify_one();
+            }
+        }
+
+        if (pendingHead == pending.GetNum()) {
+            pending.Clear();
+            pendingHead = 0;
+        }
+
+        if (ringUnsubmitted > 0) {
+            RingEnter(false);
+        }
+
+        return completed;
+    }
+
+    void AsyncIO::Complete(i32 slotIndex, bool succeeded) {
+        const Slot& slot = slots[slotIndex];
+
+        IOCompletion completion = {};
+        completion.destination = slot.read.destination;
+        completion.userData = slot.read.userData;
+        completion.sizeBytes = slot.read.sizeBytes;
+        completion.bytesRead = slot.bytesRead;
+        completion.succeeded = succeeded;
+        const IOCompleteFunc onComplete = slot.read.onComplete;
+
+        freeSlots[freeSlotCount++] = slotIndex;
+        completedCount++;
+        bytesRead += completion.bytesRead;
+
+        if (onComplete != nullptr) {
+            onComplete(completion, completion.userData);
+        }
+    }
+
+    i32 AsyncIO::Reap(bool wait) {
+        if (backend == IO_BACKEND_IO_URING) {
+            i32 completed = RingReap();
+            if (completed == 0 && wait) {
+                RingEnter(true);
+                completed = RingReap();
+            }
+
+            return completed;
+        }
+
+        i32 completed = 0;
+        SlotCompletion slotCompletion = {};
+        while (completions.Pop(slotCompletion)) {
+            Complete(slotCompletion.slotIndex, slotCompletion.succeeded);
+            completed++;
+        }
+
+        if (completed == 0 && wait) {
+            // Everything left is on the I/O threads.
+            std::this_thread::yield();
+        }
+
+        return completed;
+    }
+
+    void AsyncIO::ThreadMain() {
+        for (;;) {
+            i32 slotIndex = 0;
+            {
+                std::unique_lock<std::mutex> lock(requestMutex);
+                requestAvailable.wait(lock, [this] { return requestCount > 0 || threadsShuttingDown; });
+                if (requestCount == 0) {
+                    return;
+                }
+                slotIndex = requests[requestHead];
+                requestHead = (requestHead + 1) % IO_MAX_IN_FLIGHT;
+                requestCount--;
+            }
+
+            Slot& slot = slots[slotIndex];
+            SlotCompletion slotCompletion = {};
+            slotCompletion.slotIndex = slotIndex;
+            slotCompletion.succeeded = IOFileRead(slot.handle, slot.read.offset, (byte*)slot.read.destination, slot.read.sizeBytes, slot.bytesRead);
+
+            // There are never more completions than slots, so there is always room.
+            const bool pushed = completions.Push(slotCompletion);
+            Assert(pushed, "AsyncIO, completion queue is full");
+        }
+    }
+
+#if ATTO_IO_URING
+    // Straight syscalls rather than liburing, the engine only needs reads and the rings are a few pointers.
+
+    bool AsyncIO::RingInitialize() {
+        io_uring_params params = {};
+        const i32 fd = (i32)syscall(__NR_io_uring_setup, (u32)IO_MAX_IN_FLIGHT, &params);
+        if (fd < 0) {
+            ATTOINFO("AsyncIO -> io_uring is not available, %s", strerror(errno));
+            return false;
+        }
+
+        // IORING_OP_READ came with the same kernel as this flag, on older ones every read would fail.
+        ringFd = fd;
+        if ((params.features & IORING_FEAT_RW_CUR_POS) == 0 || params.sq_entries < (u32)IO_MAX_IN_FLIGHT) {
+            ATTOINFO("AsyncIO -> io_uring is too old");
+            RingShutdown();
+            return false;
+        }
+
+        ringSqSize = params.sq_off.array + params.sq_entries * sizeof(u32);
+        ringCqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) {
+            ringSqSize = ringSqSize > ringCqSize ? ringSqSize : ringCqSize;
+        }
+
+        ringSq = mmap(nullptr, ringSqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (ringSq == MAP_FAILED) {
+            ringSq = nullptr;
+            RingShutdown();
+            return false;
+        }
+
+        if (singleMap) {
+            ringCq = ringSq;
+            ringCqSize = 0;
+        }
+        else {
+            ringCq = mmap(nullptr, ringCqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (ringCq == MAP_FAILED) {
+                ringCq = nullptr;
+                RingShutdown();
+                return false;
+            }
+        }
+
+        ringSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        ringSqes = mmap(nullptr, ringSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (ringSqes == MAP_FAILED) {
+            ringSqes = nullptr;
+            RingShutdown();
+            return false;
+        }
+
+        byte* sq = (byte*)ringSq;
+        sqHead = (u32*)(sq + params.sq_off.head);
+        sqTail = (u32*)(sq + params.sq_off.tail);
+        sqMask = *(const u32*)(sq + params.sq_off.ring_mask);
+        sqArray = (u32*)(sq + params.sq_off.array);
+
+        byte* cq = (byte*)ringCq;
+        cqHead = (u32*)(cq + params.cq_off.head);
+        cqTail = (u32*)(cq + params.cq_off.tail);
+        cqMask = *(const u32*)(cq + params.cq_off.ring_mask);
+        cqes = cq + params.cq_off.cqes;
+
+        return true;
+    }
+
+    void AsyncIO::RingShutdown() {
+        if (ringSqes != nullptr) {
+            munmap(ringSqes, ringSqesSize);
+        }
+        if (ringCq != nullptr && ringCqSize != 0) {
+            munmap(ringCq, ringCqSize);
+        }
+        if (ringSq != nullptr) {
+            munmap(ringSq, ringSqSize);
+        }
+        if (ringFd >= 0) {
+            close(ringFd);
+        }
+
+        ringFd = -1;
+        ringSq = nullptr;
+        ringCq = nullptr;
+        ringSqes = nullptr;
+        ringUnsubmitted = 0;
+    }
+
+    void AsyncIO::RingSend(i32 slotIndex) {
+        const Slot& slot = slots[slotIndex];
+
+        // Only this thread moves the tail. Every slot has at most one read queued and the ring has a place for
+        // each slot, so it can't be full.
+        const u32 tail = *sqTail;
+        Assert(tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) <= sqMask, "AsyncIO, submission ring is full");
+
+        const u64 remaining = slot.read.sizeBytes - slot.bytesRead;
+        const u32 index = tail & sqMask;
+        io_uring_sqe& sqe = ((io_uring_sqe*)ringSqes)[index];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = (i32)slot.handle;
+        sqe.addr = (u64)(uintptr_t)((byte*)slot.read.destination + slot.bytesRead);
+        sqe.len = (u32)(remaining < IO_MAX_READ_BYTES ? remaining : IO_MAX_READ_BYTES);
+        sqe.off = slot.read.offset + slot.bytesRead;
+        sqe.user_data = (u64)slotIndex;
+        sqArray[index] = index;
+
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        ringUnsubmitted++;
+    }
+
+    void AsyncIO::RingEnter(bool wait) {
+        const u32 flags = wait ? IORING_ENTER_GETEVENTS : 0;
+        for (;;) {
+            const i64 result = syscall(__NR_io_uring_enter, ringFd, (u32)ringUnsubmitted, wait ? 1u : 0u, flags, nullptr, 0);
+            if (result >= 0) {
+                ringUnsubmitted -= (i32)result;
+                return;
+            }
+
+            // Out of kernel resources, the reads stay in the ring and go with the next Poll.
+            if (errno != EINTR) {
+                if (errno != EAGAIN && errno != EBUSY) {
+                    ATTOERROR("AsyncIO -> io_uring_enter failed, %s", strerror(errno));
+                }
+                return;
+            }
+        }
+    }
+
+    i32 AsyncIO::RingReap() {
+        i32 completed = 0;
+        u32 head = *cqHead;
+        const u32 tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            const io_uring_cqe& cqe = ((const io_uring_cqe*)cqes)[head & cqMask];
+            const i32 slotIndex = (i32)cqe.user_data;
+            const i32 result = cqe.res;
+            head++;
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+
+            Slot& slot = slots[slotIndex];
+            if (result == -EAGAIN || result == -EINTR) {
+                RingSend(slotIndex);
+                continue;
+            }
+
+            if (result > 0) {
+                slot.bytesRead += (u64)result;
+                // Short reads happen, the rest goes out again. 0 is the end of the file.
+                if (slot.bytesRead < slot.read.sizeBytes) {
+                    RingSend(slotIndex);
+                    continue;
+                }
+            }
+
+            Complete(slotIndex, result >= 0);
+            completed++;
+        }
+
+        if (ringUnsubmitted > 0) {
+            RingEnter(false);
+        }
+
+        return completed;
+    }
+#else
+    bool AsyncIO::RingInitialize() {
+        return false;
+    }
+
+    void AsyncIO::RingShutdown() {
+    }
+
+    void AsyncIO::RingSend(i32 slotIndex) {
+    }
+
+    void AsyncIO::RingEnter(bool wait) {
+    }
+
+    i32 AsyncIO::RingReap() {
+        return 0;
+    }
+#endif
+}
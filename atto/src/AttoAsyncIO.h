@@ -0,0 +1,159 @@
+#pragma once
+
+#include "AttoAssetPack.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace atto
+{
+    struct IOCompletion;
+    typedef void (*IOCompleteFunc)(const IOCompletion& completion, void* userData);
+
+    // sizeBytes at offset of path, read into destination. destination must stay valid until onComplete is called.
+    struct IORead {
+        const char*         path;
+        u64                 offset;
+        u64                 sizeBytes;
+        void*               destination;
+        IOCompleteFunc      onComplete;
+        void*               userData;
+    };
+
+    struct IOCompletion {
+        void*               destination;
+        void*               userData;
+        u64                 sizeBytes;
+        // Less than sizeBytes when the file ends first.
+        u64                 bytesRead;
+        bool                succeeded;
+    };
+
+    // The entry as it is stored, compressed entries still have to go through LZDecompressChunks into entry.sizeBytes.
+    IORead                  IOReadPackEntry(const AssetPack& pack, const AssetPackEntry& entry, void* destination,
+                                            IOCompleteFunc onComplete, void* userData);
+
+    static constexpr i32    IO_MAX_IN_FLIGHT = 64;
+
+    enum IOBackend : u32 {
+        IO_BACKEND_NONE = 0,
+        IO_BACKEND_IO_URING,
+        IO_BACKEND_THREADS,
+    };
+
+    const char*             IOBackendToString(IOBackend backend);
+
+    struct AsyncIOStats {
+        i32                 inFlight;
+        i32                 queued;
+        u64                 completedCount;
+        u64                 bytesRead;
+    };
+
+    // Streams reads in the background, up to IO_MAX_IN_FLIGHT at a time. On Linux the reads go to io_uring, the
+    // kernel fills the destinations and posts completions to a ring the caller polls, there are no extra threads.
+    // Everywhere else, or when the kernel refuses io_uring, a few I/O threads do blocking positional reads and
+    // post completions to a FixedAtomicQueue. Either way nothing is copied and Poll never blocks.
+    //
+    // Submit, Poll and WaitAll belong to one thread, normally the main thread once per frame. onComplete runs on
+    // that thread from inside Poll. Reads past IO_MAX_IN_FLIGHT queue up and go out as earlier ones complete.
+    // Files are opened once on Submit and kept open until Shutdown, levels stream out of the same few files.
+    class AsyncIO {
+    public:
+        AsyncIO() = default;
+        ~AsyncIO();
+        DISABLE_COPY_AND_MOVE(AsyncIO);
+
+        // threadCount is for the thread backend, <= 0 picks a default.
+        bool                        Initialize(bool allowIOUring = true, i32 threadCount = 0);
+        void                        Shutdown();
+
+        void                        Submit(const IORead* reads, i32 count);
+        // Sends queued reads and calls onComplete for every read that finished. Returns how many finished.
+        i32                         Poll();
+        // Polls until everything submitted has completed.
+        void                        WaitAll();
+
+        inline IOBackend            GetBackend() const { return backend; }
+        AsyncIOStats                GetStats() const;
+
+    private:
+        struct OpenFile {
+            LargeString             path;
+            i64                     handle;
+        };
+
+        struct PendingRead {
+            IORead                  read;
+            i64                     handle;
+        };
+
+        // A read in flight. Owned by the polling thread until it is sent and again once its completion is popped,
+        // an I/O thread or the kernel only touches it in between.
+        struct Slot {
+            IORead                  read;
+            i64                     handle;
+            u64                     bytesRead;
+        };
+
+        struct SlotCompletion {
+            i32                     slotIndex;
+            bool                    succeeded;
+        };
+
+        i64                         OpenCached(const char* path);
+        // Hands queued reads to free slots, returns how many completed straight away (unopenable files, empty reads).
+        i32                         Dispatch();
+        void                        Complete(i32 slotIndex, bool succeeded);
+        i32                         Reap(bool wait);
+
+        bool                        RingInitialize();
+        void                        RingShutdown();
+        void                        RingSend(i32 slotIndex);
+        void                        RingEnter(bool wait);
+        i32                         RingReap();
+
+        void                        ThreadMain();
+
+        IOBackend                   backend = IO_BACKEND_NONE;
+
+        List<OpenFile>              openFiles;
+        List<PendingRead>           pending;
+        i32                         pendingHead = 0;
+        Slot                        slots[IO_MAX_IN_FLIGHT] = {};
+        i32                         freeSlots[IO_MAX_IN_FLIGHT] = {};
+        i32                         freeSlotCount = 0;
+        u64                         completedCount = 0;
+        u64                         bytesRead = 0;
+
+        // io_uring, the rings are shared with the kernel.
+        i32                         ringFd = -1;
+        void*                       ringSq = nullptr;
+        u64                         ringSqSize = 0;
+        void*                       ringCq = nullptr;
+        u64                         ringCqSize = 0;
+        void*                       ringSqes = nullptr;
+        u64                         ringSqesSize = 0;
+        u32*                        sqHead = nullptr;
+        u32*                        sqTail = nullptr;
+        u32                         sqMask = 0;
+        u32*                        sqArray = nullptr;
+        u32*                        cqHead = nullptr;
+        u32*                        cqTail = nullptr;
+        u32                         cqMask = 0;
+        void*                       cqes = nullptr;
+        i32                         ringUnsubmitted = 0;
+
+        // Thread backend.
+        std::mutex                  requestMutex;
+        std::condition_variable     requestAvailable;
+        i32                         requests[IO_MAX_IN_FLIGHT] = {};
+        i32                         requestHead = 0;
+        i32                         requestCount = 0;
+        bool                        threadsShuttingDown = false;
+        std::vector<std::thread>    threads;
+        FixedAtomicQueue<SlotCompletion, IO_MAX_IN_FLIGHT> completions;
+    };
+}
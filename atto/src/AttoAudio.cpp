@@ -1,9 +1,57 @@
 
 #include "AttoAsset.h"
 
+#define STB_VORBIS_HEADER_ONLY
+#include "stb_vorbis/stb_vorbis.c"
 
 namespace atto
 {
+    // Walks the RIFF chunks for fmt and data. samples points into data, nothing is copied.
+    static bool WavParse(const byte* data, u64 size, i32& channels, i32& sampleRate, i32& bitDepth, const byte*& samples, u64& samplesSize) {
+        if (size < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0) {
+            return false;
+        }
+
+        bool hasFormat = false;
+        samples = nullptr;
+        u64 offset = 12;
+        while (offset + 8 <= size) {
+            u32 chunkSize = 0;
+            memcpy(&chunkSize, data + offset + 4, sizeof(u32));
+            const byte* chunk = data + offset + 8;
+            const u64 available = size - offset - 8;
+            if (memcmp(data + offset, "fmt ", 4) == 0 && chunkSize >= 16 && chunkSize <= available) {
+                u16 formatTag = 0;
+                u16 channelCount = 0;
+                u32 rate = 0;
+                u16 bits = 0;
+                memcpy(&formatTag, chunk + 0, sizeof(u16));
+                memcpy(&channelCount, chunk + 2, sizeof(u16));
+                memcpy(&rate, chunk + 4, sizeof(u32));
+                memcpy(&bits, chunk + 14, sizeof(u16));
+                // 1 is integer PCM, 3 float and 0xFFFE extensible, which XAudio2 reads from the same fields.
+                if (formatTag != 1 && formatTag != 3 && formatTag != 0xFFFE) {
+                    return false;
+                }
+
+                channels = (i32)channelCount;
+                sampleRate = (i32)rate;
+                bitDepth = (i32)bits;
+                hasFormat = true;
+            }
+            else if (memcmp(data + offset, "data", 4) == 0) {
+                // Some writers leave the size at 0 or too large when streaming, the data runs to the end of the file.
+                samples = chunk;
+                samplesSize = chunkSize != 0 && chunkSize <= available ? chunkSize : available;
+            }
+
+            // Chunks are padded to an even size.
+            offset += 8 + (u64)chunkSize + (chunkSize & 1);
+        }
+
+        return hasFormat && samples != nullptr && channels > 0 && sampleRate > 0 && bitDepth > 0;
+    }
+
     bool LeEngine::InitializeAudio() {
         HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
         if (FAILED(hr)) {
@@ -30,7 +78,59 @@ namespace atto
     }
 
     void LeEngine::AudioCreate(AudioAsset& audio) {
+        // Audio isn't cooked, pack entries hold the source file as is. Wav samples are used straight from the pack
+        // mapping or the loose file's view, only ogg is decoded into audio.payload.
+        const AssetPackEntry* packed = assetPack.Find(audio.id);
+        const byte* source = packed != nullptr ? assetPack.GetPayload(*packed, audio.payload) : nullptr;
+        u64 sourceSize = packed != nullptr ? packed->sizeBytes : 0;
+        if (source == nullptr) {
+            files.Close(audio.file);
+            audio.file = files.Open(audio.path.GetCStr());
+            source = files.GetData(audio.file);
+            sourceSize = files.GetSize(audio.file);
+        }
+
+        if (source == nullptr) {
+            return;
+        }
+
+        u64 samplesSize = 0;
+        if (WavParse(source, sourceSize, audio.channels, audio.sampleRate, audio.bitDepth, audio.samples, samplesSize)) {
+            audio.sizeBytes = (i32)samplesSize;
+            return;
+        }
+
+        i32 channels = 0;
+        i32 sampleRate = 0;
+        short* decoded = nullptr;
+        const i32 frameCount = stb_vorbis_decode_memory(source, (i32)sourceSize, &channels, &sampleRate, &decoded);
+        files.Close(audio.file);
+        if (frameCount <= 0) {
+            ATTOERROR("Could not load audio %s", audio.path.GetCStr());
+            audio.payload.Clear();
+            return;
+        }
+
+        const i32 decodedBytes = frameCount * channels * (i32)sizeof(short);
+        audio.payload.SetNum(decodedBytes);
+        memcpy(audio.payload.GetData(), decoded, (size_t)decodedBytes);
+        free(decoded);
+
+        audio.channels = channels;
+        audio.sampleRate = sampleRate;
+        audio.bitDepth = 16;
+        audio.samples = audio.payload.GetData();
+        audio.sizeBytes = decodedBytes;
+    }
 
+    void LeEngine::AudioDestroy(AudioAsset& audio) {
+        assetMemory.audioBytes -= (u64)audio.sizeBytes;
+        files.Close(audio.file);
+        audio.file = {};
+        audio.payload.Clear();
+        audio.samples = nullptr;
+        audio.bufferHandle = 0;
+        audio.sizeBytes = 0;
     }
 
     //Speaker LeEngine::AudioPlay(AudioAssetId audioAssetId, bool looping, f32 volume /*= 1.0f*/) {
@@ -0,0 +1,520 @@
+#include "AttoCompression.h"
+#include "AttoJobs.h"
+#include "AttoMemory.h"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace atto
+{
+    static constexpr u64 LZ_MIN_MATCH = 4;
+    static constexpr u64 LZ_LAST_LITERALS = 5;
+    static constexpr u64 LZ_MATCH_START_LIMIT = 12;
+    static constexpr u64 LZ_MAX_OFFSET = 65535;
+    static constexpr i32 LZ_HASH_BITS = 16;
+    static constexpr i32 LZ_HIGH_WINDOW_MASK = 65535;
+    static constexpr i32 LZ_HIGH_SEARCH_DEPTH = 64;
+    static constexpr u32 LZ_HIGH_NO_POSITION = 0xFFFFFFFF;
+    static constexpr u32 LZ_CHUNK_STORED_RAW = 0x80000000;
+
+    const char* LZLevelToString(LZLevel level) {
+        switch (level)
+        {
+        case LZ_LEVEL_NONE: return "none";
+        case LZ_LEVEL_FAST: return "fast";
+        case LZ_LEVEL_HIGH: return "high";
+        default: return "unknown";
+        }
+    }
+
+    static u32 LZRead32(const byte* ptr) {
+        u32 value;
+        memcpy(&value, ptr, sizeof(value));
+        return value;
+    }
+
+    static u32 LZHash(u32 sequence) {
+        return (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+    }
+
+    static u32 LZCountTrailingZeros(u64 value) {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanForward64(&index, value);
+        return (u32)index;
+#else
+        return (u32)__builtin_ctzll(value);
+#endif
+    }
+
+    // How many bytes from a and b match, a never reads past limit.
+    static u64 LZMatchLength(const byte* a, const byte* b, const byte* limit) {
+        const byte* start = a;
+        while (a + 8 <= limit) {
+            u64 valueA;
+            u64 valueB;
+            memcpy(&valueA, a, 8);
+            memcpy(&valueB, b, 8);
+            const u64 difference = valueA ^ valueB;
+            if (difference != 0) {
+                return (u64)(a - start) + LZCountTrailingZeros(difference) / 8;
+            }
+            a += 8;
+            b += 8;
+        }
+
+        while (a < limit && *a == *b) {
+            a++;
+            b++;
+        }
+
+        return (u64)(a - start);
+    }
+
+    static byte* LZWriteLength(byte* op, u64 length) {
+        while (length >= 255) {
+            *op++ = 255;
+            length -= 255;
+        }
+        *op++ = (byte)length;
+        return op;
+    }
+
+    // Literals from anchor, then the match. matchLength 0 writes the final literals only sequence.
+    static byte* LZWriteSequence(byte* op, const byte* anchor, u64 literalCount, u64 offset, u64 matchLength) {
+        byte* token = op++;
+        byte tokenValue = (byte)((literalCount >= 15 ? 15 : literalCount) << 4);
+        if (literalCount >= 15) {
+            op = LZWriteLength(op, literalCount - 15);
+        }
+
+        memcpy(op, anchor, literalCount);
+        op += literalCount;
+
+        if (matchLength > 0) {
+            op[0] = (byte)(offset & 0xFF);
+            op[1] = (byte)(offset >> 8);
+            op += 2;
+
+            const u64 lengthCode = matchLength - LZ_MIN_MATCH;
+            tokenValue |= (byte)(lengthCode >= 15 ? 15 : lengthCode);
+            if (lengthCode >= 15) {
+                op = LZWriteLength(op, lengthCode - 15);
+            }
+        }
+
+        *token = tokenValue;
+        return op;
+    }
+
+    static u64 LZCompressFast(const byte* src, u64 sizeBytes, byte* dst) {
+        ScratchScope scratch;
+        u32* table = Memory::AllocateScratchStruct<u32>(1 << LZ_HASH_BITS);
+        memset(table, 0, sizeof(u32) << LZ_HASH_BITS);
+
+        const byte* ip = src;
+        const byte* anchor = src;
+        const byte* end = src + sizeBytes;
+        byte* op = dst;
+        if (sizeBytes > LZ_MATCH_START_LIMIT) {
+            const byte* matchLimit = end - LZ_LAST_LITERALS;
+            const byte* startLimit = end - LZ_MATCH_START_LIMIT;
+            u32 misses = 0;
+            while (ip < startLimit) {
+                const u32 sequence = LZRead32(ip);
+                const u32 hash = LZHash(sequence);
+                const byte* candidate = src + table[hash];
+                table[hash] = (u32)(ip - src);
+
+                if (candidate >= ip || (u64)(ip - candidate) > LZ_MAX_OFFSET || LZRead32(candidate) != sequence) {
+                    // Step further the longer nothing matches, incompressible data goes through quickly.
+                    misses++;
+                    ip += 1 + (misses >> 6);
+                    continue;
+                }
+
+                while (ip > anchor && candidate > src && ip[-1] == candidate[-1]) {
+                    ip--;
+                    candidate--;
+                }
+
+                const u64 matchLength = LZ_MIN_MATCH + LZMatchLength(ip + LZ_MIN_MATCH, candidate + LZ_MIN_MATCH, matchLimit);
+                op = LZWriteSequence(op, anchor, (u64)(ip - anchor), (u64)(ip - candidate), matchLength);
+                ip += matchLength;
+                anchor = ip;
+                misses = 0;
+
+                // The end of a match is a likely start for the next one.
+                if (ip < startLimit) {
+                    table[LZHash(LZRead32(ip - 2))] = (u32)(ip - 2 - src);
+                }
+            }
+        }
+
+        op = LZWriteSequence(op, anchor, (u64)(end - anchor), 0, 0);
+        return (u64)(op - dst);
+    }
+
+    struct LZHashChain {
+        u32*    head;
+        u32*    previous;
+    };
+
+    static void LZHashChainInsert(LZHashChain& chain, const byte* src, u32 position) {
+        const u32 hash = LZHash(LZRead32(src + position));
+        chain.previous[position & LZ_HIGH_WINDOW_MASK] = chain.head[hash];
+        chain.head[hash] = position;
+    }
+
+    static u64 LZHashChainFind(const LZHashChain& chain, const byte* src, const byte* ip, const byte* matchLimit, u64& offset) {
+        const u32 position = (u32)(ip - src);
+        const u32 sequence = LZRead32(ip);
+        u64 bestLength = 0;
+        u32 candidate = chain.head[LZHash(sequence)];
+        for (i32 depth = 0; depth < LZ_HIGH_SEARCH_DEPTH && candidate != LZ_HIGH_NO_POSITION && candidate < position; depth++) {
+            if (position - candidate > LZ_MAX_OFFSET) {
+                break;
+            }
+
+            const byte* match = src + candidate;
+            // Checking the byte that would make the match longer first skips most candidates cheaply.
+            if (match[bestLength] == ip[bestLength] && LZRead32(match) == sequence) {
+                const u64 length = LZ_MIN_MATCH + LZMatchLength(ip + LZ_MIN_MATCH, match + LZ_MIN_MATCH, matchLimit);
+                if (length > bestLength) {
+                    bestLength = length;
+                    offset = position - candidate;
+                }
+            }
+
+            // Slots are reused every 64KB, a newer position means the chain has run out.
+            const u32 next = chain.previous[candidate & LZ_HIGH_WINDOW_MASK];
+            if (next >= candidate) {
+                break;
+            }
+            candidate = next;
+        }
+
+        return bestLength >= LZ_MIN_MATCH ? bestLength : 0;
+    }
+
+    static u64 LZCompressHigh(const byte* src, u64 sizeBytes, byte* dst) {
+        ScratchScope scratch;
+        LZHashChain chain = {};
+        chain.head = Memory::AllocateScratchStruct<u32>(1 << LZ_HASH_BITS);
+        chain.previous = Memory::AllocateScratchStruct<u32>(LZ_HIGH_WINDOW_MASK + 1);
+        memset(chain.head, 0xFF, sizeof(u32) << LZ_HASH_BITS);
+        memset(chain.previous, 0xFF, sizeof(u32) * (LZ_HIGH_WINDOW_MASK + 1));
+
+        const byte* ip = src;
+        const byte* anchor = src;
+        const byte* end = src + sizeBytes;
+        byte* op = dst;
+        if (sizeBytes > LZ_MATCH_START_LIMIT) {
+            const byte* matchLimit = end - LZ_LAST_LITERALS;
+            const byte* startLimit = end - LZ_MATCH_START_LIMIT;
+            u32 nextInsert = 0;
+            while (ip < startLimit) {
+                const u32 position = (u32)(ip - src);
+                for (; nextInsert < position; nextInsert++) {
+                    LZHashChainInsert(chain, src, nextInsert);
+                }
+
+                u64 offset = 0;
+                u64 matchLength = LZHashChainFind(chain, src, ip, matchLimit, offset);
+                if (matchLength == 0) {
+                    ip++;
+                    continue;
+                }
+
+                // Lazy matching, emit a literal instead when the next position has a longer match.
+                while (ip + 1 < startLimit) {
+                    LZHashChainInsert(chain, src, (u32)(ip - src));
+                    nextInsert = (u32)(ip - src) + 1;
+
+                    u64 nextOffset = 0;
+                    const u64 nextLength = LZHashChainFind(chain, src, ip + 1, matchLimit, nextOffset);
+                    if (nextLength <= matchLength) {
+                        break;
+                    }
+
+                    ip++;
+                    matchLength = nextLength;
+                    offset = nextOffset;
+                }
+
+                op = LZWriteSequence(op, anchor, (u64)(ip - anchor), offset, matchLength);
+                ip += matchLength;
+                anchor = ip;
+            }
+        }
+
+        op = LZWriteSequence(op, anchor, (u64)(end - anchor), 0, 0);
+        return (u64)(op - dst);
+    }
+
+    u64 LZCompressBound(u64 sizeBytes) {
+        return sizeBytes + sizeBytes / 255 + 16;
+    }
+
+    u64 LZCompress(const byte* src, u64 sizeBytes, byte* dst, LZLevel level) {
+        switch (level)
+        {
+        case LZ_LEVEL_FAST: return LZCompressFast(src, sizeBytes, dst);
+        case LZ_LEVEL_HIGH: return LZCompressHigh(src, sizeBytes, dst);
+        default:
+        {
+            memcpy(dst, src, sizeBytes);
+            return sizeBytes;
+        }
+        }
+    }
+
+    static bool LZReadLength(const byte*& ip, const byte* end, u64 limit, u64& length) {
+        for (;;) {
+            if (ip >= end) {
+                return false;
+            }
+
+            const byte value = *ip++;
+            length += value;
+            if (length > limit) {
+                return false;
+            }
+
+            if (value != 255) {
+                return true;
+            }
+        }
+    }
+
+    // Copies length bytes from offset back, the source may overlap what is being written.
+    static void LZCopyMatch(byte* op, u64 offset, u64 length, const byte* outputEnd) {
+        const byte* match = op - offset;
+        if (offset >= 16 && op + length + 16 <= outputEnd) {
+            for (u64 index = 0; index < length; index += 16) {
+                memcpy(op + index, match + index, 16);
+            }
+            return;
+        }
+
+        if (op + length + 8 > outputEnd) {
+            for (u64 index = 0; index < length; index++) {
+                op[index] = match[index];
+            }
+            return;
+        }
+
+        u64 index = 0;
+        u64 distance = offset;
+        if (offset < 8) {
+            // Short repeats, write the first 8 bytes one at a time, then copy from the closest multiple of the
+            // period that is at least 8 back. It holds the same bytes and never overlaps an 8 byte copy.
+            for (; index < 8; index++) {
+                op[index] = match[index];
+            }
+            distance = ((8 + offset - 1) / offset) * offset;
+        }
+
+        for (; index < length; index += 8) {
+            memcpy(op + index, op + index - distance, 8);
+        }
+    }
+
+    bool LZDecompress(const byte* src, u64 srcSizeBytes, byte* dst, u64 dstSizeBytes) {
+        const byte* ip = src;
+        const byte* inputEnd = src + srcSizeBytes;
+        byte* op = dst;
+        const byte* outputEnd = dst + dstSizeBytes;
+        for (;;) {
+            if (ip >= inputEnd) {
+                return false;
+            }
+
+            const byte token = *ip++;
+            u64 literalCount = token >> 4;
+            if (literalCount == 15 && LZReadLength(ip, inputEnd, dstSizeBytes, literalCount) == false) {
+                return false;
+            }
+
+            if (literalCount > (u64)(inputEnd - ip) || literalCount > (u64)(outputEnd - op)) {
+                return false;
+            }
+
+            if (literalCount <= 16 && ip + 16 <= inputEnd && op + 16 <= outputEnd) {
+                memcpy(op, ip, 16);
+            }
+            else {
+                memcpy(op, ip, literalCount);
+            }
+            ip += literalCount;
+            op += literalCount;
+
+            if (ip == inputEnd) {
+                return op == outputEnd;
+            }
+
+            if (inputEnd - ip < 2) {
+                return false;
+            }
+
+            const u64 offset = (u64)ip[0] | ((u64)ip[1] << 8);
+            ip += 2;
+            if (offset == 0 || offset > (u64)(op - dst)) {
+                return false;
+            }
+
+            u64 matchLength = token & 15;
+            if (matchLength == 15 && LZReadLength(ip, inputEnd, dstSizeBytes, matchLength) == false) {
+                return false;
+            }
+
+            matchLength += LZ_MIN_MATCH;
+            if (matchLength > (u64)(outputEnd - op)) {
+                return false;
+            }
+
+            LZCopyMatch(op, offset, matchLength, outputEnd);
+            op += matchLength;
+        }
+    }
+
+    struct LZChunkContext {
+        const byte*         src;
+        u64                 sizeBytes;
+        LZLevel             level;
+        byte*               output;
+        u64                 outputStride;
+        u32*                storedSizes;
+        byte*               dst;
+        const u64*          chunkOffsets;
+        std::atomic<bool>   failed;
+    };
+
+    static u64 LZChunkGetSize(u64 sizeBytes, i32 chunkIndex) {
+        const u64 start = (u64)chunkIndex * LZ_CHUNK_BYTES;
+        return sizeBytes - start < LZ_CHUNK_BYTES ? sizeBytes - start : LZ_CHUNK_BYTES;
+    }
+
+    static void LZCompressChunkJob(i32 chunkIndex, void* userData) {
+        LZChunkContext* context = (LZChunkContext*)userData;
+        const byte* chunk = context->src + (u64)chunkIndex * LZ_CHUNK_BYTES;
+        const u64 chunkSize = LZChunkGetSize(context->sizeBytes, chunkIndex);
+        byte* output = context->output + (u64)chunkIndex * context->outputStride;
+
+        const u64 compressedSize = LZCompress(chunk, chunkSize, output, context->level);
+        if (compressedSize < chunkSize) {
+            context->storedSizes[chunkIndex] = (u32)compressedSize;
+        }
+        else {
+            memcpy(output, chunk, chunkSize);
+            context->storedSizes[chunkIndex] = (u32)chunkSize | LZ_CHUNK_STORED_RAW;
+        }
+    }
+
+    void LZCompressChunks(const byte* src, u64 sizeBytes, List<byte>& compressed, LZLevel level) {
+        const i32 chunkCount = (i32)((sizeBytes + LZ_CHUNK_BYTES - 1) / LZ_CHUNK_BYTES);
+
+        LZChunkContext context = {};
+        context.src = src;
+        context.sizeBytes = sizeBytes;
+        context.level = level;
+        context.outputStride = LZCompressBound(LZ_CHUNK_BYTES);
+
+        List<byte> output;
+        List<u32> storedSizes;
+        output.SetNum((i32)(context.outputStride * chunkCount));
+        storedSizes.SetNum(chunkCount);
+        context.output = output.GetData();
+        context.storedSizes = storedSizes.GetData();
+        if (chunkCount > 1) {
+            Jobs::ParallelFor(chunkCount, LZCompressChunkJob, &context);
+        }
+        else if (chunkCount == 1) {
+            LZCompressChunkJob(0, &context);
+        }
+
+        u64 totalBytes = sizeof(u32) * (1 + (u64)chunkCount);
+        for (i32 chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++) {
+            totalBytes += storedSizes[chunkIndex] & ~LZ_CHUNK_STORED_RAW;
+        }
+
+        compressed.SetNum((i32)totalBytes);
+        byte* out = compressed.GetData();
+        const u32 chunkCountValue = (u32)chunkCount;
+        memcpy(out, &chunkCountValue, sizeof(u32));
+        memcpy(out + sizeof(u32), storedSizes.GetData(), sizeof(u32) * (u64)chunkCount);
+        out += sizeof(u32) * (1 + (u64)chunkCount);
+        for (i32 chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++) {
+            const u64 storedSize = storedSizes[chunkIndex] & ~LZ_CHUNK_STORED_RAW;
+            memcpy(out, output.GetData() + (u64)chunkIndex * context.outputStride, storedSize);
+            out += storedSize;
+        }
+    }
+
+    static void LZDecompressChunkJob(i32 chunkIndex, void* userData) {
+        LZChunkContext* context = (LZChunkContext*)userData;
+        const u32 storedSize = context->storedSizes[chunkIndex];
+        const u64 size = storedSize & ~LZ_CHUNK_STORED_RAW;
+        const byte* chunk = context->src + context->chunkOffsets[chunkIndex];
+        byte* dst = context->dst + (u64)chunkIndex * LZ_CHUNK_BYTES;
+        const u64 chunkSize = LZChunkGetSize(context->sizeBytes, chunkIndex);
+
+        if ((storedSize & LZ_CHUNK_STORED_RAW) != 0) {
+            if (size != chunkSize) {
+                context->failed = true;
+                return;
+            }
+            memcpy(dst, chunk, size);
+        }
+        else if (LZDecompress(chunk, size, dst, chunkSize) == false) {
+            context->failed = true;
+        }
+    }
+
+    bool LZDecompressChunks(const byte* src, u64 srcSizeBytes, byte* dst, u64 dstSizeBytes) {
+        if (srcSizeBytes < sizeof(u32)) {
+            return false;
+        }
+
+        u32 chunkCount = 0;
+        memcpy(&chunkCount, src, sizeof(u32));
+        const u64 tableBytes = sizeof(u32) * (1 + (u64)chunkCount);
+        if (chunkCount != (dstSizeBytes + LZ_CHUNK_BYTES - 1) / LZ_CHUNK_BYTES || tableBytes > srcSizeBytes) {
+            return false;
+        }
+
+        // The table is copied out because payloads are only 4 byte aligned by accident.
+        ScratchScope scratch;
+        u32* storedSizes = Memory::AllocateScratchStruct<u32>((i32)chunkCount);
+        u64* chunkOffsets = Memory::AllocateScratchStruct<u64>((i32)chunkCount);
+        memcpy(storedSizes, src + sizeof(u32), sizeof(u32) * (u64)chunkCount);
+        u64 offset = tableBytes;
+        for (u32 chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++) {
+            chunkOffsets[chunkIndex] = offset;
+            offset += storedSizes[chunkIndex] & ~LZ_CHUNK_STORED_RAW;
+        }
+
+        if (offset != srcSizeBytes) {
+            return false;
+        }
+
+        LZChunkContext context = {};
+        context.src = src;
+        context.sizeBytes = dstSizeBytes;
+        context.storedSizes = storedSizes;
+        context.chunkOffsets = chunkOffsets;
+        context.dst = dst;
+        if (chunkCount > 1) {
+            Jobs::ParallelFor((i32)chunkCount, LZDecompressChunkJob, &context);
+        }
+        else if (chunkCount == 1) {
+            LZDecompressChunkJob(0, &context);
+        }
+
+        return context.failed == false;
+    }
+}
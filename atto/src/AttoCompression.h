@@ -0,0 +1,42 @@
+#pragma once
+
+#include "AttoList.h"
+
+namespace atto
+{
+    // Byte oriented LZ77 codec in the spirit of LZ4, no entropy coding. Both levels write the same format, so there
+    // is a single decoder and it doesn't care how hard the encoder searched.
+    //
+    // Every sequence is a token byte, 4 bits of literal count and 4 bits of match length minus 4, optional 255
+    // continuation bytes for either, the literals and a 16 bit little endian offset. The last sequence is literals
+    // only. The last 5 bytes are always literals and no match starts in the last 12, the decoder relies on that to
+    // copy in 16 byte steps while it is away from the end of the output.
+
+    enum LZLevel : u32 {
+        // Stored as is, for packs that should be mapped and read without any decoding.
+        LZ_LEVEL_NONE = 0,
+        // Single hash table, one probe per position. Hundreds of MB/s to compress.
+        LZ_LEVEL_FAST,
+        // Hash chains with lazy matching. Several times slower to compress, decodes just as fast.
+        LZ_LEVEL_HIGH,
+        LZ_LEVEL_COUNT,
+    };
+
+    // Independent blocks that LZCompressChunks splits its input into, so they can be encoded and decoded in parallel.
+    static constexpr u64 LZ_CHUNK_BYTES = 256 * 1024;
+
+    const char*     LZLevelToString(LZLevel level);
+
+    // Largest output LZCompress can produce for sizeBytes of input.
+    u64             LZCompressBound(u64 sizeBytes);
+    // dst must hold LZCompressBound(sizeBytes) bytes. Returns the compressed size.
+    u64             LZCompress(const byte* src, u64 sizeBytes, byte* dst, LZLevel level);
+    // dstSizeBytes is the exact decompressed size. Corrupt input returns false, nothing is read or written out of bounds.
+    bool            LZDecompress(const byte* src, u64 srcSizeBytes, byte* dst, u64 dstSizeBytes);
+
+    // Chunked framing, a u32 chunk count, a u32 stored size per chunk and the chunks themselves. Chunks that don't
+    // get smaller are stored raw, marked by the top bit of their size. Chunks are compressed on the job workers.
+    void            LZCompressChunks(const byte* src, u64 sizeBytes, List<byte>& compressed, LZLevel level);
+    // Decodes the chunks on the job workers, straight into dst.
+    bool            LZDecompressChunks(const byte* src, u64 srcSizeBytes, byte* dst, u64 dstSizeBytes);
+}
@@ -1,5 +1,8 @@
 #include "AttoContainers.h"
 
+#include "AttoLib.h"
+
+#include <mutex>
 #include <string>
 #include <stdarg.h> 
 
@@ -35,4 +38,155 @@ namespace atto
         return result;
     }
 
+    // Each pool entry is a header followed by the characters and a terminator. Atoms point at the header.
+    struct StringAtomHeader {
+        u32 hash;
+        i32 length;
+    };
+
+    static constexpr u64    STRING_ATOM_POOL_BYTES = Megabytes(4);
+    static constexpr i32    STRING_ATOM_MIN_INDEX_CAPCITY = 1024;
+
+    static std::mutex       atomMutex;
+    static LinearArena      atomPool;
+    static byte*            atomPoolBase = nullptr;
+    static u32*             atomIndex = nullptr;        // Open addressed table of pool offsets, 0 is an empty slot
+    static i32              atomIndexCapcity = 0;
+    static i32              atomCount = 0;
+
+    static const StringAtomHeader* StringAtomGetHeader(u32 offset) {
+        return (const StringAtomHeader*)(atomPoolBase + offset);
+    }
+
+    static void StringAtomInsertIndex(u32* index, i32 capcity, u32 hash, u32 offset) {
+        const u32 mask = (u32)capcity - 1;
+        u32 slot = hash & mask;
+        while (index[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        index[slot] = offset;
+    }
+
+    static void StringAtomGrowIndex(i32 newCapcity) {
+        u32* newIndex = (u32*)calloc((size_t)newCapcity, sizeof(u32));
+        for (i32 slot = 0; slot < atomIndexCapcity; slot++) {
+            const u32 offset = atomIndex[slot];
+            if (offset != 0) {
+                StringAtomInsertIndex(newIndex, newCapcity, StringAtomGetHeader(offset)->hash, offset);
+            }
+        }
+
+        free(atomIndex);
+        atomIndex = newIndex;
+        atomIndexCapcity = newCapcity;
+    }
+
+    StringAtom StringAtom::Intern(const char* str) {
+        return Intern(str, str != nullptr ? (i32)strlen(str) : 0);
+    }
+
+    StringAtom StringAtom::Intern(const char* str, i32 length) {
+        StringAtom atom = {};
+        if (str == nullptr || length <= 0) {
+            return atom;
+        }
+
+        const u32 hash = StringHash::XXHash32(str, (u32)length);
+
+        std::lock_guard<std::mutex> lock(atomMutex);
+
+        if (atomPool.IsCreated() == false) {
+            atomPool.Create(STRING_ATOM_POOL_BYTES);
+            // Burn the first bytes so that no real string ends up at offset 0.
+            atomPoolBase = (byte*)atomPool.Allocate(sizeof(StringAtomHeader), alignof(StringAtomHeader));
+        }
+
+        if ((atomCount + 1) * 2 > atomIndexCapcity) {
+            StringAtomGrowIndex(atomIndexCapcity == 0 ? STRING_ATOM_MIN_INDEX_CAPCITY : atomIndexCapcity * 2);
+        }
+
+        const u32 mask = (u32)atomIndexCapcity - 1;
+        u32 slot = hash & mask;
+        while (atomIndex[slot] != 0) {
+            const u32 offset = atomIndex[slot];
+            const StringAtomHeader* header = StringAtomGetHeader(offset);
+            if (header->hash == hash && header->length == length && memcmp(header + 1, str, (size_t)length) == 0) {
+                atom.offset = offset;
+                return atom;
+            }
+            slot = (slot + 1) & mask;
+        }
+
+        const u64 entryBytes = sizeof(StringAtomHeader) + (u64)length + 1;
+        StringAtomHeader* header = (StringAtomHeader*)atomPool.Allocate(entryBytes, alignof(StringAtomHeader));
+        if (header == nullptr) {
+            return atom;
+        }
+        header->hash = hash;
+        header->length = length;
+        char* chars = (char*)(header + 1);
+        memcpy(chars, str, (size_t)length);
+        chars[length] = '\0';
+
+        atom.offset = (u32)((byte*)header - atomPoolBase);
+        atomIndex[slot] = atom.offset;
+        atomCount++;
+
+        return atom;
+    }
+
+    void StringAtom::Reserve(i32 count) {
+        std::lock_guard<std::mutex> lock(atomMutex);
+
+        i32 newCapcity = atomIndexCapcity == 0 ? STRING_ATOM_MIN_INDEX_CAPCITY : atomIndexCapcity;
+        while ((atomCount + count) * 2 > newCapcity) {
+            newCapcity *= 2;
+        }
+
+        if (newCapcity != atomIndexCapcity) {
+            StringAtomGrowIndex(newCapcity);
+        }
+    }
+
+    StringAtomStats StringAtom::GetStats() {
+        std::lock_guard<std::mutex> lock(atomMutex);
+
+        StringAtomStats stats = {};
+        stats.atomCount = atomCount;
+        stats.poolBytes = atomPool.GetUsed();
+        stats.poolCapacity = atomPool.GetCapacity();
+        stats.indexBytes = (u64)atomIndexCapcity * sizeof(u32);
+
+        return stats;
+    }
+
+    const char* StringAtom::GetCStr() const {
+        if (offset == 0) {
+            return "";
+        }
+
+        return (const char*)(StringAtomGetHeader(offset) + 1);
+    }
+
+    i32 StringAtom::GetLength() const {
+        if (offset == 0) {
+            return 0;
+        }
+
+        return StringAtomGetHeader(offset)->length;
+    }
+
+    bool StringAtom::IsEmpty() const {
+        return offset == 0;
+    }
+
+    bool StringAtom::EndsWith(const char* str) const {
+        const i32 length = GetLength();
+        const i32 suffixLength = (i32)strlen(str);
+        if (suffixLength > length) {
+            return false;
+        }
+
+        return memcmp(GetCStr() + length - suffixLength, str, (size_t)suffixLength) == 0;
+    }
 }
\ No newline at end of file
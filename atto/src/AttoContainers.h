@@ -2,6 +2,13 @@
 
 #include "AttoDefines.h"
 #include "AttoList.h"
+#include "AttoMemory.h"
+#include "AttoSort.h"
+
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace atto
 {
@@ -28,7 +35,13 @@ namespace atto
 
         T& operator[](const i32& index);
         const T& operator[](const i32& index) const;
-       
+
+        template<typename _less_ = SortLess>
+        void           IntroSort(_less_ less = _less_());
+        template<typename _less_ = SortLess>
+        void           StableSort(_less_ less = _less_());
+        template<typename _key_>
+        void           RadixSort(_key_ getKey);
 
     private:
         T data[capcity];
@@ -146,92 +159,885 @@ namespace atto
         return data[index];
     }
 
-    //template<typename _type_, i32 capcity>
-    //class FixedFreeList {
-    //public:
-    //    _type_*         Add();
-    //    void            Remove(_type_* ptr);
-    //    void            Clear();
+    template<typename T, i32 capcity>
+    template<typename _less_>
+    void FixedList<T, capcity>::IntroSort(_less_ less) {
+        atto::IntroSort(GetData(), count, less);
+    }
 
-    //    i32             GetCount() const;
-    //    i32             GetCapcity() const;
+    template<typename T, i32 capcity>
+    template<typename _less_>
+    void FixedList<T, capcity>::StableSort(_less_ less) {
+        atto::StableSort(GetData(), count, less);
+    }
 
-    //    _type_&         operator[](i32 index);
-    //    const _type_&   operator[](i32 index) const;
+    template<typename T, i32 capcity>
+    template<typename _key_>
+    void FixedList<T, capcity>::RadixSort(_key_ getKey) {
+        atto::RadixSort(GetData(), count, getKey);
+    }
 
-    //private:
-    //    void            InitializedIfNeedBe();
-    //    i32             FindFreeIndex();
+    // Fixed capcity list backed by raw storage. Unlike FixedList nothing is constructed up front, items are
+    // constructed when added and destructed when removed, so large lists of heavy types are cheap to create.
+    template<typename T, i32 capcity>
+    class FixedStorageList
+    {
+    public:
+        FixedStorageList();
+        FixedStorageList(const FixedStorageList& other);
+        FixedStorageList& operator=(const FixedStorageList& other);
+        ~FixedStorageList();
 
-    //    FixedList<_type_,   capcity> list;
-    //    FixedList<i32,      capcity> freeList;
-    //};
+        T*             GetData();
+        const T*       GetData() const;
+        i32            GetCapcity() const;
+        i32            GetCount() const;
+        bool           IsFull() const;
+        bool           IsEmpty() const;
+        void           Clear();
 
-    //template<typename _type_, i32 capcity>
-    //_type_* FixedFreeList<_type_, capcity>::Add() {
-    //    InitializedIfNeedBe();
-    //    const i32 freeIndex = FindFreeIndex();
-    //    Assert(freeIndex != -1, "FixedFreeList, no free index");
-    //    list.SetCount(list.GetCount() + 1);
-    //    return list[freeIndex];
-    //}
-    //
-    //template<typename _type_, i32 capcity>
-    //void FixedFreeList<_type_, capcity>::Remove(_type_* ptr) {
-    //    list.SetCount(list.GetCount() - 1);
-    //    const i32 
-    //}
-    //
-    //template<typename _type_, i32 capcity>
-    //void FixedFreeList<_type_, capcity>::Clear() {
-    //    
-    //}
+        T*             Add(const T& value);
+        T*             Add(T&& value);
+        template<typename... _args_>
+        T*             Emplace(_args_&&... args);
+        b8             AddIfPossible(const T& value);
+        void           RemoveIndex(const i32& index);
+        void           RemoveIndexSwap(const i32& index);
+        void           Remove(const T* ptr);
+        template<typename _pred_>
+        i32            RemoveIf(_pred_ pred);
 
-    //template<typename _type_, i32 capcity>
-    //i32 atto::FixedFreeList<_type_, capcity>::GetCount() const
-    //{
+        T*             Get(const i32& index);
+        const T*       Get(const i32& index) const;
 
-    //}
+        T&             operator[](const i32& index);
+        const T&       operator[](const i32& index) const;
 
-    //template<typename _type_, i32 capcity>
-    //i32 atto::FixedFreeList<_type_, capcity>::GetCapcity() const
-    //{
+        template<typename _less_ = SortLess>
+        void           IntroSort(_less_ less = _less_());
+        template<typename _less_ = SortLess>
+        void           StableSort(_less_ less = _less_());
+        template<typename _key_>
+        void           RadixSort(_key_ getKey);
 
-    //}
+    private:
+        static constexpr bool isTrivial = std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value;
+
+        alignas(T) byte storage[sizeof(T) * capcity];
+        i32 count;
+    };
 
-    //template<typename _type_, i32 capcity>
-    //_type_& atto::FixedFreeList<_type_, capcity>::operator[](i32 index)
-    //{
+    template<typename T, i32 capcity>
+    FixedStorageList<T, capcity>::FixedStorageList() : count(0) {
+    }
 
-    //}
+    template<typename T, i32 capcity>
+    FixedStorageList<T, capcity>::FixedStorageList(const FixedStorageList& other) : count(0) {
+        *this = other;
+    }
 
-    //template<typename _type_, i32 capcity>
-    //const _type_& atto::FixedFreeList<_type_, capcity>::operator[](i32 index) const
-    //{
+    template<typename T, i32 capcity>
+    FixedStorageList<T, capcity>& FixedStorageList<T, capcity>::operator=(const FixedStorageList& other) {
+        if (this == &other) {
+            return *this;
+        }
 
-    //}
+        Clear();
+        if constexpr (isTrivial) {
+            memcpy(storage, other.storage, sizeof(T) * other.count);
+        }
+        else {
+            const T* src = other.GetData();
+            T* dst = GetData();
+            for (i32 index = 0; index < other.count; index++) {
+                new (dst + index) T(src[index]);
+            }
+        }
+        count = other.count;
 
-    //template<typename _type_, i32 capcity>
-    //void FixedFreeList<_type_, capcity>::InitializedIfNeedBe() {
-    //    if (freeList.GetCount() == 0 && list.GetCount() == 0) {
-    //        const i32 cap = freeList.GetCapcity();
-    //        for (i32 i = cap - 1; i >= 0; i--) {
-    //            freeList.Add(i);
-    //        }
-    //    }
-    //}
-    //
-    //template<typename _type_, i32 capcity>
-    //i32 FixedFreeList<_type_, capcity>::FindFreeIndex() {
-    //    const i32 freeListCount = freeList.GetCount();
-    //    if (freeListCount > 0) {
-    //        const i32 freeIndex = freeList[freeListCount - 1];
-    //        freeList.RemoveIndex(freeListCount - 1);
-    //        return freeIndex;
-    //    }
-    //    
-    //    return -1;
-    //}
+        return *this;
+    }
+
+    template<typename T, i32 capcity>
+    FixedStorageList<T, capcity>::~FixedStorageList() {
+        Clear();
+    }
+
+    template<typename T, i32 capcity>
+    T* FixedStorageList<T, capcity>::GetData() {
+        return reinterpret_cast<T*>(storage);
+    }
+
+    template<typename T, i32 capcity>
+    const T* FixedStorageList<T, capcity>::GetData() const {
+        return reinterpret_cast<const T*>(storage);
+    }
+
+    template<typename T, i32 capcity>
+    i32 FixedStorageList<T, capcity>::GetCapcity() const {
+        return capcity;
+    }
+
+    template<typename T, i32 capcity>
+    i32 FixedStorageList<T, capcity>::GetCount() const {
+        return count;
+    }
+
+    template<typename T, i32 capcity>
+    bool FixedStorageList<T, capcity>::IsFull() const {
+        return capcity == count;
+    }
+
+    template<typename T, i32 capcity>
+    bool FixedStorageList<T, capcity>::IsEmpty() const {
+        return count == 0;
+    }
+
+    template<typename T, i32 capcity>
+    void FixedStorageList<T, capcity>::Clear() {
+        if constexpr (!std::is_trivially_destructible<T>::value) {
+            T* data = GetData();
+            for (i32 index = 0; index < count; index++) {
+                data[index].~T();
+            }
+        }
+        count = 0;
+    }
+
+    template<typename T, i32 capcity>
+    T* FixedStorageList<T, capcity>::Add(const T& value) {
+        Assert(count < capcity, "Array, add to many items");
+        T* item = new (GetData() + count) T(value);
+        count++;
+
+        return item;
+    }
+
+    template<typename T, i32 capcity>
+    T* FixedStorageList<T, capcity>::Add(T&& value) {
+        Assert(count < capcity, "Array, add to many items");
+        T* item = new (GetData() + count) T(std::move(value));
+        count++;
+
+        return item;
+    }
+
+    template<typename T, i32 capcity>
+    template<typename... _args_>
+    T* FixedStorageList<T, capcity>::Emplace(_args_&&... args) {
+        Assert(count < capcity, "Array, add to many items");
+        T* item = new (GetData() + count) T{ std::forward<_args_>(args)... };
+        count++;
+
+        return item;
+    }
+
+    template<typename T, i32 capcity>
+    b8 FixedStorageList<T, capcity>::AddIfPossible(const T& value) {
+        if (count < capcity) {
+            new (GetData() + count) T(value);
+            count++;
+
+            return true;
+        }
+
+        return false;
+    }
+
+    template<typename T, i32 capcity>
+    void FixedStorageList<T, capcity>::RemoveIndex(const i32& index) {
+        Assert(index >= 0 && index < count, "Array invalid remove index ");
+        T* data = GetData();
+        if constexpr (isTrivial) {
+            memmove(data + index, data + index + 1, sizeof(T) * (count - index - 1));
+        }
+        else {
+            for (i32 i = index; i < count - 1; i++) {
+                data[i] = std::move(data[i + 1]);
+            }
+            data[count - 1].~T();
+        }
+        count--;
+    }
+
+    template<typename T, i32 capcity>
+    void FixedStorageList<T, capcity>::RemoveIndexSwap(const i32& index) {
+        Assert(index >= 0 && index < count, "Array invalid remove index ");
+        T* data = GetData();
+        const i32 last = count - 1;
+        if (index != last) {
+            data[index] = std::move(data[last]);
+        }
+        if constexpr (!std::is_trivially_destructible<T>::value) {
+            data[last].~T();
+        }
+        count--;
+    }
+
+    template<typename T, i32 capcity>
+    void FixedStorageList<T, capcity>::Remove(const T* ptr) {
+        const i32 index = (i32)(ptr - GetData());
+        if (index >= 0 && index < count) {
+            RemoveIndex(index);
+        }
+    }
+
+    // Removes every item the predicate returns true for, keeping the order of the rest. Returns the number removed.
+    template<typename T, i32 capcity>
+    template<typename _pred_>
+    i32 FixedStorageList<T, capcity>::RemoveIf(_pred_ pred) {
+        T* data = GetData();
+        i32 write = 0;
+        for (i32 read = 0; read < count; read++) {
+            if (pred(data[read])) {
+                continue;
+            }
+            if (write != read) {
+                data[write] = std::move(data[read]);
+            }
+            write++;
+        }
+
+        if constexpr (!std::is_trivially_destructible<T>::value) {
+            for (i32 index = write; index < count; index++) {
+                data[index].~T();
+            }
+        }
+
+        const i32 removed = count - write;
+        count = write;
+
+        return removed;
+    }
+
+    template<typename T, i32 capcity>
+    T* FixedStorageList<T, capcity>::Get(const i32& index) {
+        Assert(index >= 0 && index < count, "Array, invalid index");
+        return GetData() + index;
+    }
+
+    template<typename T, i32 capcity>
+    const T* FixedStorageList<T, capcity>::Get(const i32& index) const {
+        Assert(index >= 0 && index < count, "Array, invalid index");
+        return GetData() + index;
+    }
+
+    template<typename T, i32 capcity>
+    T& FixedStorageList<T, capcity>::operator[](const i32& index) {
+        Assert(index >= 0 && index < count, "Array, invalid index");
+        return GetData()[index];
+    }
+
+    template<typename T, i32 capcity>
+    const T& FixedStorageList<T, capcity>::operator[](const i32& index) const {
+        Assert(index >= 0 && index < count, "Array, invalid index");
+        return GetData()[index];
+    }
+
+    template<typename T, i32 capcity>
+    template<typename _less_>
+    void FixedStorageList<T, capcity>::IntroSort(_less_ less) {
+        atto::IntroSort(GetData(), count, less);
+    }
+
+    template<typename T, i32 capcity>
+    template<typename _less_>
+    void FixedStorageList<T, capcity>::StableSort(_less_ less) {
+        atto::StableSort(GetData(), count, less);
+    }
+
+    template<typename T, i32 capcity>
+    template<typename _key_>
+    void FixedStorageList<T, capcity>::RadixSort(_key_ getKey) {
+        atto::RadixSort(GetData(), count, getKey);
+    }
+
+    // List whose memory lives in a LinearArena. Nothing is ever freed or destructed, the memory is given back when the
+    // arena is reset. When created with an arena the list grows inside it, otherwise the capcity is fixed.
+    template<typename _type_>
+    class TransientList
+    {
+        static_assert(std::is_trivially_copyable<_type_>::value && std::is_trivially_destructible<_type_>::value,
+            "TransientList, elements are moved with memcpy and never destructed");
+
+    public:
+        TransientList();
+        TransientList(i32 capcity, _type_* data);
+        TransientList(LinearArena& arena, i32 capcity);
+
+        _type_*         GetData();
+        const _type_*   GetData() const;
+        i32             GetCapcity() const;
+        i32             GetCount() const;
+        void            SetCount(i32 count);
+        bool            IsFull() const;
+        bool            IsEmpty() const;
+        void            Clear();
+        void            Reserve(i32 newCapcity);
+
+        _type_*         Add(const _type_& value);
+        void            RemoveIndex(const i32& index);
+
+        _type_&         operator[](const i32& index);
+        const _type_&   operator[](const i32& index) const;
+
+        _type_*         data;
+        i32             count;
+        i32             capcity;
+        LinearArena*    arena;
+    };
+
+    template<typename _type_>
+    TransientList<_type_>::TransientList() : data(nullptr), count(0), capcity(0), arena(nullptr) {
+    }
+
+    template<typename _type_>
+    TransientList<_type_>::TransientList(i32 capcity, _type_* data) : data(data), count(0), capcity(capcity), arena(nullptr) {
+        Assert(data != nullptr || capcity == 0, "TransientList, no memory");
+    }
+
+    template<typename _type_>
+    TransientList<_type_>::TransientList(LinearArena& arena, i32 capcity) : data(nullptr), count(0), capcity(0), arena(&arena) {
+        Reserve(capcity);
+    }
+
+    template<typename _type_>
+    _type_* TransientList<_type_>::GetData() {
+        return data;
+    }
+
+    template<typename _type_>
+    const _type_* TransientList<_type_>::GetData() const {
+        return data;
+    }
+
+    template<typename _type_>
+    i32 TransientList<_type_>::GetCapcity() const {
+        return capcity;
+    }
+
+    template<typename _type_>
+    i32 TransientList<_type_>::GetCount() const {
+        return count;
+    }
+
+    template<typename _type_>
+    void TransientList<_type_>::SetCount(i32 newCount) {
+        Assert(newCount >= 0 && newCount <= capcity, "TransientList, invalid count");
+        count = newCount;
+    }
+
+    template<typename _type_>
+    bool TransientList<_type_>::IsFull() const {
+        return count == capcity;
+    }
+
+    template<typename _type_>
+    bool TransientList<_type_>::IsEmpty() const {
+        return count == 0;
+    }
+
+    template<typename _type_>
+    void TransientList<_type_>::Clear() {
+        count = 0;
+    }
+
+    template<typename _type_>
+    void TransientList<_type_>::Reserve(i32 newCapcity) {
+        if (newCapcity <= capcity) {
+            return;
+        }
+
+        Assert(arena != nullptr, "TransientList, can't grow a list without an arena");
+        if (arena == nullptr) {
+            return;
+        }
+
+        const u64 alignment = alignof(_type_) > 16 ? alignof(_type_) : 16;
+        _type_* newData = (_type_*)arena->Reallocate(data, sizeof(_type_) * (u64)capcity, sizeof(_type_) * (u64)newCapcity, alignment);
+        if (newData != nullptr) {
+            data = newData;
+            capcity = newCapcity;
+        }
+    }
+
+    template<typename _type_>
+    _type_* TransientList<_type_>::Add(const _type_& value) {
+        if (count == capcity && arena != nullptr) {
+            const _type_ copy = value;
+            Reserve(capcity < 8 ? 16 : capcity * 2);
+            Assert(count < capcity, "TransientList, add to many items");
+            data[count] = copy;
+            return &data[count++];
+        }
+
+        Assert(count < capcity, "TransientList, add to many items");
+        data[count] = value;
+        return &data[count++];
+    }
+
+    template<typename _type_>
+    void TransientList<_type_>::RemoveIndex(const i32& index) {
+        Assert(index >= 0 && index < count, "TransientList, invalid remove index");
+        memmove(data + index, data + index + 1, sizeof(_type_) * (u64)(count - index - 1));
+        count--;
+    }
+
+    template<typename _type_>
+    _type_& TransientList<_type_>::operator[](const i32& index) {
+        Assert(index >= 0 && index < capcity, "TransientList, invalid index");
+        return data[index];
+    }
+
+    template<typename _type_>
+    const _type_& TransientList<_type_>::operator[](const i32& index) const {
+        Assert(index >= 0 && index < capcity, "TransientList, invalid index");
+        return data[index];
+    }
+
+    // Murmur3 finalizer, spreads the bits of already hashed keys (like AssetIds) across the table.
+    inline u32 HashKey(u32 key) {
+        key ^= key >> 16;
+        key *= 0x85ebca6b;
+        key ^= key >> 13;
+        key *= 0xc2b2ae35;
+        key ^= key >> 16;
+        return key;
+    }
+
+    inline u32 HashKey(i32 key) {
+        return HashKey((u32)key);
+    }
+
+    inline u32 HashKey(u64 key) {
+        return HashKey((u32)key ^ HashKey((u32)(key >> 32)));
+    }
+
+    // Open addressing hash map with linear probing. Capcity must be a power of two and
+    // should be at least twice the amount of expected entries to keep probe chains short.
+    template<typename _key_, typename _value_, i32 capcity>
+    class FixedHashMap
+    {
+        static_assert(capcity > 0 && (capcity & (capcity - 1)) == 0, "FixedHashMap, capcity must be a power of two");
+
+    public:
+        _value_*        Add(const _key_& key, const _value_& value);
+        _value_*        Find(const _key_& key);
+        const _value_*  Find(const _key_& key) const;
+        b8              Contains(const _key_& key) const;
+        b8              Remove(const _key_& key);
+        void            Clear();
+
+        i32             GetCount() const;
+        i32             GetCapcity() const;
+        bool            IsFull() const;
+        bool            IsEmpty() const;
+
+    private:
+        i32             FindSlot(const _key_& key) const;
+
+        _key_           keys[capcity];
+        _value_         values[capcity];
+        b8              occupied[capcity];
+        i32             count;
+    };
+
+    template<typename _key_, typename _value_, i32 capcity>
+    i32 FixedHashMap<_key_, _value_, capcity>::FindSlot(const _key_& key) const {
+        const u32 mask = (u32)capcity - 1;
+        u32 slot = HashKey(key) & mask;
+        for (i32 probe = 0; probe < capcity; probe++) {
+            if (occupied[slot] == false) {
+                return -1;
+            }
+
+            if (keys[slot] == key) {
+                return (i32)slot;
+            }
+
+            slot = (slot + 1) & mask;
+        }
+
+        return -1;
+    }
+
+    template<typename _key_, typename _value_, i32 capcity>
+    _value_* FixedHashMap<_key_, _value_, capcity>::Add(const _key_& key, const _value_& value) {
+        const u32 mask = (u32)capcity - 1;
+        u32 slot = HashKey(key) & mask;
+        for (i32 probe = 0; probe < capcity; probe++) {
+            if (occupied[slot] == false) {
+                // Always keep one empty slot around so that failed lookups terminate.
+                Assert(count + 1 < capcity, "FixedHashMap, to many items");
+                if (count + 1 >= capcity) {
+                    return nullptr;
+                }
+
+                occupied[slot] = true;
+                keys[slot] = key;
+                values[slot] = value;
+                count++;
+
+                return &values[slot];
+            }
+
+            if (keys[slot] == key) {
+                values[slot] = value;
+                return &values[slot];
+            }
+
+            slot = (slot + 1) & mask;
+        }
+
+        return nullptr;
+    }
+
+    template<typename _key_, typename _value_, i32 capcity>
+    _value_* FixedHashMap<_key_, _value_, capcity>::Find(const _key_& key) {
+        const i32 slot = FindSlot(key);
+        return slot >= 0 ? &values[slot] : nullptr;
+    }
+
+    template<typename _key_, typename _value_, i32 capcity>
+    const _value_* FixedHashMap<_key_, _value_, capcity>::Find(const _key_& key) const {
+        const i32 slot = FindSlot(key);
+        return slot >= 0 ? &values[slot] : nullptr;
+    }
+
+    template<typename _key_, typename _value_, i32 capcity>
+    b8 FixedHashMap<_key_, _value_, capcity>::Contains(const _key_& key) const {
+        return FindSlot(key) >= 0;
+    }
+
+    template<typename _key_, typename _value_, i32 capcity>
+    b8 FixedHashMap<_key_, _value_, capcity>::Remove(const _key_& key) {
+        const i32 slot = FindSlot(key);
+        if (slot < 0) {
+            return false;
+        }
+
+        // Backward shift deletion, pulls later members of the probe chain into the hole so we never need tombstones.
+        const u32 mask = (u32)capcity - 1;
+        u32 hole = (u32)slot;
+        u32 next = (hole + 1) & mask;
+        while (occupied[next]) {
+            const u32 home = HashKey(keys[next]) & mask;
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                keys[hole] = keys[next];
+                values[hole] = values[next];
+                hole = next;
+            }
+            next = (next + 1) & mask;
+        }
+
+        occupied[hole] = false;
+        count--;
+
+        return true;
+    }
+
+    template<typename _key_, typename _value_, i32 capcity>
+    void FixedHashMap<_key_, _value_, capcity>::Clear() {
+        for (i32 i = 0; i < capcity; i++) {
+            occupied[i] = false;
+        }
+        count = 0;
+    }
+
+    template<typename _key_, typename _value_, i32 capcity>
+    i32 FixedHashMap<_key_, _value_, capcity>::GetCount() const {
+        return count;
+    }
+
+    template<typename _key_, typename _value_, i32 capcity>
+    i32 FixedHashMap<_key_, _value_, capcity>::GetCapcity() const {
+        return capcity;
+    }
+
+    template<typename _key_, typename _value_, i32 capcity>
+    bool FixedHashMap<_key_, _value_, capcity>::IsFull() const {
+        return count + 1 >= capcity;
+    }
+
+    template<typename _key_, typename _value_, i32 capcity>
+    bool FixedHashMap<_key_, _value_, capcity>::IsEmpty() const {
+        return count == 0;
+    }
+
+    // Handle to an item in a FixedFreeList. Generations start at 1 so a zeroed ref never points at anything.
+    struct EntityRef {
+        u32 index;
+        u32 generation;
+    };
+
+    // Generational slot map. Add and Remove are O(1), items are packed densely so they can be iterated with
+    // GetCount/operator[], and refs to removed items are detected instead of aliasing whatever reuses the slot.
+    // Removing moves the last item into the hole, so hold on to refs rather than pointers.
+    template<typename _type_, i32 capcity>
+    class FixedFreeList {
+    public:
+        EntityRef       Add(const _type_& value);
+        b8              Remove(EntityRef ref);
+        void            Clear();
+
+        _type_*         Get(EntityRef ref);
+        const _type_*   Get(EntityRef ref) const;
+        b8              IsValid(EntityRef ref) const;
+        EntityRef       GetRef(i32 index) const;
+
+        i32             GetCount() const;
+        i32             GetCapcity() const;
+        bool            IsFull() const;
+        bool            IsEmpty() const;
+
+        _type_&         operator[](i32 index);
+        const _type_&   operator[](i32 index) const;
+
+    private:
+        struct Slot {
+            u32 generation;
+            i32 denseIndex;     // -1 when the slot is free
+            i32 nextFree;       // Stored + 1 so that a zeroed list is a valid empty list
+        };
+
+        FixedStorageList<_type_, capcity>   dense;
+        i32                                 denseToSlot[capcity];
+        Slot                                slots[capcity];
+        i32                                 slotsUsed = 0;
+        i32                                 freeHead = 0;
+    };
+
+    template<typename _type_, i32 capcity>
+    EntityRef FixedFreeList<_type_, capcity>::Add(const _type_& value) {
+        EntityRef ref = {};
+        if (dense.IsFull()) {
+            Assert(false, "FixedFreeList, to many items");
+            return ref;
+        }
+
+        i32 slotIndex = 0;
+        if (freeHead != 0) {
+            slotIndex = freeHead - 1;
+            freeHead = slots[slotIndex].nextFree;
+        }
+        else {
+            slotIndex = slotsUsed++;
+            slots[slotIndex].generation = 1;
+        }
+
+        const i32 denseIndex = dense.GetCount();
+        dense.Add(value);
+        denseToSlot[denseIndex] = slotIndex;
+
+        Slot& slot = slots[slotIndex];
+        slot.denseIndex = denseIndex;
+        slot.nextFree = 0;
+
+        ref.index = (u32)slotIndex;
+        ref.generation = slot.generation;
+
+        return ref;
+    }
+
+    template<typename _type_, i32 capcity>
+    b8 FixedFreeList<_type_, capcity>::Remove(EntityRef ref) {
+        if (IsValid(ref) == false) {
+            return false;
+        }
+
+        Slot& slot = slots[ref.index];
+        const i32 denseIndex = slot.denseIndex;
+        const i32 lastIndex = dense.GetCount() - 1;
+
+        // Move the last item into the hole so the items stay packed.
+        dense.RemoveIndexSwap(denseIndex);
+        if (denseIndex != lastIndex) {
+            denseToSlot[denseIndex] = denseToSlot[lastIndex];
+            slots[denseToSlot[denseIndex]].denseIndex = denseIndex;
+        }
+
+        slot.denseIndex = -1;
+        slot.generation++;
+        if (slot.generation == 0) {
+            slot.generation = 1;
+        }
+        slot.nextFree = freeHead;
+        freeHead = (i32)ref.index + 1;
+
+        return true;
+    }
+
+    template<typename _type_, i32 capcity>
+    void FixedFreeList<_type_, capcity>::Clear() {
+        // Bump every generation so refs handed out before the clear stay invalid.
+        for (i32 slotIndex = 0; slotIndex < slotsUsed; slotIndex++) {
+            Slot& slot = slots[slotIndex];
+            if (slot.denseIndex >= 0) {
+                slot.denseIndex = -1;
+                slot.generation++;
+                if (slot.generation == 0) {
+                    slot.generation = 1;
+                }
+            }
+            slot.nextFree = slotIndex + 2 <= slotsUsed ? slotIndex + 2 : 0;
+        }
+
+        freeHead = slotsUsed > 0 ? 1 : 0;
+        dense.Clear();
+    }
+
+    template<typename _type_, i32 capcity>
+    _type_* FixedFreeList<_type_, capcity>::Get(EntityRef ref) {
+        if (IsValid(ref) == false) {
+            return nullptr;
+        }
+
+        return &dense[slots[ref.index].denseIndex];
+    }
+
+    template<typename _type_, i32 capcity>
+    const _type_* FixedFreeList<_type_, capcity>::Get(EntityRef ref) const {
+        if (IsValid(ref) == false) {
+            return nullptr;
+        }
+
+        return &dense[slots[ref.index].denseIndex];
+    }
+
+    template<typename _type_, i32 capcity>
+    b8 FixedFreeList<_type_, capcity>::IsValid(EntityRef ref) const {
+        if (ref.generation == 0 || ref.index >= (u32)slotsUsed) {
+            return false;
+        }
+
+        const Slot& slot = slots[ref.index];
+        return slot.generation == ref.generation && slot.denseIndex >= 0;
+    }
+
+    template<typename _type_, i32 capcity>
+    EntityRef FixedFreeList<_type_, capcity>::GetRef(i32 index) const {
+        Assert(index >= 0 && index < dense.GetCount(), "FixedFreeList, invalid index");
+
+        EntityRef ref = {};
+        ref.index = (u32)denseToSlot[index];
+        ref.generation = slots[ref.index].generation;
+
+        return ref;
+    }
+
+    template<typename _type_, i32 capcity>
+    i32 FixedFreeList<_type_, capcity>::GetCount() const {
+        return dense.GetCount();
+    }
+
+    template<typename _type_, i32 capcity>
+    i32 FixedFreeList<_type_, capcity>::GetCapcity() const {
+        return capcity;
+    }
+
+    template<typename _type_, i32 capcity>
+    bool FixedFreeList<_type_, capcity>::IsFull() const {
+        return dense.IsFull();
+    }
+
+    template<typename _type_, i32 capcity>
+    bool FixedFreeList<_type_, capcity>::IsEmpty() const {
+        return dense.IsEmpty();
+    }
+
+    template<typename _type_, i32 capcity>
+    _type_& FixedFreeList<_type_, capcity>::operator[](i32 index) {
+        Assert(index >= 0 && index < dense.GetCount(), "FixedFreeList, invalid index");
+        return dense[index];
+    }
+
+    template<typename _type_, i32 capcity>
+    const _type_& FixedFreeList<_type_, capcity>::operator[](i32 index) const {
+        Assert(index >= 0 && index < dense.GetCount(), "FixedFreeList, invalid index");
+        return dense[index];
+    }
+
+    // Bounded queue that any number of threads can push to and pop from without a lock. Every cell carries a
+    // sequence number that tells whether it is ready to be written or read on the current pass around the ring,
+    // producers and consumers only contend on the head or tail they claim.
+    template<typename _type_, i32 capcity>
+    class FixedAtomicQueue {
+        static_assert((capcity & (capcity - 1)) == 0, "FixedAtomicQueue, capcity must be a power of two");
+        static_assert(std::is_trivially_copyable<_type_>::value, "FixedAtomicQueue, items are copied in and out of the cells");
+
+    public:
+        FixedAtomicQueue();
+        DISABLE_COPY_AND_MOVE(FixedAtomicQueue);
+
+        // Returns false when the queue is full.
+        bool            Push(const _type_& value);
+        // Returns false when the queue is empty.
+        bool            Pop(_type_& value);
+
+    private:
+        struct Cell {
+            std::atomic<u64>    sequence;
+            _type_              value;
+        };
+
+        Cell                        cells[capcity];
+        alignas(64) std::atomic<u64> head;
+        alignas(64) std::atomic<u64> tail;
+    };
+
+    template<typename _type_, i32 capcity>
+    FixedAtomicQueue<_type_, capcity>::FixedAtomicQueue() {
+        for (i32 cellIndex = 0; cellIndex < capcity; cellIndex++) {
+            cells[cellIndex].sequence.store((u64)cellIndex, std::memory_order_relaxed);
+        }
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+    template<typename _type_, i32 capcity>
+    bool FixedAtomicQueue<_type_, capcity>::Push(const _type_& value) {
+        u64 position = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[position & (capcity - 1)];
+            const i64 difference = (i64)cell.sequence.load(std::memory_order_acquire) - (i64)position;
+            if (difference == 0) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0) {
+                // The consumer is a whole pass behind.
+                return false;
+            }
+            else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template<typename _type_, i32 capcity>
+    bool FixedAtomicQueue<_type_, capcity>::Pop(_type_& value) {
+        u64 position = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[position & (capcity - 1)];
+            const i64 difference = (i64)cell.sequence.load(std::memory_order_acquire) - (i64)(position + 1);
+            if (difference == 0) {
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = cell.value;
+                    cell.sequence.store(position + capcity, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0) {
+                return false;
+            }
+            else {
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
 
     class StringHash
     {
@@ -258,11 +1064,171 @@ namespace atto
             return hash;
         }
 
+        // https://github.com/Cyan4973/xxHash, 32 bit variant. Reads bytes one at a time so it stays constexpr,
+        // optimizers fold that back into plain loads.
+        inline static constexpr u32 XXHash32(const char* str, u32 length, u32 seed = 0) {
+            u32 i = 0;
+            u32 hash = 0;
+            if (length >= 16) {
+                u32 v1 = seed + XXH_PRIME32_1 + XXH_PRIME32_2;
+                u32 v2 = seed + XXH_PRIME32_2;
+                u32 v3 = seed;
+                u32 v4 = seed - XXH_PRIME32_1;
+                for (; i + 16 <= length; i += 16) {
+                    v1 = XXHashRound(v1, Read32(str + i));
+                    v2 = XXHashRound(v2, Read32(str + i + 4));
+                    v3 = XXHashRound(v3, Read32(str + i + 8));
+                    v4 = XXHashRound(v4, Read32(str + i + 12));
+                }
+                hash = RotL32(v1, 1) + RotL32(v2, 7) + RotL32(v3, 12) + RotL32(v4, 18);
+            }
+            else {
+                hash = seed + XXH_PRIME32_5;
+            }
+
+            hash += length;
+            for (; i + 4 <= length; i += 4) {
+                hash += Read32(str + i) * XXH_PRIME32_3;
+                hash = RotL32(hash, 17) * XXH_PRIME32_4;
+            }
+            for (; i < length; i++) {
+                hash += (u32)(u8)str[i] * XXH_PRIME32_5;
+                hash = RotL32(hash, 11) * XXH_PRIME32_1;
+            }
+
+            hash ^= hash >> 15;
+            hash *= XXH_PRIME32_2;
+            hash ^= hash >> 13;
+            hash *= XXH_PRIME32_3;
+            hash ^= hash >> 16;
+
+            return hash;
+        }
+
+        // xxHash 64 bit variant, for hashing whole payloads where 32 bits would collide.
+        inline static constexpr u64 XXHash64(const char* str, u64 length, u64 seed = 0) {
+            u64 i = 0;
+            u64 hash = 0;
+            if (length >= 32) {
+                u64 v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+                u64 v2 = seed + XXH_PRIME64_2;
+                u64 v3 = seed;
+                u64 v4 = seed - XXH_PRIME64_1;
+                for (; i + 32 <= length; i += 32) {
+                    v1 = XXHash64Round(v1, Read64(str + i));
+                    v2 = XXHash64Round(v2, Read64(str + i + 8));
+                    v3 = XXHash64Round(v3, Read64(str + i + 16));
+                    v4 = XXHash64Round(v4, Read64(str + i + 24));
+                }
+                hash = RotL64(v1, 1) + RotL64(v2, 7) + RotL64(v3, 12) + RotL64(v4, 18);
+                hash = XXHash64Merge(hash, v1);
+                hash = XXHash64Merge(hash, v2);
+                hash = XXHash64Merge(hash, v3);
+                hash = XXHash64Merge(hash, v4);
+            }
+            else {
+                hash = seed + XXH_PRIME64_5;
+            }
+
+            hash += length;
+            for (; i + 8 <= length; i += 8) {
+                hash ^= XXHash64Round(0, Read64(str + i));
+                hash = RotL64(hash, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+            }
+            if (i + 4 <= length) {
+                hash ^= (u64)Read32(str + i) * XXH_PRIME64_1;
+                hash = RotL64(hash, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+                i += 4;
+            }
+            for (; i < length; i++) {
+                hash ^= (u64)(u8)str[i] * XXH_PRIME64_5;
+                hash = RotL64(hash, 11) * XXH_PRIME64_1;
+            }
+
+            hash ^= hash >> 33;
+            hash *= XXH_PRIME64_2;
+            hash ^= hash >> 29;
+            hash *= XXH_PRIME64_3;
+            hash ^= hash >> 32;
+
+            return hash;
+        }
+
+        // 64 bit FNV-1a, for when 32 bits of id space isn't enough.
+        inline static constexpr u64 FNV1a64(const char* str, u64 length) {
+            u64 hash = 0xCBF29CE484222325ull;
+            for (u64 i = 0; i < length; i++) {
+                hash ^= (u64)(u8)str[i];
+                hash *= 0x100000001B3ull;
+            }
+
+            return hash;
+        }
+
+        // 0 is reserved for invalid ids so it is never returned.
         inline static constexpr u32 Hash(const char* str) {
-            return DEKHash(str, (u32)ConstStrLen(str));
+            const u32 hash = XXHash32(str, (u32)ConstStrLen(str));
+            return hash != 0 ? hash : 1;
+        }
+
+        inline static constexpr u64 Hash64(const char* str) {
+            const u64 hash = FNV1a64(str, ConstStrLen(str));
+            return hash != 0 ? hash : 1;
+        }
+
+    private:
+        static constexpr u32 XXH_PRIME32_1 = 0x9E3779B1u;
+        static constexpr u32 XXH_PRIME32_2 = 0x85EBCA77u;
+        static constexpr u32 XXH_PRIME32_3 = 0xC2B2AE3Du;
+        static constexpr u32 XXH_PRIME32_4 = 0x27D4EB2Fu;
+        static constexpr u32 XXH_PRIME32_5 = 0x165667B1u;
+        static constexpr u64 XXH_PRIME64_1 = 0x9E3779B185EBCA87ull;
+        static constexpr u64 XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+        static constexpr u64 XXH_PRIME64_3 = 0x165667B19E3779F9ull;
+        static constexpr u64 XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+        static constexpr u64 XXH_PRIME64_5 = 0x27D4EB2F165667C5ull;
+
+        inline static constexpr u32 RotL32(u32 x, i32 r) {
+            return (x << r) | (x >> (32 - r));
+        }
+
+        inline static constexpr u64 RotL64(u64 x, i32 r) {
+            return (x << r) | (x >> (64 - r));
+        }
+
+        inline static constexpr u32 Read32(const char* str) {
+            return (u32)(u8)str[0] | ((u32)(u8)str[1] << 8) | ((u32)(u8)str[2] << 16) | ((u32)(u8)str[3] << 24);
+        }
+
+        inline static constexpr u64 Read64(const char* str) {
+            return (u64)Read32(str) | ((u64)Read32(str + 4) << 32);
+        }
+
+        inline static constexpr u32 XXHashRound(u32 acc, u32 input) {
+            acc += input * XXH_PRIME32_2;
+            acc = RotL32(acc, 13);
+            acc *= XXH_PRIME32_1;
+            return acc;
+        }
+
+        inline static constexpr u64 XXHash64Round(u64 acc, u64 input) {
+            acc += input * XXH_PRIME64_2;
+            acc = RotL64(acc, 31);
+            acc *= XXH_PRIME64_1;
+            return acc;
+        }
+
+        inline static constexpr u64 XXHash64Merge(u64 acc, u64 value) {
+            acc ^= XXHash64Round(0, value);
+            return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
         }
     };
 
+    static_assert(StringHash::XXHash32("", 0) == 0x02CC5D05u, "XXHash32 does not match the reference implementation");
+    static_assert(StringHash::XXHash32("abc", 3) == 0x32D153FFu, "XXHash32 does not match the reference implementation");
+    static_assert(StringHash::XXHash64("", 0) == 0xEF46DB3751D8E999ull, "XXHash64 does not match the reference implementation");
+    static_assert(StringHash::XXHash64("abc", 3) == 0x44BC2CF5AD770999ull, "XXHash64 does not match the reference implementation");
+
     template<u64 SizeBytes>
     class FixedStringBase
     {
@@ -299,7 +1265,7 @@ namespace atto
         void                                StripFileExtension();
         void                                StripFilePath();
         void                                BackSlashesToSlashes();
-        //TransientList<FixedStringBase>      Split(char delim) const;
+        TransientList<FixedStringBase>      Split(char delim) const;
 
         FixedStringBase<SizeBytes> &        operator=(const char* other);
 
@@ -662,37 +1628,37 @@ namespace atto
         }
     }
 
-    //template<u64 SizeBytes>
-    //TransientList<FixedStringBase<SizeBytes>> FixedStringBase<SizeBytes>::Split(char delim) const {
-    //    const i32 num = NumOf(delim) + 1;
-    //    TransientList<FixedStringBase<SizeBytes>> result(
-    //        num,
-    //        Memory::AllocateTransientStruct<FixedStringBase<SizeBytes>>(num)
-    //    );
-
-    //    i32 start = 0;
-    //    i32 end = 0;
-    //    const i32 len = GetLength();
-    //    for (; end < len; end++) {
-    //        if (data[end] == delim) {
-    //            if (start != end) {
-    //                result[result.count].CopyFrom(*this, start, end - 1);
-    //                result.count++;
-    //                start = end + 1;
-    //            }
-    //            else {
-    //                start++;
-    //            }
-    //        }
-    //    }
-
-    //    if (end != start) {
-    //        result[result.count].CopyFrom(*this, start, end - 1);
-    //        result.count++;
-    //    }
-
-    //    return result;
-    //}
+    template<u64 SizeBytes>
+    TransientList<FixedStringBase<SizeBytes>> FixedStringBase<SizeBytes>::Split(char delim) const {
+        const i32 num = NumOf(delim) + 1;
+        TransientList<FixedStringBase<SizeBytes>> result(
+            num,
+            Memory::AllocateTransientStruct<FixedStringBase<SizeBytes>>(num)
+        );
+
+        i32 start = 0;
+        i32 end = 0;
+        const i32 len = GetLength();
+        for (; end < len; end++) {
+            if (data[end] == delim) {
+                if (start != end) {
+                    result[result.count].CopyFrom(*this, start, end - 1);
+                    result.count++;
+                    start = end + 1;
+                }
+                else {
+                    start++;
+                }
+            }
+        }
+
+        if (end != start) {
+            result[result.count].CopyFrom(*this, start, end - 1);
+            result.count++;
+        }
+
+        return result;
+    }
 
     template<u64 SizeBytes>
     FixedStringBase<SizeBytes>& FixedStringBase<SizeBytes>::operator=(const char* other) {
@@ -761,4 +1727,34 @@ namespace atto
         static SmallString Small(const char* format, ...);
         static LargeString Large(const char* format, ...);
     };
+
+    struct StringAtomStats {
+        i32 atomCount;
+        u64 poolBytes;          // Bytes used by the pool, headers and terminators included
+        u64 poolCapacity;
+        u64 indexBytes;
+    };
+
+    // Interned string. Every distinct string is stored once in a global pool and the atom is its offset into that
+    // pool, so comparing two atoms is one integer compare. A zeroed atom is the empty string. The pool never moves,
+    // so GetCStr stays valid for the lifetime of the program. Interning is thread safe.
+    class StringAtom
+    {
+    public:
+        static StringAtom       Intern(const char* str);
+        static StringAtom       Intern(const char* str, i32 length);
+        // Sizes the index for count more strings, so a known batch of strings doesn't rehash as it goes.
+        static void             Reserve(i32 count);
+        static StringAtomStats  GetStats();
+
+        const char*             GetCStr() const;
+        i32                     GetLength() const;
+        bool                    IsEmpty() const;
+        bool                    EndsWith(const char* str) const;
+
+        inline bool             operator==(const StringAtom& other) const { return offset == other.offset; }
+        inline bool             operator!=(const StringAtom& other) const { return offset != other.offset; }
+
+        u32                     offset;
+    };
 }
\ No newline at end of file
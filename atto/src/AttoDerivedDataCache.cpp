@@ -0,0 +1,249 @@
+#include "AttoDerivedDataCache.h"
+#include "AttoAssetCooked.h"
+#include "AttoAssetImport.h"
+#include "AttoLib.h"
+
+#include <filesystem>
+
+namespace atto
+{
+    static constexpr const char* DERIVED_DATA_EXTENSION = ".ddc";
+
+    struct DerivedDataKey {
+        u64 sourceHash;
+        u64 extensionHash;
+        u32 type;
+        u32 cookFlags;
+        u32 importFlags;
+        u32 version;
+    };
+
+    static_assert(sizeof(DerivedDataKey) == 32, "DerivedDataKey is hashed as is, it must not have padding");
+
+    bool DerivedDataCache::Open(const char* cacheDirectory, u64 cacheCapacityBytes) {
+        Close();
+
+        std::error_code error;
+        std::filesystem::create_directories(cacheDirectory, error);
+        if (std::filesystem::is_directory(cacheDirectory, error) == false) {
+            ATTOERROR("DerivedDataCache::Open -> Could not create directory %s", cacheDirectory);
+            return false;
+        }
+
+        directory = LargeString::FromLiteral(cacheDirectory);
+        capacityBytes = cacheCapacityBytes;
+        isOpen = true;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        TrimLocked();
+
+        ATTOINFO("Derived data cache %s, %d files, %.2f of %.2f MB", cacheDirectory, stats.fileCount,
+            (f64)stats.sizeBytes / (1024.0 * 1024.0), (f64)capacityBytes / (1024.0 * 1024.0));
+
+        return true;
+    }
+
+    void DerivedDataCache::Close() {
+        if (isOpen) {
+            const DerivedDataStats closing = GetStats();
+            ATTOINFO("Derived data cache %s, %llu hits, %llu misses, %llu writes, %llu evicted", directory.GetCStr(),
+                closing.hitCount, closing.missCount, closing.writeCount, closing.evictionCount);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        isOpen = false;
+        stats = {};
+    }
+
+    u64 DerivedDataCache::MakeKey(AssetType type, const char* path, const byte* source, u64 sourceSizeBytes, u32 cookFlags) {
+        const char* extension = strrchr(path, '.');
+        if (extension == nullptr) {
+            extension = "";
+        }
+
+        DerivedDataKey key = {};
+        key.sourceHash = StringHash::XXHash64((const char*)source, sourceSizeBytes);
+        key.extensionHash = StringHash::XXHash64(extension, strlen(extension));
+        key.type = (u32)type;
+        key.cookFlags = cookFlags;
+        key.importFlags = type == ASSET_TYPE_MESH ? MeshImportGetFlags() : 0;
+        key.version = COOKED_ASSET_VERSION;
+
+        return StringHash::XXHash64((const char*)&key, sizeof(key));
+    }
+
+    bool DerivedDataCache::Get(u64 key, List<byte>& blob) {
+        if (isOpen == false) {
+            return false;
+        }
+
+        const LargeString path = GetPath(key);
+        FILE* file = fopen(path.GetCStr(), "rb");
+        bool hit = false;
+        if (file != nullptr) {
+            fseek(file, 0, SEEK_END);
+            const long sizeBytes = ftell(file);
+            fseek(file, 0, SEEK_SET);
+            if (sizeBytes > 0) {
+                blob.SetNum((i32)sizeBytes, false);
+                hit = fread(blob.GetData(), 1, (size_t)sizeBytes, file) == (size_t)sizeBytes;
+            }
+            fclose(file);
+        }
+
+        if (hit) {
+            // Write time is the recency Trim goes by.
+            std::error_code error;
+            std::filesystem::last_write_time(path.GetCStr(), std::filesystem::file_time_type::clock::now(), error);
+        }
+        else {
+            blob.Clear();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (hit) {
+            stats.hitCount++;
+        }
+        else {
+            stats.missCount++;
+        }
+
+        return hit;
+    }
+
+    bool DerivedDataCache::Put(u64 key, const void* data, u64 sizeBytes) {
+        if (isOpen == false || sizeBytes == 0) {
+            return false;
+        }
+
+        if (sizeBytes > capacityBytes) {
+            ATTOWARN("DerivedDataCache::Put -> %.2f MB is more than the whole cache, not stored", (f64)sizeBytes / (1024.0 * 1024.0));
+            return false;
+        }
+
+        const LargeString path = GetPath(key);
+        const LargeString tempPath = StringFormat::Large("%s.%u.tmp", path.GetCStr(), tempIndex.fetch_add(1, std::memory_order_relaxed));
+        FILE* file = fopen(tempPath.GetCStr(), "wb");
+        if (file == nullptr) {
+            ATTOERROR("DerivedDataCache::Put -> Could not open file %s", tempPath.GetCStr());
+            return false;
+        }
+
+        const bool written = fwrite(data, 1, (size_t)sizeBytes, file) == (size_t)sizeBytes;
+        const bool closed = fclose(file) == 0;
+
+        std::error_code error;
+        const bool replaced = std::filesystem::exists(path.GetCStr(), error);
+        if (written == false || closed == false) {
+            ATTOERROR("DerivedDataCache::Put -> Could not write %s", tempPath.GetCStr());
+            std::filesystem::remove(tempPath.GetCStr(), error);
+            return false;
+        }
+
+        std::filesystem::rename(tempPath.GetCStr(), path.GetCStr(), error);
+        if (error) {
+            ATTOERROR("DerivedDataCache::Put -> Could not rename %s, %s", tempPath.GetCStr(), error.message().c_str());
+            std::filesystem::remove(tempPath.GetCStr(), error);
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.writeCount++;
+        if (replaced == false) {
+            stats.sizeBytes += sizeBytes;
+            stats.fileCount++;
+        }
+
+        if (stats.sizeBytes > capacityBytes) {
+            TrimLocked();
+        }
+
+        return true;
+    }
+
+    void DerivedDataCache::Trim() {
+        if (isOpen == false) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        TrimLocked();
+    }
+
+    DerivedDataStats DerivedDataCache::GetStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+    LargeString DerivedDataCache::GetPath(u64 key) const {
+        return StringFormat::Large("%s/%016llx%s", directory.GetCStr(), (unsigned long long)key, DERIVED_DATA_EXTENSION);
+    }
+
+    void DerivedDataCache::TrimLocked() {
+        struct CacheFile {
+            std::filesystem::path               path;
+            std::filesystem::file_time_type     writeTime;
+            u64                                 sizeBytes;
+        };
+
+        // The directory is the index, sizes and recency come from the files themselves so there is nothing to
+        // get out of sync when a run is killed.
+        List<CacheFile> files;
+        u64 totalBytes = 0;
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory.GetCStr(), error)) {
+            if (entry.is_regular_file(error) == false) {
+                continue;
+            }
+
+            const std::filesystem::path& path = entry.path();
+            if (path.extension() == ".tmp") {
+                // Left behind by a Put that never finished. Another thread may be writing it right now, only old ones go.
+                const auto age = std::filesystem::file_time_type::clock::now() - entry.last_write_time(error);
+                if (!error && age > std::chrono::minutes(10)) {
+                    std::filesystem::remove(path, error);
+                }
+                continue;
+            }
+
+            if (path.extension() != DERIVED_DATA_EXTENSION) {
+                continue;
+            }
+
+            CacheFile file = {};
+            file.path = path;
+            file.writeTime = entry.last_write_time(error);
+            file.sizeBytes = (u64)entry.file_size(error);
+            if (error) {
+                continue;
+            }
+
+            totalBytes += file.sizeBytes;
+            files.Add(std::move(file));
+        }
+
+        files.IntroSort([](const CacheFile& a, const CacheFile& b) {
+            return a.writeTime < b.writeTime;
+        });
+
+        // Down to 90% once it overflows, so a full cache isn't scanned again on every Put.
+        const u64 targetBytes = totalBytes > capacityBytes ? capacityBytes - capacityBytes / 10 : totalBytes;
+        const i32 cacheFileCount = files.GetNum();
+        i32 fileCount = cacheFileCount;
+        for (i32 fileIndex = 0; fileIndex < cacheFileCount; fileIndex++) {
+            const CacheFile& file = files[fileIndex];
+            if (totalBytes <= targetBytes) {
+                break;
+            }
+
+            if (std::filesystem::remove(file.path, error)) {
+                totalBytes -= file.sizeBytes;
+                fileCount--;
+                stats.evictionCount++;
+            }
+        }
+
+        stats.sizeBytes = totalBytes;
+        stats.fileCount = fileCount;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "AttoAssetTypes.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace atto
+{
+    struct DerivedDataStats {
+        u64                 hitCount;
+        u64                 missCount;
+        u64                 writeCount;
+        u64                 evictionCount;
+        u64                 sizeBytes;
+        i32                 fileCount;
+    };
+
+    // Cooked blobs for sources that were imported at runtime, kept on disk so the next launch skips Assimp. One file
+    // per key in the cache directory. A hit bumps the file's write time, Trim deletes the oldest files first until
+    // the cache fits in its capacity. Safe to use from the job workers.
+    class DerivedDataCache {
+    public:
+        DerivedDataCache() = default;
+        DISABLE_COPY_AND_MOVE(DerivedDataCache);
+
+        bool                        Open(const char* directory, u64 capacityBytes);
+        void                        Close();
+        inline bool                 IsOpen() const { return isOpen; }
+
+        // Everything that changes the cooked result goes into the key: the source contents, its extension (which
+        // picks the importer and the import scale), the import and cook flags and COOKED_ASSET_VERSION.
+        static u64                  MakeKey(AssetType type, const char* path, const byte* source, u64 sourceSizeBytes, u32 cookFlags);
+
+        // Replaces blob with the cached data. False on a miss.
+        bool                        Get(u64 key, List<byte>& blob);
+        // Written to a temporary file that is renamed into place, readers never see half a blob. Trims when the
+        // cache grows past its capacity.
+        bool                        Put(u64 key, const void* data, u64 sizeBytes);
+        void                        Trim();
+
+        DerivedDataStats            GetStats() const;
+
+    private:
+        LargeString                 GetPath(u64 key) const;
+        // Must be called with mutex held.
+        void                        TrimLocked();
+
+        LargeString                 directory;
+        u64                         capacityBytes = 0;
+        bool                        isOpen = false;
+        std::atomic<u32>            tempIndex = 0;
+
+        mutable std::mutex          mutex;
+        DerivedDataStats            stats = {};
+    };
+}
@@ -1,8 +1,5 @@
 #include "AttoAsset.h"
 
-#define STB_TRUETYPE_IMPLEMENTATION
-#include <stb_truetype/stb_truetype.h>
-
 namespace atto
 {
     static const char*  basicFontShader = R"(
@@ -80,10 +77,19 @@ namespace atto
     }
 
     void LeEngine::FontCreate(FontAsset& font) {
-        i32 fileSize = 0;
-        byte* tff = LoadEntireFile(font.path.GetCStr(), fileSize);
-        //byte* tff = LoadEntireFile("C:/Windows/Fonts/Arial.ttf", fileSize);
-        //byte* tff = LoadEntireFile("C:/Projects/Atto - G2/bin/assets/fonts/Roboto_Regular.ttf", fileSize);
+        // stbtt keeps pointing at the font data, packed fonts use the mapping which lives as long as the engine,
+        // or font.payload when the pack entry is compressed. Loose fonts keep their file open in font.file.
+        const AssetPackEntry* packed = assetPack.Find(font.id);
+        const byte* packedData = packed != nullptr ? assetPack.GetPayload(*packed, font.payload) : nullptr;
+        CookedFont cooked = {};
+        const bool isCooked = packedData != nullptr && CookedFontRead(packedData, packed->sizeBytes, cooked);
+
+        const byte* tff = isCooked ? cooked.ttf : packedData;
+        if (tff == nullptr) {
+            files.Close(font.file);
+            font.file = files.Open(font.path.GetCStr());
+            tff = files.GetData(font.file);
+        }
 
         if (tff == nullptr) {
             return;
@@ -92,11 +98,21 @@ namespace atto
         if (stbtt_InitFont(&font.info, tff, 0) == 0) {
             ATTOERROR("Could not init font");
         }
-        
-        stbtt_GetFontVMetrics(&font.info, &font.ascent, &font.descent, &font.lineGap);
 
-        byte* pixels = new byte[256 * 256];
-        stbtt_BakeFontBitmap(tff, 0, font.fontSize, pixels, 256, 256, 32, 96, font.chardata.GetData());
+        ScratchScope scratch;
+        const byte* pixels = nullptr;
+        if (isCooked && cooked.header->fontSize == font.fontSize) {
+            memcpy(font.chardata.GetData(), cooked.chardata, sizeof(stbtt_bakedchar) * FONT_CHAR_COUNT);
+            font.ascent = cooked.header->ascent;
+            font.descent = cooked.header->descent;
+            font.lineGap = cooked.header->lineGap;
+            pixels = cooked.atlas;
+        }
+        else {
+            byte* atlas = Memory::AllocateScratchStruct<byte>(FONT_ATLAS_SIZE * FONT_ATLAS_SIZE);
+            FontImportBake(tff, font.fontSize, atlas, font.chardata.GetData(), font.ascent, font.descent, font.lineGap);
+            pixels = atlas;
+        }
 
         D3D11_TEXTURE2D_DESC textureDesc = {};
         textureDesc.Width = 256;
@@ -132,8 +148,6 @@ namespace atto
         }
 
         font.isLoaded = true;
-
-        delete[] pixels;
     }
 
     f32 LeEngine::FontWidth(FontAsset* font, const char* text) {
@@ -216,7 +230,7 @@ namespace atto
     }
     
     void LeEngine::FontRenderText(const char* text, FontAssetId fontId, glm::vec2 pos, glm::vec4 color) {
-        FontAsset* font = FindAsset(fontAssets, fontId.ToRawId());
+        FontAsset* font = FindAsset(fontAssets, fontAssetLookup, fontId.ToRawId());
         if (font == nullptr) {
             ATTOERROR("Could not find font asset");
             return;
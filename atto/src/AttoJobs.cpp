@@ -0,0 +1,176 @@
+#include "AttoJobs.h"
+#include "AttoLib.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace atto
+{
+    struct Job {
+        JobFunc         func;
+        void*           userData;
+        JobCounter*     counter;
+        i32             index;
+    };
+
+    static constexpr i32        JOB_QUEUE_CAPCITY = 4096;
+
+    static std::mutex               jobMutex;
+    static std::condition_variable  jobAvailable;
+    static Job                      jobQueue[JOB_QUEUE_CAPCITY];
+    static i32                      jobQueueHead = 0;
+    static i32                      jobQueueCount = 0;
+    static bool                     jobsShuttingDown = false;
+    static std::vector<std::thread> jobWorkers;
+
+    static void JobRun(const Job& job) {
+        job.func(job.index, job.userData);
+        if (job.counter != nullptr) {
+            job.counter->value.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    // Must be called with jobMutex held.
+    static Job JobPop() {
+        Job job = jobQueue[jobQueueHead];
+        jobQueueHead = (jobQueueHead + 1) % JOB_QUEUE_CAPCITY;
+        jobQueueCount--;
+
+        return job;
+    }
+
+    // Must be called with jobMutex held. Only the waiter's own jobs, running whatever is queued would nest
+    // unrelated work on the waiter's stack with no bound. Searches from the newest job, nested jobs were submitted last.
+    static bool JobPopForCounter(const JobCounter* counter, Job& job) {
+        for (i32 offset = jobQueueCount - 1; offset >= 0; offset--) {
+            const i32 slot = (jobQueueHead + offset) % JOB_QUEUE_CAPCITY;
+            if (jobQueue[slot].counter != counter) {
+                continue;
+            }
+
+            job = jobQueue[slot];
+            for (i32 next = offset + 1; next < jobQueueCount; next++) {
+                jobQueue[(jobQueueHead + next - 1) % JOB_QUEUE_CAPCITY] = jobQueue[(jobQueueHead + next) % JOB_QUEUE_CAPCITY];
+            }
+            jobQueueCount--;
+
+            return true;
+        }
+
+        return false;
+    }
+
+    static void JobWorkerMain() {
+        for (;;) {
+            Job job = {};
+            {
+                std::unique_lock<std::mutex> lock(jobMutex);
+                jobAvailable.wait(lock, [] { return jobQueueCount > 0 || jobsShuttingDown; });
+                if (jobQueueCount == 0) {
+                    return;
+                }
+                job = JobPop();
+            }
+
+            JobRun(job);
+        }
+    }
+
+    void Jobs::Initialize(i32 workerCount) {
+        Assert(jobWorkers.empty(), "Jobs already initialized");
+
+        if (workerCount < 0) {
+            const i32 hardwareThreads = (i32)std::thread::hardware_concurrency();
+            workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+        }
+
+        jobsShuttingDown = false;
+        jobWorkers.reserve(workerCount);
+        for (i32 workerIndex = 0; workerIndex < workerCount; workerIndex++) {
+            jobWorkers.emplace_back(JobWorkerMain);
+        }
+
+        ATTOINFO("Job system started with %d workers", workerCount);
+    }
+
+    void Jobs::Shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            jobsShuttingDown = true;
+        }
+        jobAvailable.notify_all();
+
+        for (std::thread& worker : jobWorkers) {
+            worker.join();
+        }
+        jobWorkers.clear();
+    }
+
+    i32 Jobs::GetWorkerCount() {
+        return (i32)jobWorkers.size();
+    }
+
+    void Jobs::Submit(JobFunc func, void* userData, JobCounter* counter, i32 index) {
+        Job job = {};
+        job.func = func;
+        job.userData = userData;
+        job.counter = counter;
+        job.index = index;
+
+        if (counter != nullptr) {
+            counter->value.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (jobWorkers.empty()) {
+            JobRun(job);
+            return;
+        }
+
+        bool queued = false;
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            if (jobQueueCount < JOB_QUEUE_CAPCITY) {
+                jobQueue[(jobQueueHead + jobQueueCount) % JOB_QUEUE_CAPCITY] = job;
+                jobQueueCount++;
+                queued = true;
+            }
+        }
+
+        if (queued == false) {
+            // Queue is full. Blocking here could wait on workers that are themselves stuck submitting nested jobs,
+            // running it is progress either way.
+            JobRun(job);
+            return;
+        }
+        jobAvailable.notify_one();
+    }
+
+    void Jobs::Wait(JobCounter* counter) {
+        while (counter->value.load(std::memory_order_acquire) > 0) {
+            Job job = {};
+            bool hasJob = false;
+            {
+                std::lock_guard<std::mutex> lock(jobMutex);
+                hasJob = JobPopForCounter(counter, job);
+            }
+
+            if (hasJob) {
+                JobRun(job);
+            }
+            else {
+                // Everything left is already running on a worker.
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void Jobs::ParallelFor(i32 count, JobFunc func, void* userData) {
+        JobCounter counter;
+        for (i32 index = 0; index < count; index++) {
+            Submit(func, userData, &counter, index);
+        }
+        Wait(&counter);
+    }
+}
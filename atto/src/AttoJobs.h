@@ -0,0 +1,33 @@
+#pragma once
+
+#include "AttoDefines.h"
+
+#include <atomic>
+
+namespace atto
+{
+    typedef void (*JobFunc)(i32 index, void* userData);
+
+    // Counts outstanding jobs, Wait on it to block until every job submitted with it has finished.
+    struct JobCounter {
+        std::atomic<i32> value = 0;
+    };
+
+    // Fixed pool of worker threads pulling from one shared queue. Threads that wait on a counter run that
+    // counter's queued jobs while they wait, so nested ParallelFor makes progress from inside a job. Without workers
+    // (Initialize was never called, or called with 0) or with the queue full, jobs run inline.
+    class Jobs
+    {
+    public:
+        // workerCount < 0 picks one worker per hardware thread, minus the main thread.
+        static void             Initialize(i32 workerCount = -1);
+        static void             Shutdown();
+        static i32              GetWorkerCount();
+
+        static void             Submit(JobFunc func, void* userData, JobCounter* counter, i32 index = 0);
+        static void             Wait(JobCounter* counter);
+
+        // Runs func once for every index in [0, count) and returns when all of them are done.
+        static void             ParallelFor(i32 count, JobFunc func, void* userData);
+    };
+}
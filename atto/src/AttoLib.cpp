@@ -1,6 +1,7 @@
 #include "AttoLib.h"
 
 #include "AttoAsset.h"
+#include "AttoJobs.h"
 
 #include <GLFW/glfw3.h>
 
@@ -12,53 +13,6 @@
 
 namespace atto
 {
-    static void StringFormatV(char* dest, size_t size, const char* format, va_list va_listp)
-    {
-        vsnprintf(dest, size, format, va_listp);
-    }
-
-    static void StringFormat(char* dest, size_t size, const char* format, ...)
-    {
-        va_list arg_ptr;
-        va_start(arg_ptr, format);
-        StringFormatV(dest, size, format, arg_ptr);
-        va_end(arg_ptr);
-    }
-
-    Logger::Logger() {
-        Assert(instance == nullptr, "Logger already exists!");
-        instance = this;
-    }
-
-    Logger::~Logger() {
-
-    }
-
-    void Logger::LogOutput(LogLevel level, const char* message, ...) {
-        const char* levelStrings[6] = { "[FATAL]: ", "[ERROR]: ", "[WARN]:  ", "[INFO]:  ", "[DEBUG]: ", "[TRACE]: " };
-        const char* header = levelStrings[(u32)level];
-
-        memset(instance->logBuffer, 0, sizeof(instance->logBuffer));
-        memset(instance->outputBuffer, 0, sizeof(instance->outputBuffer));
-
-        va_list arg_ptr;
-        va_start(arg_ptr, message);
-        StringFormatV(instance->logBuffer, sizeof(instance->logBuffer), message, arg_ptr);
-        va_end(arg_ptr);
-
-        StringFormat(instance->outputBuffer, sizeof(outputBuffer), "%s%s\n", header, instance->logBuffer);
-
-        if (strlen(instance->outputBuffer) < LargeString::CAPCITY) {
-            instance->logs.Add( LargeString::FromLiteral( instance->outputBuffer) );
-        }
-
-        Application::ConsoleWrite(instance->outputBuffer, (u8)level);
-
-        if (level == LogLevel::FATAL) {
-            Application::DisplayFatalError(message);
-        }
-    }
-
     static void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
         AppState* app = (AppState* )glfwGetWindowUserPointer(window);
         FrameInput* input = app->input;
@@ -130,6 +84,9 @@ namespace atto
         app.logger  = new Logger();
         app.input   = new FrameInput();
 
+        Memory::Initialize(Megabytes(32), Megabytes(64));
+        Jobs::Initialize();
+
         if (!glfwInit()) {
             ATTOFATAL("Could not init GLFW, your windows is f*cked");
             return false;
@@ -182,6 +139,8 @@ namespace atto
         delete app.engine;
         glfwDestroyWindow(app.window);
         glfwTerminate();
+        Jobs::Shutdown();
+        Memory::Shutdown();
     }
 
     bool Application::AppIsRunning(AppState& app) {
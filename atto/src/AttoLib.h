@@ -43,7 +43,7 @@ namespace atto
 
         char                            logBuffer[LOG_BUFFER_SIZE] = {};
         char                            outputBuffer[LOG_BUFFER_SIZE] = {};
-        FixedList<LargeString, 10000>   logs = {};
+        FixedStorageList<LargeString, 10000> logs = {};
     };
 
     struct AppState {
@@ -65,7 +65,20 @@ namespace atto
         bool                        windowFullscreen = false;
         bool                        shouldClose = false;
         bool                        useLooseAssets = false;
+        bool                        useParallelAssetScan = true;
+        bool                        useAssetManifest = true;
+        bool                        buildAssetPack = false;
+        bool                        useAsyncMeshLoading = true;
+        // Time Render may spend per frame creating buffers for meshes that finished loading, at least one is always done.
+        f32                         meshUploadBudgetMS = 2.0f;
+        // Unreferenced assets are evicted, least recently used first, while loaded assets take more than this.
+        u64                         assetMemoryBudgetBytes = Megabytes(512);
+        // Meshes imported at runtime are cooked once and kept here, the least recently used go past the size cap.
+        bool                        useDerivedDataCache = true;
+        u64                         derivedDataCacheBytes = Megabytes(1024);
+        LargeString                 derivedDataCachePath = LargeString::FromLiteral("derived_data");
         LargeString                 looseAssetPath = LargeString::FromLiteral("assets/");
+        LargeString                 assetPackPath = LargeString::FromLiteral("assets.pack");
     };
 
     class GameState {
@@ -1,6 +1,12 @@
 #pragma once
 
 #include "AttoDefines.h"
+#include "AttoSort.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include <utility>
 
 namespace atto
 {
@@ -30,6 +36,7 @@ namespace atto
 
 		List(i32 newgranularity = 16);
 		List(const List<type>& other);
+		List(List<type>&& other);
 		~List<type>(void);
 
 		void			Clear(void);									// clear the list
@@ -43,6 +50,7 @@ namespace atto
 		size_t			MemoryUsed(void) const;							// returns size of the used elements in the list
 
 		List<type>& operator=(const List<type>& other);
+		List<type>& operator=(List<type>&& other);
 		const type& operator[](i32 index) const;
 		type& operator[](i32 index);
 
@@ -53,11 +61,15 @@ namespace atto
 		void			AssureSize(i32 newSize);						// assure list has given number of elements, but leave them uninitialized
 		void			AssureSize(i32 newSize, const type& initValue);	// assure list has given number of elements and initialize any new elements
 		void			AssureSizeAlloc(i32 newSize, new_t* allocator);	// assure the pointer list has the given number of elements and allocate any new elements
+		void			Reserve(i32 newSize);							// make room for at least the given number of elements without changing the count
 
 		type* GetData(void);									// returns a pointer to the list
 		const type* GetData(void) const;							// returns a pointer to the list
 		type& Alloc(void);									// returns reference to a new data element at the end of the list
 		i32				Add(const type& obj);						// append element
+		i32				Add(type&& obj);							// append element, moving it in
+		template<typename... _args_>
+		type&			Emplace(_args_&&... args);						// construct a new element at the end of the list
 		i32				Add(const List<type>& other);		// append list
 		i32				AddUnique(const type& obj);						// add unique element
 		i32				Insert(const type& obj, i32 index = 0);			// insert the element at the given index
@@ -71,16 +83,82 @@ namespace atto
 
 		void			Sort(cmp_t* compare = (cmp_t*)&ListSortCompare<type>);
 		void			SortSubSection(i32 startIndex, i32 endIndex, cmp_t* compare = (cmp_t*)&ListSortCompare<type>);
+		template<typename _less_ = SortLess>
+		void			IntroSort(_less_ less = _less_());				// unstable sort with an inlined less-than comparator
+		template<typename _less_ = SortLess>
+		void			StableSort(_less_ less = _less_());				// stable merge sort with an inlined less-than comparator
+		template<typename _key_>
+		void			RadixSort(_key_ getKey);						// stable radix sort on a u32/u64 key per element
 		void			Swap(List<type>& other);				// swap the contents of the lists
 		void			DeleteContents(bool clear);						// delete the contents of the list
 
 	private:
+		// Trivial types live in malloc'd memory so they can be grown with realloc and copied with memcpy.
+		static constexpr bool isTrivial = std::is_trivial<type>::value;
+
+		static type*	AllocateElements(i32 count);
+		static void		FreeElements(type* elements);
+		void			Grow(i32 minSize);								// geometric growth to at least the given number of elements
+
 		i32				num;
 		i32				size;
 		i32				granularity;
 		type* list;
 	};
 
+	/*
+	================
+	idList<type>::AllocateElements
+	================
+	*/
+	template< class type >
+	inline type* List<type>::AllocateElements(i32 count) {
+		if constexpr (isTrivial) {
+			return (type*)malloc(count * sizeof(type));
+		}
+		else {
+			return new type[count];
+		}
+	}
+
+	/*
+	================
+	idList<type>::FreeElements
+	================
+	*/
+	template< class type >
+	inline void List<type>::FreeElements(type* elements) {
+		if constexpr (isTrivial) {
+			free(elements);
+		}
+		else {
+			delete[] elements;
+		}
+	}
+
+	/*
+	================
+	idList<type>::Grow
+
+	Grows the list by doubling its size, rounded up to the granularity, so appending N elements costs O(N) copies in total.
+	================
+	*/
+	template< class type >
+	inline void List<type>::Grow(i32 minSize) {
+		if (granularity == 0) {	// this is a hack to fix our memset classes
+			granularity = 16;
+		}
+
+		i32 newsize = size * 2;
+		if (newsize < minSize) {
+			newsize = minSize;
+		}
+
+		newsize += granularity - 1;
+		newsize -= newsize % granularity;
+		Resize(newsize);
+	}
+
 	/*
 	================
 	idList<type>::idList( i32 )
@@ -106,6 +184,23 @@ namespace atto
 		*this = other;
 	}
 
+	/*
+	================
+	idList<type>::idList( idList<type> &&other )
+	================
+	*/
+	template< class type >
+	inline List<type>::List(List<type>&& other) {
+		list = other.list;
+		num = other.num;
+		size = other.size;
+		granularity = other.granularity;
+
+		other.list = nullptr;
+		other.num = 0;
+		other.size = 0;
+	}
+
 	/*
 	================
 	idList<type>::~idList<type>
@@ -126,7 +221,7 @@ namespace atto
 	template< class type >
 	inline void List<type>::Clear(void) {
 		if (list) {
-			delete[] list;
+			FreeElements(list);
 		}
 
 		list = nullptr;
@@ -298,13 +393,12 @@ namespace atto
 	idList<type>::Resize
 
 	Allocates memory for the amount of elements requested while keeping the contents intact.
-	Contents are copied using their = operator so that data is correnctly instantiated.
+	Trivial types are grown in place with realloc, everything else is moved using the = operator.
 	================
 	*/
 	template< class type >
 	inline void List<type>::Resize(i32 newsize) {
 		type* temp;
-		i32		i;
 
 		Assert(newsize >= 0, "");
 
@@ -319,21 +413,28 @@ namespace atto
 			return;
 		}
 
-		temp = list;
 		size = newsize;
 		if (size < num) {
 			num = size;
 		}
 
-		// copy the old list into our new one
-		list = new type[size];
-		for (i = 0; i < num; i++) {
-			list[i] = temp[i];
+		if constexpr (isTrivial) {
+			temp = (type*)realloc(list, size * sizeof(type));
+			Assert(temp != nullptr, "List, out of memory");
+			list = temp;
 		}
+		else {
+			// move the old list into our new one
+			temp = list;
+			list = new type[size];
+			for (i32 i = 0; i < num; i++) {
+				list[i] = std::move(temp[i]);
+			}
 
-		// delete the old list if it exists
-		if (temp) {
-			delete[] temp;
+			// delete the old list if it exists
+			if (temp) {
+				delete[] temp;
+			}
 		}
 	}
 
@@ -342,41 +443,16 @@ namespace atto
 	idList<type>::Resize
 
 	Allocates memory for the amount of elements requested while keeping the contents intact.
-	Contents are copied using their = operator so that data is correnctly instantiated.
 	================
 	*/
 	template< class type >
 	inline void List<type>::Resize(i32 newsize, i32 newgranularity) {
-		type* temp;
-		i32		i;
-
 		assert(newsize >= 0);
 
 		assert(newgranularity > 0);
 		granularity = newgranularity;
 
-		// free up the list if no data is being reserved
-		if (newsize <= 0) {
-			Clear();
-			return;
-		}
-
-		temp = list;
-		size = newsize;
-		if (size < num) {
-			num = size;
-		}
-
-		// copy the old list into our new one
-		list = new type[size];
-		for (i = 0; i < num; i++) {
-			list[i] = temp[i];
-		}
-
-		// delete the old list if it exists
-		if (temp) {
-			delete[] temp;
-		}
+		Resize(newsize);
 	}
 
 	/*
@@ -391,14 +467,7 @@ namespace atto
 		i32 newNum = newSize;
 
 		if (newSize > size) {
-
-			if (granularity == 0) {	// this is a hack to fix our memset classes
-				granularity = 16;
-			}
-
-			newSize += granularity - 1;
-			newSize -= newSize % granularity;
-			Resize(newSize);
+			Grow(newSize);
 		}
 
 		num = newNum;
@@ -416,15 +485,9 @@ namespace atto
 		i32 newNum = newSize;
 
 		if (newSize > size) {
-
-			if (granularity == 0) {	// this is a hack to fix our memset classes
-				granularity = 16;
-			}
-
-			newSize += granularity - 1;
-			newSize -= newSize % granularity;
 			num = size;
-			Resize(newSize);
+			Grow(newSize);
+			newSize = size;
 
 			for (i32 i = num; i < newSize; i++) {
 				list[i] = initValue;
@@ -449,15 +512,9 @@ namespace atto
 		i32 newNum = newSize;
 
 		if (newSize > size) {
-
-			if (granularity == 0) {	// this is a hack to fix our memset classes
-				granularity = 16;
-			}
-
-			newSize += granularity - 1;
-			newSize -= newSize % granularity;
 			num = size;
-			Resize(newSize);
+			Grow(newSize);
+			newSize = size;
 
 			for (i32 i = num; i < newSize; i++) {
 				list[i] = (*allocator)();
@@ -467,6 +524,20 @@ namespace atto
 		num = newNum;
 	}
 
+	/*
+	================
+	idList<type>::Reserve
+
+	Makes sure there is room for at least the given number of elements, the number of elements in the list is unchanged.
+	================
+	*/
+	template< class type >
+	inline void List<type>::Reserve(i32 newSize) {
+		if (newSize > size) {
+			Resize(newSize);
+		}
+	}
+
 	/*
 	================
 	idList<type>::operator=
@@ -476,7 +547,9 @@ namespace atto
 	*/
 	template< class type >
 	inline List<type>& List<type>::operator=(const List<type>& other) {
-		i32	i;
+		if (this == &other) {
+			return *this;
+		}
 
 		Clear();
 
@@ -485,15 +558,47 @@ namespace atto
 		granularity = other.granularity;
 
 		if (size) {
-			list = new type[size];
-			for (i = 0; i < num; i++) {
-				list[i] = other.list[i];
+			list = AllocateElements(size);
+			if constexpr (isTrivial) {
+				memcpy(list, other.list, num * sizeof(type));
+			}
+			else {
+				for (i32 i = 0; i < num; i++) {
+					list[i] = other.list[i];
+				}
 			}
 		}
 
 		return *this;
 	}
 
+	/*
+	================
+	idList<type>::operator=
+
+	Takes ownership of the contents of another list, leaving it empty.
+	================
+	*/
+	template< class type >
+	inline List<type>& List<type>::operator=(List<type>&& other) {
+		if (this == &other) {
+			return *this;
+		}
+
+		Clear();
+
+		list = other.list;
+		num = other.num;
+		size = other.size;
+		granularity = other.granularity;
+
+		other.list = nullptr;
+		other.num = 0;
+		other.size = 0;
+
+		return *this;
+	}
+
 	/*
 	================
 	idList<type>::operator[] const
@@ -567,12 +672,8 @@ namespace atto
 	*/
 	template< class type >
 	inline type& List<type>::Alloc(void) {
-		if (!list) {
-			Resize(granularity);
-		}
-
 		if (num == size) {
-			Resize(size + granularity);
+			Grow(num + 1);
 		}
 
 		return list[num++];
@@ -589,26 +690,67 @@ namespace atto
 	*/
 	template< class type >
 	inline i32 List<type>::Add(type const& obj) {
-		if (!list) {
-			Resize(granularity);
+		if (num == size) {
+			// obj might live inside this list, so copy it out before the memory moves
+			type copy = obj;
+			Grow(num + 1);
+			list[num] = std::move(copy);
+		}
+		else {
+			list[num] = obj;
 		}
 
-		if (num == size) {
-			i32 newsize;
+		num++;
 
-			if (granularity == 0) {	// this is a hack to fix our memset classes
-				granularity = 16;
-			}
-			newsize = size + granularity;
-			Resize(newsize - newsize % granularity);
+		return num - 1;
+	}
+
+	/*
+	================
+	idList<type>::Append
+
+	Increases the size of the list by one element and moves the supplied data into it.
+
+	Returns the index of the new element.
+	================
+	*/
+	template< class type >
+	inline i32 List<type>::Add(type&& obj) {
+		if (num == size) {
+			type moved = std::move(obj);
+			Grow(num + 1);
+			list[num] = std::move(moved);
+		}
+		else {
+			list[num] = std::move(obj);
 		}
 
-		list[num] = obj;
 		num++;
 
 		return num - 1;
 	}
 
+	/*
+	================
+	idList<type>::Emplace
+
+	Constructs a new element at the end of the list from the given arguments and returns a reference to it.
+	================
+	*/
+	template< class type >
+	template< typename... _args_ >
+	inline type& List<type>::Emplace(_args_&&... args) {
+		// Built before Grow, the arguments may point into the old buffer.
+		type value(std::forward<_args_>(args)...);
+		if (num == size) {
+			Grow(num + 1);
+		}
+
+		list[num] = std::move(value);
+
+		return list[num++];
+	}
+
 
 	/*
 	================
@@ -622,18 +764,9 @@ namespace atto
 	*/
 	template< class type >
 	inline i32 List<type>::Insert(type const& obj, i32 index) {
-		if (!list) {
-			Resize(granularity);
-		}
-
+		type copy = obj;
 		if (num == size) {
-			i32 newsize;
-
-			if (granularity == 0) {	// this is a hack to fix our memset classes
-				granularity = 16;
-			}
-			newsize = size + granularity;
-			Resize(newsize - newsize % granularity);
+			Grow(num + 1);
 		}
 
 		if (index < 0) {
@@ -642,11 +775,18 @@ namespace atto
 		else if (index > num) {
 			index = num;
 		}
-		for (i32 i = num; i > index; --i) {
-			list[i] = list[i - 1];
+
+		if constexpr (isTrivial) {
+			memmove(list + index + 1, list + index, (num - index) * sizeof(type));
 		}
+		else {
+			for (i32 i = num; i > index; --i) {
+				list[i] = std::move(list[i - 1]);
+			}
+		}
+
 		num++;
-		list[index] = obj;
+		list[index] = std::move(copy);
 		return index;
 	}
 
@@ -661,16 +801,19 @@ namespace atto
 	*/
 	template< class type >
 	inline i32 List<type>::Add(const List<type>& other) {
-		if (!list) {
-			if (granularity == 0) {	// this is a hack to fix our memset classes
-				granularity = 16;
-			}
-			Resize(granularity);
+		i32 n = other.GetNum();
+		if (num + n > size) {
+			Grow(num + n);
 		}
 
-		i32 n = other.GetNum();
-		for (i32 i = 0; i < n; i++) {
-			Add(other[i]);
+		if constexpr (isTrivial) {
+			memcpy(list + num, other.list, n * sizeof(type));
+			num += n;
+		}
+		else {
+			for (i32 i = 0; i < n; i++) {
+				list[num++] = other.list[i];
+			}
 		}
 
 		return GetNum();
@@ -792,8 +935,6 @@ namespace atto
 	*/
 	template< class type >
 	inline bool List<type>::RemoveIndex(i32 index) {
-		i32 i;
-
 		assert(list != NULL);
 		assert(index >= 0);
 		assert(index < num);
@@ -803,8 +944,13 @@ namespace atto
 		}
 
 		num--;
-		for (i = index; i < num; i++) {
-			list[i] = list[i + 1];
+		if constexpr (isTrivial) {
+			memmove(list + index, list + index + 1, (num - index) * sizeof(type));
+		}
+		else {
+			for (i32 i = index; i < num; i++) {
+				list[i] = std::move(list[i + 1]);
+			}
 		}
 
 		return true;
@@ -835,8 +981,9 @@ namespace atto
 	================
 	idList<type>::Sort
 
-	Performs a qsort on the list using the supplied comparison function.  Note that the data is merely moved around the
-	list, so any pointers to data within the list may no longer be valid.
+	Sorts the list using the supplied comparison function.  Note that the data is merely moved around the
+	list, so any pointers to data within the list may no longer be valid.  The comparison is still called through
+	a function pointer, use IntroSort with a functor or lambda in hot code.
 	================
 	*/
 	template< class type >
@@ -844,10 +991,8 @@ namespace atto
 		if (!list) {
 			return;
 		}
-		typedef i32 cmp_c(const void*, const void*);
 
-		cmp_c* vCompare = (cmp_c*)compare;
-		qsort((void*)list, (size_t)num, sizeof(type), vCompare);
+		atto::IntroSort(list, num, [compare](const type& a, const type& b) { return compare(&a, &b) < 0; });
 	}
 
 	/*
@@ -871,10 +1016,53 @@ namespace atto
 		if (startIndex >= endIndex) {
 			return;
 		}
-		typedef i32 cmp_c(const void*, const void*);
 
-		cmp_c* vCompare = (cmp_c*)compare;
-		qsort((void*)(&list[startIndex]), (size_t)(endIndex - startIndex + 1), sizeof(type), vCompare);
+		atto::IntroSort(&list[startIndex], endIndex - startIndex + 1, [compare](const type& a, const type& b) { return compare(&a, &b) < 0; });
+	}
+
+	/*
+	================
+	idList<type>::IntroSort
+	================
+	*/
+	template< class type >
+	template< typename _less_ >
+	inline void List<type>::IntroSort(_less_ less) {
+		if (!list) {
+			return;
+		}
+
+		atto::IntroSort(list, num, less);
+	}
+
+	/*
+	================
+	idList<type>::StableSort
+	================
+	*/
+	template< class type >
+	template< typename _less_ >
+	inline void List<type>::StableSort(_less_ less) {
+		if (!list) {
+			return;
+		}
+
+		atto::StableSort(list, num, less);
+	}
+
+	/*
+	================
+	idList<type>::RadixSort
+	================
+	*/
+	template< class type >
+	template< typename _key_ >
+	inline void List<type>::RadixSort(_key_ getKey) {
+		if (!list) {
+			return;
+		}
+
+		atto::RadixSort(list, num, getKey);
 	}
 
 	/*
@@ -0,0 +1,59 @@
+#include "AttoLib.h"
+
+#include <mutex>
+#include <stdarg.h>
+
+namespace atto
+{
+    static std::mutex logMutex;
+
+    static void StringFormatV(char* dest, size_t size, const char* format, va_list va_listp)
+    {
+        vsnprintf(dest, size, format, va_listp);
+    }
+
+    static void StringFormat(char* dest, size_t size, const char* format, ...)
+    {
+        va_list arg_ptr;
+        va_start(arg_ptr, format);
+        StringFormatV(dest, size, format, arg_ptr);
+        va_end(arg_ptr);
+    }
+
+    Logger::Logger() {
+        Assert(instance == nullptr, "Logger already exists!");
+        instance = this;
+    }
+
+    Logger::~Logger() {
+
+    }
+
+    void Logger::LogOutput(LogLevel level, const char* message, ...) {
+        // Jobs log from worker threads, the buffers and the console are shared.
+        std::lock_guard<std::mutex> lock(logMutex);
+
+        const char* levelStrings[6] = { "[FATAL]: ", "[ERROR]: ", "[WARN]:  ", "[INFO]:  ", "[DEBUG]: ", "[TRACE]: " };
+        const char* header = levelStrings[(u32)level];
+
+        memset(instance->logBuffer, 0, sizeof(instance->logBuffer));
+        memset(instance->outputBuffer, 0, sizeof(instance->outputBuffer));
+
+        va_list arg_ptr;
+        va_start(arg_ptr, message);
+        StringFormatV(instance->logBuffer, sizeof(instance->logBuffer), message, arg_ptr);
+        va_end(arg_ptr);
+
+        StringFormat(instance->outputBuffer, sizeof(outputBuffer), "%s%s\n", header, instance->logBuffer);
+
+        if (strlen(instance->outputBuffer) < LargeString::CAPCITY) {
+            instance->logs.AddIfPossible( LargeString::FromLiteral( instance->outputBuffer) );
+        }
+
+        Application::ConsoleWrite(instance->outputBuffer, (u8)level);
+
+        if (level == LogLevel::FATAL) {
+            Application::DisplayFatalError(message);
+        }
+    }
+}
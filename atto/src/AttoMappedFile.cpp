@@ -0,0 +1,273 @@
+#include "AttoMappedFile.h"
+#include "AttoLib.h"
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace atto
+{
+    // Empty files can't be mapped, their views all point here so data is never null for an open view.
+    static const byte FILE_VIEW_EMPTY[1] = {};
+
+    static void FileViewSetEmpty(FileView& view) {
+        view = {};
+        view.data = FILE_VIEW_EMPTY;
+    }
+
+#if _WIN32
+    static bool FileViewMap(const char* path, FileView& view, bool& openFailed) {
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            openFailed = true;
+            return false;
+        }
+
+        LARGE_INTEGER fileSize = {};
+        if (GetFileSizeEx(file, &fileSize) == FALSE) {
+            CloseHandle(file);
+            return false;
+        }
+
+        if (fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            FileViewSetEmpty(view);
+            return true;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) {
+            CloseHandle(file);
+            return false;
+        }
+
+        const void* mapped = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (mapped == nullptr) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        view.fileHandle = file;
+        view.mappingHandle = mapping;
+        view.data = (const byte*)mapped;
+        view.size = (u64)fileSize.QuadPart;
+        view.isMapped = true;
+
+        return true;
+    }
+
+    static void FileViewUnmap(FileView& view) {
+        UnmapViewOfFile(view.data);
+        if (view.mappingHandle != nullptr) {
+            CloseHandle(view.mappingHandle);
+        }
+        if (view.fileHandle != nullptr) {
+            CloseHandle(view.fileHandle);
+        }
+    }
+#else
+    static bool FileViewMap(const char* path, FileView& view, bool& openFailed) {
+        const int file = open(path, O_RDONLY);
+        if (file < 0) {
+            openFailed = true;
+            return false;
+        }
+
+        struct stat fileStat = {};
+        if (fstat(file, &fileStat) != 0 || S_ISREG(fileStat.st_mode) == false) {
+            close(file);
+            return false;
+        }
+
+        if (fileStat.st_size == 0) {
+            close(file);
+            FileViewSetEmpty(view);
+            return true;
+        }
+
+        // The mapping keeps its own reference to the file.
+        void* mapped = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+        if (mapped == MAP_FAILED) {
+            return false;
+        }
+
+        view.data = (const byte*)mapped;
+        view.size = (u64)fileStat.st_size;
+        view.isMapped = true;
+
+        return true;
+    }
+
+    static void FileViewUnmap(FileView& view) {
+        munmap((void*)view.data, (size_t)view.size);
+    }
+#endif
+
+    static bool FileViewRead(const char* path, FileView& view) {
+        FILE* file = fopen(path, "rb");
+        if (file == nullptr) {
+            return false;
+        }
+
+        // Pipes and the like don't know their size up front, grow until the read comes up short.
+        u64 capacity = 64 * 1024;
+        u64 size = 0;
+        byte* buffer = (byte*)malloc(capacity);
+        for (;;) {
+            size += fread(buffer + size, 1, capacity - size, file);
+            if (size < capacity) {
+                break;
+            }
+
+            capacity *= 2;
+            buffer = (byte*)realloc(buffer, capacity);
+        }
+
+        const bool failed = ferror(file) != 0;
+        fclose(file);
+        if (failed || size == 0) {
+            free(buffer);
+            if (failed == false) {
+                FileViewSetEmpty(view);
+            }
+            return failed == false;
+        }
+
+        view.data = buffer;
+        view.size = size;
+        view.isMapped = false;
+
+        return true;
+    }
+
+    bool FileViewOpen(const char* path, FileView& view) {
+        view = {};
+
+        bool openFailed = false;
+        if (FileViewMap(path, view, openFailed)) {
+            return true;
+        }
+
+        if (openFailed) {
+            ATTOERROR("FileViewOpen -> Could not open file %s", path);
+            return false;
+        }
+
+        if (FileViewRead(path, view) == false) {
+            ATTOERROR("FileViewOpen -> Could not read %s", path);
+            return false;
+        }
+
+        return true;
+    }
+
+    void FileViewClose(FileView& view) {
+        if (view.data != nullptr && view.data != FILE_VIEW_EMPTY) {
+            if (view.isMapped) {
+                FileViewUnmap(view);
+            }
+            else {
+                free((void*)view.data);
+            }
+        }
+
+        view = {};
+    }
+
+    MappedFile::~MappedFile() {
+        Close();
+    }
+
+    bool MappedFile::Open(const char* path) {
+        Close();
+        return FileViewOpen(path, view);
+    }
+
+    void MappedFile::Close() {
+        FileViewClose(view);
+    }
+
+    FileService::~FileService() {
+        CloseAll();
+    }
+
+    FileHandle FileService::Open(const char* path) {
+        FileView view = {};
+        if (FileViewOpen(path, view) == false) {
+            return {};
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (views.IsFull()) {
+            ATTOERROR("FileService::Open -> Too many open files, could not open %s", path);
+            FileViewClose(view);
+            return {};
+        }
+
+        return views.Add(view);
+    }
+
+    void FileService::Close(FileHandle handle) {
+        std::lock_guard<std::mutex> lock(mutex);
+        FileView* view = views.Get(handle);
+        if (view != nullptr) {
+            FileViewClose(*view);
+            views.Remove(handle);
+        }
+    }
+
+    void FileService::CloseAll() {
+        std::lock_guard<std::mutex> lock(mutex);
+        const i32 viewCount = views.GetCount();
+        for (i32 viewIndex = 0; viewIndex < viewCount; viewIndex++) {
+            FileViewClose(views[viewIndex]);
+        }
+
+        views.Clear();
+    }
+
+    bool FileService::IsOpen(FileHandle handle) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return views.IsValid(handle);
+    }
+
+    const byte* FileService::GetData(FileHandle handle) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        const FileView* view = views.Get(handle);
+        return view != nullptr ? view->data : nullptr;
+    }
+
+    u64 FileService::GetSize(FileHandle handle) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        const FileView* view = views.Get(handle);
+        return view != nullptr ? view->size : 0;
+    }
+
+    FileServiceStats FileService::GetStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        FileServiceStats stats = {};
+        const i32 viewCount = views.GetCount();
+        for (i32 viewIndex = 0; viewIndex < viewCount; viewIndex++) {
+            const FileView& view = views[viewIndex];
+            if (view.isMapped) {
+                stats.mappedCount++;
+                stats.mappedBytes += view.size;
+            }
+            else {
+                stats.bufferedCount++;
+                stats.bufferedBytes += view.size;
+            }
+        }
+
+        return stats;
+    }
+}
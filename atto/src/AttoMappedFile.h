@@ -0,0 +1,78 @@
+#pragma once
+
+#include "AttoDefines.h"
+#include "AttoContainers.h"
+
+#include <mutex>
+
+namespace atto
+{
+    // A whole file in memory, read only. Normally a mapping, the OS pages the contents in as they are touched and
+    // nothing is copied. Files that can't be mapped, pipes and some network shares, are read into a buffer instead.
+    // An empty file opens to a view with size 0 and data that is not null but must not be read.
+    struct FileView {
+        const byte*             data;
+        u64                     size;
+        bool                    isMapped;
+#if _WIN32
+        void*                   fileHandle;
+        void*                   mappingHandle;
+#endif
+    };
+
+    bool                        FileViewOpen(const char* path, FileView& view);
+    void                        FileViewClose(FileView& view);
+
+    // Scoped FileView, closed when it goes out of scope.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+        DISABLE_COPY_AND_MOVE(MappedFile);
+
+        bool                    Open(const char* path);
+        void                    Close();
+
+        inline bool             IsOpen() const { return view.data != nullptr; }
+        inline bool             IsMapped() const { return view.isMapped; }
+        inline const byte*      GetData() const { return view.data; }
+        inline u64              GetSize() const { return view.size; }
+
+    private:
+        FileView                view = {};
+    };
+
+    // Refers to a file opened with FileService. Refs to closed files stay invalid, a zeroed one is never valid.
+    typedef EntityRef FileHandle;
+
+    struct FileServiceStats {
+        i32                     mappedCount;
+        i32                     bufferedCount;
+        u64                     mappedBytes;
+        u64                     bufferedBytes;
+    };
+
+    // Views whose lifetime isn't tied to a scope, like font data stbtt keeps pointing at. The data stays valid
+    // until the handle is closed or the service is shut down. Safe to use from any thread.
+    class FileService {
+    public:
+        FileService() = default;
+        ~FileService();
+        DISABLE_COPY_AND_MOVE(FileService);
+
+        FileHandle              Open(const char* path);
+        void                    Close(FileHandle handle);
+        void                    CloseAll();
+
+        bool                    IsOpen(FileHandle handle) const;
+        // nullptr and 0 for handles that are not open.
+        const byte*             GetData(FileHandle handle) const;
+        u64                     GetSize(FileHandle handle) const;
+
+        FileServiceStats        GetStats() const;
+
+    private:
+        mutable std::mutex                  mutex;
+        FixedFreeList<FileView, 1024>       views;
+    };
+}
@@ -0,0 +1,145 @@
+#include "AttoMemory.h"
+#include "AttoLib.h"
+
+#include <cstdlib>
+
+namespace atto
+{
+    static thread_local LinearArena scratchArena;
+
+    LinearArena::~LinearArena() {
+        Destroy();
+    }
+
+    void LinearArena::Create(u64 newCapacity) {
+        Assert(memory == nullptr, "LinearArena, already created");
+        memory = (byte*)malloc(newCapacity);
+        if (memory == nullptr) {
+            ATTOFATAL("LinearArena, could not reserve %llu bytes", newCapacity);
+            return;
+        }
+
+        capacity = newCapacity;
+        used = 0;
+        highWaterMark = 0;
+    }
+
+    void LinearArena::Destroy() {
+        if (memory != nullptr) {
+            free(memory);
+        }
+
+        memory = nullptr;
+        capacity = 0;
+        used = 0;
+    }
+
+    bool LinearArena::IsCreated() const {
+        return memory != nullptr;
+    }
+
+    void* LinearArena::Allocate(u64 size, u64 alignment) {
+        const u64 start = AlignUp(used, alignment);
+        if (start + size > capacity) {
+            ATTOFATAL("LinearArena, out of memory. Requested %llu bytes with %llu of %llu used", size, used, capacity);
+            return nullptr;
+        }
+
+        used = start + size;
+        if (used > highWaterMark) {
+            highWaterMark = used;
+        }
+
+        return memory + start;
+    }
+
+    void* LinearArena::Reallocate(void* ptr, u64 oldSize, u64 newSize, u64 alignment) {
+        if (ptr == nullptr) {
+            return Allocate(newSize, alignment);
+        }
+
+        // The last allocation can simply be extended in place.
+        if ((byte*)ptr + oldSize == memory + used && (byte*)ptr - memory + newSize <= capacity) {
+            used = (u64)((byte*)ptr - memory) + newSize;
+            if (used > highWaterMark) {
+                highWaterMark = used;
+            }
+
+            return ptr;
+        }
+
+        void* result = Allocate(newSize, alignment);
+        if (result != nullptr) {
+            memcpy(result, ptr, oldSize < newSize ? oldSize : newSize);
+        }
+
+        return result;
+    }
+
+    void LinearArena::Reset() {
+        used = 0;
+    }
+
+    u64 LinearArena::GetMark() const {
+        return used;
+    }
+
+    void LinearArena::ResetToMark(u64 mark) {
+        Assert(mark <= used, "LinearArena, invalid mark");
+        used = mark;
+    }
+
+    u64 LinearArena::GetUsed() const {
+        return used;
+    }
+
+    u64 LinearArena::GetCapacity() const {
+        return capacity;
+    }
+
+    u64 LinearArena::GetHighWaterMark() const {
+        return highWaterMark;
+    }
+
+    void Memory::Initialize(u64 frameBytes, u64 scratchBytes) {
+        frameArena.Create(frameBytes);
+        scratchArenaBytes = scratchBytes;
+    }
+
+    void Memory::Shutdown() {
+        frameArena.Destroy();
+        scratchArena.Destroy();
+    }
+
+    void Memory::ResetFrame() {
+        frameArena.Reset();
+    }
+
+    LinearArena& Memory::GetFrameArena() {
+        return frameArena;
+    }
+
+    void* Memory::AllocateTransient(u64 size, u64 alignment) {
+        return frameArena.Allocate(size, alignment);
+    }
+
+    LinearArena& Memory::GetScratchArena() {
+        if (scratchArena.IsCreated() == false) {
+            scratchArena.Create(scratchArenaBytes);
+        }
+
+        return scratchArena;
+    }
+
+    void* Memory::AllocateScratch(u64 size, u64 alignment) {
+        return GetScratchArena().Allocate(size, alignment);
+    }
+
+    ScratchScope::ScratchScope() {
+        mark = Memory::GetScratchArena().GetMark();
+    }
+
+    ScratchScope::~ScratchScope() {
+        Memory::GetScratchArena().ResetToMark(mark);
+    }
+}
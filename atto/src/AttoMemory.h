@@ -0,0 +1,83 @@
+#pragma once
+
+#include "AttoDefines.h"
+
+namespace atto
+{
+    // Bump pointer allocator, individual allocations are never freed. Memory is handed back all at once
+    // with Reset or by rewinding to a mark taken earlier.
+    class LinearArena
+    {
+    public:
+        LinearArena() = default;
+        ~LinearArena();
+        DISABLE_COPY_AND_MOVE(LinearArena);
+
+        void            Create(u64 capacity);
+        void            Destroy();
+        bool            IsCreated() const;
+
+        void*           Allocate(u64 size, u64 alignment = 16);
+        void*           Reallocate(void* ptr, u64 oldSize, u64 newSize, u64 alignment = 16);
+
+        void            Reset();
+        u64             GetMark() const;
+        void            ResetToMark(u64 mark);
+
+        u64             GetUsed() const;
+        u64             GetCapacity() const;
+        u64             GetHighWaterMark() const;
+
+    private:
+        byte*           memory = nullptr;
+        u64             capacity = 0;
+        u64             used = 0;
+        u64             highWaterMark = 0;
+    };
+
+    class Memory
+    {
+    public:
+        static void             Initialize(u64 frameBytes, u64 scratchBytes);
+        static void             Shutdown();
+
+        // The frame arena is owned by the main thread and is reset once per frame.
+        static void             ResetFrame();
+        static LinearArena&     GetFrameArena();
+        static void*            AllocateTransient(u64 size, u64 alignment = 16);
+        template<typename _type_>
+        static _type_*          AllocateTransientStruct(i32 count);
+
+        // Every thread has its own scratch arena, created on first use. Use a ScratchScope to give the memory back.
+        static LinearArena&     GetScratchArena();
+        static void*            AllocateScratch(u64 size, u64 alignment = 16);
+        template<typename _type_>
+        static _type_*          AllocateScratchStruct(i32 count);
+
+    private:
+        inline static LinearArena   frameArena;
+        inline static u64           scratchArenaBytes = Megabytes(64);
+    };
+
+    // Rewinds the calling thread's scratch arena to where it was when the scope was entered.
+    class ScratchScope
+    {
+    public:
+        ScratchScope();
+        ~ScratchScope();
+        DISABLE_COPY_AND_MOVE(ScratchScope);
+
+    private:
+        u64             mark;
+    };
+
+    template<typename _type_>
+    _type_* Memory::AllocateTransientStruct(i32 count) {
+        return (_type_*)AllocateTransient(sizeof(_type_) * (u64)count, alignof(_type_) > 16 ? alignof(_type_) : 16);
+    }
+
+    template<typename _type_>
+    _type_* Memory::AllocateScratchStruct(i32 count) {
+        return (_type_*)AllocateScratch(sizeof(_type_) * (u64)count, alignof(_type_) > 16 ? alignof(_type_) : 16);
+    }
+}
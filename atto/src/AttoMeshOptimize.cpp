@@ -0,0 +1,398 @@
+#include "AttoMeshOptimize.h"
+#include "AttoMemory.h"
+#include "AttoSort.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace atto
+{
+    // FIFO cache simulation using timestamps, a vertex is in the cache if fewer than cacheSize misses happened
+    // since it was last loaded. Resetting is a jump of the timestamp.
+    struct MeshFifoCache {
+        u32*    loadTimes;
+        u32     timestamp;
+        u32     cacheSize;
+
+        void Create(i32 vertexCount, i32 size) {
+            loadTimes = Memory::AllocateScratchStruct<u32>(vertexCount);
+            memset(loadTimes, 0, sizeof(u32) * (u64)vertexCount);
+            cacheSize = (u32)size;
+            timestamp = cacheSize + 1;
+        }
+
+        void Reset() {
+            timestamp += cacheSize + 1;
+        }
+
+        i32 Touch(u32 vertex) {
+            if (timestamp - loadTimes[vertex] > cacheSize) {
+                loadTimes[vertex] = timestamp++;
+                return 1;
+            }
+            return 0;
+        }
+
+        i32 TouchTriangle(const u32* triangle) {
+            return Touch(triangle[0]) + Touch(triangle[1]) + Touch(triangle[2]);
+        }
+    };
+
+    MeshCacheStats MeshAnalyzeVertexCache(const u32* indices, i32 indexCount, i32 vertexCount, i32 cacheSize) {
+        Assert(indexCount % 3 == 0, "Expected a triangle list");
+
+        MeshCacheStats stats = {};
+        if (indexCount == 0) {
+            return stats;
+        }
+
+        ScratchScope scratch;
+        MeshFifoCache cache = {};
+        cache.Create(vertexCount, cacheSize);
+
+        byte* referenced = Memory::AllocateScratchStruct<byte>(vertexCount);
+        memset(referenced, 0, vertexCount);
+
+        i32 misses = 0;
+        i32 uniqueVertices = 0;
+        for (i32 index = 0; index < indexCount; index += 3) {
+            misses += cache.TouchTriangle(indices + index);
+            for (i32 corner = 0; corner < 3; corner++) {
+                const u32 vertex = indices[index + corner];
+                uniqueVertices += referenced[vertex] == 0;
+                referenced[vertex] = 1;
+            }
+        }
+
+        stats.acmr = (f32)misses / (f32)(indexCount / 3);
+        stats.atvr = (f32)misses / (f32)uniqueVertices;
+
+        return stats;
+    }
+
+    // Tom Forsyth, "Linear-Speed Vertex Cache Optimisation". Greedily emits the best scoring triangle next to the
+    // ones already in a simulated LRU cache. Vertices score for being recently used and for having few triangles
+    // left, so lone triangles get finished off instead of being left behind for an expensive miss later.
+    static constexpr i32 FORSYTH_CACHE_SIZE = 32;
+    static constexpr i32 FORSYTH_MAX_VALENCE = 32;
+    static constexpr f32 FORSYTH_CACHE_DECAY_POWER = 1.5f;
+    static constexpr f32 FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+    static constexpr f32 FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+    static constexpr f32 FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+    struct ForsythScoreTables {
+        f32 cache[FORSYTH_CACHE_SIZE];
+        f32 valence[FORSYTH_MAX_VALENCE + 1];
+
+        ForsythScoreTables() {
+            for (i32 position = 0; position < FORSYTH_CACHE_SIZE; position++) {
+                // The last triangle's vertices get a fixed score so the next triangle doesn't just reuse the same edge.
+                if (position < 3) {
+                    cache[position] = FORSYTH_LAST_TRIANGLE_SCORE;
+                }
+                else {
+                    const f32 scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+                    cache[position] = powf(1.0f - (position - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+                }
+            }
+
+            valence[0] = 0.0f;
+            for (i32 count = 1; count <= FORSYTH_MAX_VALENCE; count++) {
+                valence[count] = FORSYTH_VALENCE_BOOST_SCALE * powf((f32)count, -FORSYTH_VALENCE_BOOST_POWER);
+            }
+        }
+
+        f32 Score(i32 cachePosition, i32 remainingValence) const {
+            if (remainingValence == 0) {
+                return -1.0f;
+            }
+
+            f32 score = cachePosition >= 0 ? cache[cachePosition] : 0.0f;
+            score += valence[remainingValence < FORSYTH_MAX_VALENCE ? remainingValence : FORSYTH_MAX_VALENCE];
+            return score;
+        }
+    };
+
+    void MeshOptimizeVertexCache(u32* indices, i32 indexCount, i32 vertexCount) {
+        Assert(indexCount % 3 == 0, "Expected a triangle list");
+
+        const i32 triangleCount = indexCount / 3;
+        if (triangleCount < 2) {
+            return;
+        }
+
+        static const ForsythScoreTables tables;
+
+        ScratchScope scratch;
+
+        // Triangles that use each vertex. The first valence entries of every range are the triangles that still
+        // have to be emitted, emitted ones are swapped to the back.
+        i32* valence = Memory::AllocateScratchStruct<i32>(vertexCount);
+        i32* adjacencyOffsets = Memory::AllocateScratchStruct<i32>(vertexCount + 1);
+        i32* adjacency = Memory::AllocateScratchStruct<i32>(indexCount);
+        memset(valence, 0, sizeof(i32) * (u64)vertexCount);
+        for (i32 index = 0; index < indexCount; index++) {
+            Assert(indices[index] < (u32)vertexCount, "Index out of range");
+            valence[indices[index]]++;
+        }
+
+        adjacencyOffsets[0] = 0;
+        for (i32 vertex = 0; vertex < vertexCount; vertex++) {
+            adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + valence[vertex];
+            valence[vertex] = 0;
+        }
+
+        for (i32 index = 0; index < indexCount; index++) {
+            const u32 vertex = indices[index];
+            adjacency[adjacencyOffsets[vertex] + valence[vertex]++] = index / 3;
+        }
+
+        i32* cachePositions = Memory::AllocateScratchStruct<i32>(vertexCount);
+        f32* vertexScores = Memory::AllocateScratchStruct<f32>(vertexCount);
+        for (i32 vertex = 0; vertex < vertexCount; vertex++) {
+            cachePositions[vertex] = -1;
+            vertexScores[vertex] = tables.Score(-1, valence[vertex]);
+        }
+
+        byte* emitted = Memory::AllocateScratchStruct<byte>(triangleCount);
+        memset(emitted, 0, triangleCount);
+
+        u32* output = Memory::AllocateScratchStruct<u32>(indexCount);
+
+        u32 cache[FORSYTH_CACHE_SIZE + 3] = {};
+        u32 nextCache[FORSYTH_CACHE_SIZE + 3] = {};
+        i32 cacheCount = 0;
+
+        // Start with the best triangle overall, after that only triangles touching the cache are considered.
+        i32 bestTriangle = 0;
+        f32 bestScore = -1.0f;
+        for (i32 triangle = 0; triangle < triangleCount; triangle++) {
+            const u32* corners = indices + triangle * 3;
+            const f32 score = vertexScores[corners[0]] + vertexScores[corners[1]] + vertexScores[corners[2]];
+            if (score > bestScore) {
+                bestScore = score;
+                bestTriangle = triangle;
+            }
+        }
+
+        i32 searchCursor = 0;
+        for (i32 outputTriangle = 0; outputTriangle < triangleCount; outputTriangle++) {
+            // Nothing in the cache has triangles left, carry on with the first triangle that hasn't been emitted.
+            if (bestTriangle < 0) {
+                while (emitted[searchCursor] != 0) {
+                    searchCursor++;
+                }
+                bestTriangle = searchCursor;
+            }
+
+            const u32* corners = indices + bestTriangle * 3;
+            memcpy(output + outputTriangle * 3, corners, sizeof(u32) * 3);
+            emitted[bestTriangle] = 1;
+
+            for (i32 corner = 0; corner < 3; corner++) {
+                const u32 vertex = corners[corner];
+                i32* triangles = adjacency + adjacencyOffsets[vertex];
+                const i32 last = valence[vertex] - 1;
+                for (i32 slot = 0; slot <= last; slot++) {
+                    if (triangles[slot] == bestTriangle) {
+                        triangles[slot] = triangles[last];
+                        triangles[last] = bestTriangle;
+                        break;
+                    }
+                }
+                valence[vertex]--;
+            }
+
+            // The emitted triangle moves to the front of the LRU cache.
+            i32 nextCacheCount = 0;
+            for (i32 corner = 0; corner < 3; corner++) {
+                const u32 vertex = corners[corner];
+                if (corner > 0 && (vertex == corners[0] || (corner == 2 && vertex == corners[1]))) {
+                    continue;
+                }
+                nextCache[nextCacheCount++] = vertex;
+            }
+            for (i32 slot = 0; slot < cacheCount; slot++) {
+                const u32 vertex = cache[slot];
+                if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2]) {
+                    nextCache[nextCacheCount++] = vertex;
+                }
+            }
+
+            for (i32 slot = FORSYTH_CACHE_SIZE; slot < nextCacheCount; slot++) {
+                const u32 vertex = nextCache[slot];
+                cachePositions[vertex] = -1;
+                vertexScores[vertex] = tables.Score(-1, valence[vertex]);
+            }
+
+            cacheCount = nextCacheCount < FORSYTH_CACHE_SIZE ? nextCacheCount : FORSYTH_CACHE_SIZE;
+            for (i32 slot = 0; slot < cacheCount; slot++) {
+                const u32 vertex = nextCache[slot];
+                cache[slot] = vertex;
+                cachePositions[vertex] = slot;
+                vertexScores[vertex] = tables.Score(slot, valence[vertex]);
+            }
+
+            bestTriangle = -1;
+            bestScore = -1.0f;
+            for (i32 slot = 0; slot < cacheCount; slot++) {
+                const u32 vertex = cache[slot];
+                const i32* triangles = adjacency + adjacencyOffsets[vertex];
+                for (i32 candidate = 0; candidate < valence[vertex]; candidate++) {
+                    const u32* candidateCorners = indices + triangles[candidate] * 3;
+                    const f32 score = vertexScores[candidateCorners[0]] + vertexScores[candidateCorners[1]] + vertexScores[candidateCorners[2]];
+                    if (score > bestScore) {
+                        bestScore = score;
+                        bestTriangle = triangles[candidate];
+                    }
+                }
+            }
+        }
+
+        memcpy(indices, output, sizeof(u32) * (u64)indexCount);
+    }
+
+    struct MeshOverdrawCluster {
+        f32 sortKey;
+        i32 firstTriangle;
+        i32 triangleCount;
+    };
+
+    // Pedro Sander et al, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw". The cache optimised
+    // order is cut into clusters wherever the cache would restart anyway, or where a cluster is already within
+    // threshold of its own miss ratio. Clusters are then drawn outermost first, so for convex-ish meshes the
+    // front faces land before the ones they occlude.
+    void MeshOptimizeOverdraw(u32* indices, i32 indexCount, const f32* positions, i32 vertexCount, f32 threshold) {
+        Assert(indexCount % 3 == 0, "Expected a triangle list");
+
+        const i32 triangleCount = indexCount / 3;
+        if (triangleCount < 2) {
+            return;
+        }
+
+        ScratchScope scratch;
+        MeshFifoCache cache = {};
+        cache.Create(vertexCount, MESH_CACHE_ANALYZE_SIZE);
+
+        // Hard boundaries, triangles that miss on all three vertices start a new cluster no matter the order.
+        i32* hardBoundaries = Memory::AllocateScratchStruct<i32>(triangleCount + 1);
+        i32 hardBoundaryCount = 0;
+        for (i32 triangle = 0; triangle < triangleCount; triangle++) {
+            if (cache.TouchTriangle(indices + triangle * 3) == 3 || triangle == 0) {
+                hardBoundaries[hardBoundaryCount++] = triangle;
+            }
+        }
+        hardBoundaries[hardBoundaryCount] = triangleCount;
+
+        // Soft boundaries, split a hard cluster as soon as the part so far is close enough to the whole cluster's ratio.
+        MeshOverdrawCluster* clusters = Memory::AllocateScratchStruct<MeshOverdrawCluster>(triangleCount);
+        i32 clusterCount = 0;
+        for (i32 hardIndex = 0; hardIndex < hardBoundaryCount; hardIndex++) {
+            const i32 start = hardBoundaries[hardIndex];
+            const i32 end = hardBoundaries[hardIndex + 1];
+
+            cache.Reset();
+            i32 clusterMisses = 0;
+            for (i32 triangle = start; triangle < end; triangle++) {
+                clusterMisses += cache.TouchTriangle(indices + triangle * 3);
+            }
+            const f32 clusterThreshold = threshold * (f32)clusterMisses / (f32)(end - start);
+
+            cache.Reset();
+            i32 clusterStart = start;
+            i32 misses = 0;
+            for (i32 triangle = start; triangle < end; triangle++) {
+                misses += cache.TouchTriangle(indices + triangle * 3);
+                const bool closeEnough = (f32)misses / (f32)(triangle - clusterStart + 1) <= clusterThreshold;
+                if (triangle + 1 == end || closeEnough) {
+                    MeshOverdrawCluster& cluster = clusters[clusterCount++];
+                    cluster.firstTriangle = clusterStart;
+                    cluster.triangleCount = triangle + 1 - clusterStart;
+                    clusterStart = triangle + 1;
+                    misses = 0;
+                    cache.Reset();
+                }
+            }
+        }
+
+        f32 meshCentroid[3] = {};
+        for (i32 vertex = 0; vertex < vertexCount; vertex++) {
+            meshCentroid[0] += positions[vertex * 3 + 0];
+            meshCentroid[1] += positions[vertex * 3 + 1];
+            meshCentroid[2] += positions[vertex * 3 + 2];
+        }
+        for (i32 axis = 0; axis < 3; axis++) {
+            meshCentroid[axis] /= (f32)vertexCount;
+        }
+
+        for (i32 clusterIndex = 0; clusterIndex < clusterCount; clusterIndex++) {
+            MeshOverdrawCluster& cluster = clusters[clusterIndex];
+
+            // Area weighted, the cross product is twice the triangle area so it weights both sums the same way.
+            f32 centroid[3] = {};
+            f32 normal[3] = {};
+            f32 area = 0.0f;
+            for (i32 triangle = cluster.firstTriangle; triangle < cluster.firstTriangle + cluster.triangleCount; triangle++) {
+                const f32* a = positions + indices[triangle * 3 + 0] * 3;
+                const f32* b = positions + indices[triangle * 3 + 1] * 3;
+                const f32* c = positions + indices[triangle * 3 + 2] * 3;
+
+                const f32 ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+                const f32 ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+                const f32 cross[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+                const f32 triangleArea = sqrtf(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+
+                for (i32 axis = 0; axis < 3; axis++) {
+                    centroid[axis] += (a[axis] + b[axis] + c[axis]) * (1.0f / 3.0f) * triangleArea;
+                    normal[axis] += cross[axis];
+                }
+                area += triangleArea;
+            }
+
+            const f32 normalLength = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if (area <= 0.0f || normalLength <= 0.0f) {
+                cluster.sortKey = 0.0f;
+                continue;
+            }
+
+            f32 sortKey = 0.0f;
+            for (i32 axis = 0; axis < 3; axis++) {
+                sortKey += (centroid[axis] / area - meshCentroid[axis]) * (normal[axis] / normalLength);
+            }
+            cluster.sortKey = sortKey;
+        }
+
+        StableSort(clusters, clusterCount, [](const MeshOverdrawCluster& a, const MeshOverdrawCluster& b) {
+            return a.sortKey > b.sortKey;
+        });
+
+        u32* output = Memory::AllocateScratchStruct<u32>(indexCount);
+        i32 outputIndex = 0;
+        for (i32 clusterIndex = 0; clusterIndex < clusterCount; clusterIndex++) {
+            const MeshOverdrawCluster& cluster = clusters[clusterIndex];
+            const i32 clusterIndexCount = cluster.triangleCount * 3;
+            memcpy(output + outputIndex, indices + cluster.firstTriangle * 3, sizeof(u32) * (u64)clusterIndexCount);
+            outputIndex += clusterIndexCount;
+        }
+
+        memcpy(indices, output, sizeof(u32) * (u64)indexCount);
+    }
+
+    i32 MeshOptimizeVertexFetch(u32* indices, i32 indexCount, i32 vertexCount, i32* remap) {
+        for (i32 vertex = 0; vertex < vertexCount; vertex++) {
+            remap[vertex] = -1;
+        }
+
+        i32 nextVertex = 0;
+        for (i32 index = 0; index < indexCount; index++) {
+            const u32 vertex = indices[index];
+            Assert(vertex < (u32)vertexCount, "Index out of range");
+            if (remap[vertex] < 0) {
+                remap[vertex] = nextVertex++;
+            }
+            indices[index] = (u32)remap[vertex];
+        }
+
+        return nextVertex;
+    }
+}
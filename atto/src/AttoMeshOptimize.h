@@ -0,0 +1,58 @@
+#pragma once
+
+#include "AttoDefines.h"
+
+namespace atto
+{
+    // Index and vertex reordering for triangle lists. Nothing here allocates outside the scratch arena, so
+    // everything can run on job threads during import and cooking.
+
+    enum MeshOptimizeFlags : u32 {
+        MESH_OPTIMIZE_NONE = 0,
+        // Reorder triangles so the post transform cache gets reused (Forsyth).
+        MESH_OPTIMIZE_VERTEX_CACHE = 1 << 0,
+        // Reorder triangle clusters front to back from the mesh centre, trading a little cache efficiency for less overdraw.
+        MESH_OPTIMIZE_OVERDRAW = 1 << 1,
+        // Reorder vertices by first use so vertex fetches walk the buffer forwards.
+        MESH_OPTIMIZE_VERTEX_FETCH = 1 << 2,
+
+        MESH_OPTIMIZE_DEFAULT = MESH_OPTIMIZE_VERTEX_CACHE | MESH_OPTIMIZE_VERTEX_FETCH,
+    };
+
+    struct MeshOptimizeSettings {
+        u32 flags = MESH_OPTIMIZE_DEFAULT;
+        // How much worse than the cache optimised order a cluster is allowed to get before it is split for overdraw sorting.
+        f32 overdrawThreshold = 1.05f;
+        // Log ACMR/ATVR before and after for every mesh.
+        bool report = false;
+    };
+
+    // Average cache miss ratio is misses per triangle, 0.5 is the ideal for a regular grid and 3 is no reuse at all.
+    // Average transformed vertex ratio is misses per vertex, 1 means every vertex is transformed exactly once.
+    struct MeshCacheStats {
+        f32 acmr;
+        f32 atvr;
+    };
+
+    struct MeshOptimizeReport {
+        MeshCacheStats before;
+        MeshCacheStats after;
+    };
+
+    // Roughly what current GPUs behave like, the exact value matters little for the order it produces.
+    static constexpr i32 MESH_CACHE_ANALYZE_SIZE = 16;
+
+    // Simulates a FIFO post transform cache of cacheSize entries.
+    MeshCacheStats  MeshAnalyzeVertexCache(const u32* indices, i32 indexCount, i32 vertexCount, i32 cacheSize = MESH_CACHE_ANALYZE_SIZE);
+
+    // Reorders the triangles in place. Every index must be below vertexCount.
+    void            MeshOptimizeVertexCache(u32* indices, i32 indexCount, i32 vertexCount);
+
+    // Reorders the triangles in place, expects indices that already went through MeshOptimizeVertexCache. positions
+    // are vertexCount tightly packed xyz triples.
+    void            MeshOptimizeOverdraw(u32* indices, i32 indexCount, const f32* positions, i32 vertexCount, f32 threshold);
+
+    // Fills remap with the new position of every vertex, in order of first use, and rewrites the indices to match.
+    // Unreferenced vertices get -1. Returns the number of vertices that are still used.
+    i32             MeshOptimizeVertexFetch(u32* indices, i32 indexCount, i32 vertexCount, i32* remap);
+}
@@ -0,0 +1,245 @@
+#include "AttoMeshQuantize.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace atto
+{
+    u32 MeshVertexFormatGetStride(MeshVertexFormat format) {
+        switch (format)
+        {
+        case MESH_VERTEX_FORMAT_PNT:
+        {
+            return sizeof(f32) * MESH_PNT_FLOATS_PER_VERTEX;
+        }
+        case MESH_VERTEX_FORMAT_QUANTIZED:
+        case MESH_VERTEX_FORMAT_QUANTIZED_HALF:
+        {
+            return sizeof(MeshQuantizedVertex);
+        }
+        default:
+        {
+            return 0;
+        }
+        }
+    }
+
+    const char* MeshVertexFormatToString(MeshVertexFormat format) {
+        switch (format)
+        {
+        case MESH_VERTEX_FORMAT_PNT: return "pnt";
+        case MESH_VERTEX_FORMAT_QUANTIZED: return "quantized";
+        case MESH_VERTEX_FORMAT_QUANTIZED_HALF: return "half";
+        default: return "unknown";
+        }
+    }
+
+    u16 QuantizeUnorm16(f32 value) {
+        value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+        return (u16)(value * 65535.0f + 0.5f);
+    }
+
+    f32 DequantizeUnorm16(u16 value) {
+        return (f32)value * (1.0f / 65535.0f);
+    }
+
+    i16 QuantizeSnorm16(f32 value) {
+        value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+        return (i16)roundf(value * 32767.0f);
+    }
+
+    f32 DequantizeSnorm16(i16 value) {
+        // -32768 and -32767 both map to -1.
+        const f32 result = (f32)value * (1.0f / 32767.0f);
+        return result < -1.0f ? -1.0f : result;
+    }
+
+    u16 F32ToF16(f32 value) {
+        u32 bits = 0;
+        memcpy(&bits, &value, sizeof(bits));
+
+        const u32 sign = (bits >> 16) & 0x8000;
+        const u32 absBits = bits & 0x7FFFFFFF;
+
+        // NaN stays NaN, infinity and anything that rounds past 65504 become infinity.
+        if (absBits > 0x7F800000) {
+            return (u16)(sign | 0x7E00);
+        }
+        if (absBits >= 0x477FF000) {
+            return (u16)(sign | 0x7C00);
+        }
+
+        // Below the smallest normal half, 2^-14, the result is a subnormal. Anything up to 2^-25 rounds to zero.
+        if (absBits < 0x38800000) {
+            if (absBits <= 0x33000000) {
+                return (u16)sign;
+            }
+
+            const u32 exponent = absBits >> 23;
+            const u32 mantissa = (absBits & 0x007FFFFF) | 0x00800000;
+            const u32 shift = 126 - exponent;
+            u32 half = mantissa >> shift;
+            const u32 remainder = mantissa & ((1u << shift) - 1);
+            const u32 midpoint = 1u << (shift - 1);
+            if (remainder > midpoint || (remainder == midpoint && (half & 1) != 0)) {
+                half++;
+            }
+            return (u16)(sign | half);
+        }
+
+        // Rebias the exponent from 127 to 15 and round the 13 mantissa bits that get dropped. A carry out of the
+        // mantissa correctly bumps the exponent.
+        u32 half = (absBits >> 13) - ((127 - 15) << 10);
+        const u32 remainder = absBits & 0x1FFF;
+        if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1) != 0)) {
+            half++;
+        }
+        return (u16)(sign | half);
+    }
+
+    f32 F16ToF32(u16 value) {
+        const u32 sign = (u32)(value & 0x8000) << 16;
+        const u32 exponent = (value >> 10) & 0x1F;
+        const u32 mantissa = value & 0x3FF;
+
+        u32 bits = 0;
+        if (exponent == 0) {
+            const f32 subnormal = (f32)mantissa * (1.0f / 16777216.0f);
+            memcpy(&bits, &subnormal, sizeof(bits));
+            bits |= sign;
+        }
+        else if (exponent == 0x1F) {
+            bits = sign | 0x7F800000 | (mantissa << 13);
+        }
+        else {
+            bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+        }
+
+        f32 result = 0.0f;
+        memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    void OctahedralEncode(const f32* normal, i16* encoded) {
+        const f32 length = fabsf(normal[0]) + fabsf(normal[1]) + fabsf(normal[2]);
+        if (length <= 0.0f) {
+            encoded[0] = 0;
+            encoded[1] = 0;
+            return;
+        }
+
+        f32 x = normal[0] / length;
+        f32 y = normal[1] / length;
+        // The lower hemisphere is folded over the diagonals.
+        if (normal[2] < 0.0f) {
+            const f32 foldedX = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            const f32 foldedY = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = foldedX;
+            y = foldedY;
+        }
+
+        encoded[0] = QuantizeSnorm16(x);
+        encoded[1] = QuantizeSnorm16(y);
+    }
+
+    void OctahedralDecode(const i16* encoded, f32* normal) {
+        f32 x = DequantizeSnorm16(encoded[0]);
+        f32 y = DequantizeSnorm16(encoded[1]);
+        const f32 z = 1.0f - fabsf(x) - fabsf(y);
+
+        // Unfolds the lower hemisphere without a branch on z, the vertex shader does exactly the same.
+        const f32 t = z < 0.0f ? -z : 0.0f;
+        x += x >= 0.0f ? -t : t;
+        y += y >= 0.0f ? -t : t;
+
+        const f32 inverseLength = 1.0f / sqrtf(x * x + y * y + z * z);
+        normal[0] = x * inverseLength;
+        normal[1] = y * inverseLength;
+        normal[2] = z * inverseLength;
+    }
+
+    void MeshQuantizationCompute(const f32* vertices, i32 vertexCount, MeshVertexFormat format, MeshQuantization& quantization) {
+        f32 positionMin[3] = { 0.0f, 0.0f, 0.0f };
+        f32 positionMax[3] = { 0.0f, 0.0f, 0.0f };
+        f32 uvMin[2] = { 0.0f, 0.0f };
+        f32 uvMax[2] = { 0.0f, 0.0f };
+        for (i32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++) {
+            const f32* vertex = vertices + vertexIndex * MESH_PNT_FLOATS_PER_VERTEX;
+            for (i32 axis = 0; axis < 3; axis++) {
+                positionMin[axis] = vertexIndex == 0 || vertex[axis] < positionMin[axis] ? vertex[axis] : positionMin[axis];
+                positionMax[axis] = vertexIndex == 0 || vertex[axis] > positionMax[axis] ? vertex[axis] : positionMax[axis];
+            }
+            for (i32 axis = 0; axis < 2; axis++) {
+                uvMin[axis] = vertexIndex == 0 || vertex[6 + axis] < uvMin[axis] ? vertex[6 + axis] : uvMin[axis];
+                uvMax[axis] = vertexIndex == 0 || vertex[6 + axis] > uvMax[axis] ? vertex[6 + axis] : uvMax[axis];
+            }
+        }
+
+        for (i32 axis = 0; axis < 3; axis++) {
+            if (format == MESH_VERTEX_FORMAT_QUANTIZED_HALF) {
+                quantization.positionOffset[axis] = (positionMin[axis] + positionMax[axis]) * 0.5f;
+                quantization.positionScale[axis] = 1.0f;
+            }
+            else {
+                quantization.positionOffset[axis] = positionMin[axis];
+                quantization.positionScale[axis] = positionMax[axis] - positionMin[axis];
+            }
+        }
+
+        for (i32 axis = 0; axis < 2; axis++) {
+            quantization.uvOffset[axis] = uvMin[axis];
+            quantization.uvScale[axis] = uvMax[axis] - uvMin[axis];
+        }
+    }
+
+    void MeshEncodeQuantized(const f32* vertices, i32 vertexCount, MeshVertexFormat format, const MeshQuantization& quantization, MeshQuantizedVertex* encoded) {
+        Assert(format == MESH_VERTEX_FORMAT_QUANTIZED || format == MESH_VERTEX_FORMAT_QUANTIZED_HALF, "Not a quantized format");
+
+        // Flat axes have a scale of zero, anything encodes to the offset.
+        f32 positionInverseScale[3] = {};
+        f32 uvInverseScale[2] = {};
+        for (i32 axis = 0; axis < 3; axis++) {
+            positionInverseScale[axis] = quantization.positionScale[axis] != 0.0f ? 1.0f / quantization.positionScale[axis] : 0.0f;
+        }
+        for (i32 axis = 0; axis < 2; axis++) {
+            uvInverseScale[axis] = quantization.uvScale[axis] != 0.0f ? 1.0f / quantization.uvScale[axis] : 0.0f;
+        }
+
+        for (i32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++) {
+            const f32* vertex = vertices + vertexIndex * MESH_PNT_FLOATS_PER_VERTEX;
+            MeshQuantizedVertex& result = encoded[vertexIndex];
+
+            for (i32 axis = 0; axis < 3; axis++) {
+                const f32 local = (vertex[axis] - quantization.positionOffset[axis]) * positionInverseScale[axis];
+                result.position[axis] = format == MESH_VERTEX_FORMAT_QUANTIZED_HALF ? F32ToF16(local) : QuantizeUnorm16(local);
+            }
+            result.position[3] = format == MESH_VERTEX_FORMAT_QUANTIZED_HALF ? F32ToF16(1.0f) : QuantizeUnorm16(1.0f);
+
+            OctahedralEncode(vertex + 3, result.normal);
+
+            for (i32 axis = 0; axis < 2; axis++) {
+                result.uv[axis] = QuantizeUnorm16((vertex[6 + axis] - quantization.uvOffset[axis]) * uvInverseScale[axis]);
+            }
+        }
+    }
+
+    void MeshDecodeQuantized(const MeshQuantizedVertex* encoded, i32 vertexCount, MeshVertexFormat format, const MeshQuantization& quantization, f32* vertices) {
+        Assert(format == MESH_VERTEX_FORMAT_QUANTIZED || format == MESH_VERTEX_FORMAT_QUANTIZED_HALF, "Not a quantized format");
+
+        for (i32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++) {
+            const MeshQuantizedVertex& source = encoded[vertexIndex];
+            f32* vertex = vertices + vertexIndex * MESH_PNT_FLOATS_PER_VERTEX;
+
+            for (i32 axis = 0; axis < 3; axis++) {
+                const f32 local = format == MESH_VERTEX_FORMAT_QUANTIZED_HALF ? F16ToF32(source.position[axis]) : DequantizeUnorm16(source.position[axis]);
+                vertex[axis] = quantization.positionOffset[axis] + local * quantization.positionScale[axis];
+            }
+
+            OctahedralDecode(source.normal, vertex + 3);
+
+            for (i32 axis = 0; axis < 2; axis++) {
+                vertex[6 + axis] = quantization.uvOffset[axis] + DequantizeUnorm16(source.uv[axis]) * quantization.uvScale[axis];
+            }
+        }
+    }
+}
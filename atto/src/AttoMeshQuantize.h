@@ -0,0 +1,61 @@
+#pragma once
+
+#include "AttoDefines.h"
+
+namespace atto
+{
+    // Compressed mesh vertex formats and the CPU side encode/decode kernels. The GPU decodes the same formats
+    // in the input assembler and the vertex shader, see INPUT_LAYOUT_POSITION_NORMAL_UV_QUANTIZED.
+
+    enum MeshVertexFormat : u32 {
+        // 3 f32 position, 3 f32 normal, 2 f32 uv. 32 bytes.
+        MESH_VERTEX_FORMAT_PNT = 0,
+        // 4 unorm16 position inside the mesh bounds, 2 snorm16 octahedral normal, 2 unorm16 uv inside the uv bounds. 16 bytes.
+        MESH_VERTEX_FORMAT_QUANTIZED,
+        // As above with 4 half float positions relative to the bounds centre, better precision near the centre.
+        MESH_VERTEX_FORMAT_QUANTIZED_HALF,
+        MESH_VERTEX_FORMAT_COUNT,
+    };
+
+    struct MeshQuantizedVertex {
+        u16 position[4];
+        i16 normal[2];
+        u16 uv[2];
+    };
+
+    static_assert(sizeof(MeshQuantizedVertex) == 16, "Quantized vertices are uploaded as is");
+
+    // Position, normal, uv.
+    static constexpr i32 MESH_PNT_FLOATS_PER_VERTEX = 3 + 3 + 2;
+
+    // position = positionOffset + stored * positionScale, uv = uvOffset + stored * uvScale. Stored is the normalized
+    // value for unorm16 and the plain value for half floats, which always have a scale of 1.
+    struct MeshQuantization {
+        f32 positionOffset[3];
+        f32 positionScale[3];
+        f32 uvOffset[2];
+        f32 uvScale[2];
+    };
+
+    u32             MeshVertexFormatGetStride(MeshVertexFormat format);
+    const char*     MeshVertexFormatToString(MeshVertexFormat format);
+
+    // Rounds to nearest and clamps, the same conversions the input assembler does in reverse.
+    u16             QuantizeUnorm16(f32 value);
+    f32             DequantizeUnorm16(u16 value);
+    i16             QuantizeSnorm16(f32 value);
+    f32             DequantizeSnorm16(i16 value);
+
+    // IEEE half floats, round to nearest even. Out of range values become infinity.
+    u16             F32ToF16(f32 value);
+    f32             F16ToF32(u16 value);
+
+    // Octahedral unit vector encoding, the sphere is folded onto a square so two snorm16 values are enough.
+    void            OctahedralEncode(const f32* normal, i16* encoded);
+    void            OctahedralDecode(const i16* encoded, f32* normal);
+
+    // vertices are vertexCount PNT vertices, as packed by MeshDataPackPNT.
+    void            MeshQuantizationCompute(const f32* vertices, i32 vertexCount, MeshVertexFormat format, MeshQuantization& quantization);
+    void            MeshEncodeQuantized(const f32* vertices, i32 vertexCount, MeshVertexFormat format, const MeshQuantization& quantization, MeshQuantizedVertex* encoded);
+    void            MeshDecodeQuantized(const MeshQuantizedVertex* encoded, i32 vertexCount, MeshVertexFormat format, const MeshQuantization& quantization, f32* vertices);
+}
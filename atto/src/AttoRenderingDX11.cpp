@@ -5,13 +5,6 @@
 #define GLFW_EXPOSE_NATIVE_WIN32
 #include <GLFW/glfw3native.h>
 
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
-
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image/std_image.h>
-
 #include <string>
 
 namespace atto {
@@ -337,6 +330,9 @@ namespace atto {
             cbuffer InstanceData : register(b0) {
                 matrix mvp;
                 matrix model;
+                float4 positionOffset;
+                float4 positionScale;
+                float4 uvOffsetScale;
             }
 
             cbuffer CameraData : register(b1) {
@@ -345,11 +341,19 @@ namespace atto {
                 matrix screenProjection;
             };
 
+        #if QUANTIZED_VERTICES
+            struct VS_INPUT {
+                float4 position : POSITION;
+                float2 normal : NORMAL;
+                float2 uv : UV;
+            };
+        #else
             struct VS_INPUT {
                 float3 position : POSITION;
                 float3 normal : NORMAL;
                 float2 uv : UV;
             };
+        #endif
 
             struct VS_OUTPUT {
                 float4 position : SV_POSITION;
@@ -358,6 +362,25 @@ namespace atto {
                 float2 uv : UV;
             };
 
+        #if QUANTIZED_VERTICES
+            // Same as OctahedralDecode on the CPU.
+            float3 OctahedralDecode(float2 encoded) {
+                float3 n = float3(encoded.x, encoded.y, 1 - abs(encoded.x) - abs(encoded.y));
+                float t = saturate(-n.z);
+                n.xy += n.xy >= 0 ? -t : t;
+                return normalize(n);
+            }
+
+            VS_OUTPUT VSMain(VS_INPUT input) {
+                float3 position = positionOffset.xyz + input.position.xyz * positionScale.xyz;
+                VS_OUTPUT output;
+                output.position = mul(mvp, float4(position, 1));
+                output.worldPos =  mul(model, float4(position, 1)).xyz;
+                output.worldNrm =  mul(model, float4(OctahedralDecode(input.normal), 0)).xyz;
+                output.uv = uvOffsetScale.xy + input.uv * uvOffsetScale.zw;
+                return output;
+            }
+        #else
             VS_OUTPUT VSMain(VS_INPUT input) {
                 VS_OUTPUT output;
                 output.position = mul(mvp, float4(input.position, 1));
@@ -367,6 +390,7 @@ namespace atto {
                 output.uv = input.uv;
                 return output;
             }
+        #endif
 
             cbuffer Material : register(b0) {
                 float4 matSettings; // X = triplanars, Y = use textures,
@@ -442,8 +466,15 @@ namespace atto {
         )";
 
         ShaderCompile(testingShaderSource, INPUT_LAYOUT_POSITION_NORMAL_UV, renderer.testingShader);
+
+        // Unorm16 and half positions only differ in the input layout, the shader sees floats either way.
+        const std::string quantizedShaderSource = std::string("#define QUANTIZED_VERTICES 1\n") + testingShaderSource;
+        ShaderCompile(quantizedShaderSource.c_str(), INPUT_LAYOUT_POSITION_NORMAL_UV_QUANTIZED, renderer.testingShaderQuantized);
+        ShaderCompile(quantizedShaderSource.c_str(), INPUT_LAYOUT_POSITION_NORMAL_UV_QUANTIZED_HALF, renderer.testingShaderQuantizedHalf);
         
         MeshCreateUnitQuad(renderer.unitQuad);
+        // Drawn in place of meshes that are still loading.
+        MeshCreateUnitCube(renderer.unitCube);
         //MeshCreateHex(renderer.unitHex, Hex::outerRadius, Hex::innerRadius);
         
         ShaderBufferCreate(renderer.shaderBufferInstance);
@@ -531,6 +562,42 @@ namespace atto {
             list.Add(nrm);
             list.Add(txc);
         } break;
+
+        case atto::INPUT_LAYOUT_POSITION_NORMAL_UV_QUANTIZED:
+        case atto::INPUT_LAYOUT_POSITION_NORMAL_UV_QUANTIZED_HALF:
+        {
+            // MeshQuantizedVertex
+            D3D11_INPUT_ELEMENT_DESC pos = {};
+            pos.SemanticName = "Position";
+            pos.SemanticIndex = 0;
+            pos.Format = layout == INPUT_LAYOUT_POSITION_NORMAL_UV_QUANTIZED_HALF ? DXGI_FORMAT_R16G16B16A16_FLOAT : DXGI_FORMAT_R16G16B16A16_UNORM;
+            pos.InputSlot = 0;
+            pos.AlignedByteOffset = 0;
+            pos.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+            pos.InstanceDataStepRate = 0;
+
+            D3D11_INPUT_ELEMENT_DESC nrm = {};
+            nrm.SemanticName = "Normal";
+            nrm.SemanticIndex = 0;
+            nrm.Format = DXGI_FORMAT_R16G16_SNORM;
+            nrm.InputSlot = 0;
+            nrm.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+            nrm.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+            nrm.InstanceDataStepRate = 0;
+
+            D3D11_INPUT_ELEMENT_DESC txc = {};
+            txc.SemanticName = "UV";
+            txc.SemanticIndex = 0;
+            txc.Format = DXGI_FORMAT_R16G16_UNORM;
+            txc.InputSlot = 0;
+            txc.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+            txc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+            txc.InstanceDataStepRate = 0;
+
+            list.Add(pos);
+            list.Add(nrm);
+            list.Add(txc);
+        } break;
         default:
             Assert(0, "");
             break;
@@ -732,6 +799,53 @@ namespace atto {
         }
     }
 
+    void LeEngine::MeshCreateUnitCube(MeshAsset& cube) {
+        // One normal and two tangent axes per face, every face is two counter clockwise triangles.
+        const glm::vec3 faces[6][3] = {
+            { glm::vec3( 1, 0, 0), glm::vec3(0, 0, 1), glm::vec3(0, 1, 0) },
+            { glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, 1) },
+            { glm::vec3( 0, 1, 0), glm::vec3(1, 0, 0), glm::vec3(0, 0, 1) },
+            { glm::vec3( 0,-1, 0), glm::vec3(0, 0, 1), glm::vec3(1, 0, 0) },
+            { glm::vec3( 0, 0, 1), glm::vec3(0, 1, 0), glm::vec3(1, 0, 0) },
+            { glm::vec3( 0, 0,-1), glm::vec3(1, 0, 0), glm::vec3(0, 1, 0) },
+        };
+        const glm::vec2 corners[6] = { glm::vec2(0, 0), glm::vec2(1, 1), glm::vec2(1, 0), glm::vec2(0, 0), glm::vec2(0, 1), glm::vec2(1, 1) };
+
+        f32 vertices[36 * 8] = {};
+        for (i32 faceIndex = 0; faceIndex < 6; faceIndex++) {
+            const glm::vec3& normal = faces[faceIndex][0];
+            for (i32 cornerIndex = 0; cornerIndex < 6; cornerIndex++) {
+                const glm::vec2& uv = corners[cornerIndex];
+                const glm::vec3 pos = normal * 0.5f + faces[faceIndex][1] * (uv.x - 0.5f) + faces[faceIndex][2] * (uv.y - 0.5f);
+                f32* vertex = vertices + (faceIndex * 6 + cornerIndex) * 8;
+                vertex[0] = pos.x;      vertex[1] = pos.y;      vertex[2] = pos.z;
+                vertex[3] = normal.x;   vertex[4] = normal.y;   vertex[5] = normal.z;
+                vertex[6] = uv.x;       vertex[7] = uv.y;
+            }
+        }
+
+        cube.vertexCount = 36;
+        cube.vertexStride = (3 + 3 + 2) * sizeof(f32);
+        cube.indexCount = 0;
+
+        D3D11_BUFFER_DESC vertexDesc = {};
+        vertexDesc.Usage = D3D11_USAGE_IMMUTABLE;
+        vertexDesc.ByteWidth = sizeof(vertices);
+        vertexDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+        vertexDesc.CPUAccessFlags = 0;
+        vertexDesc.MiscFlags = 0;
+
+        D3D11_SUBRESOURCE_DATA vertexData = {};
+        vertexData.pSysMem = vertices;
+
+        if (FAILED(renderer.device->CreateBuffer(&vertexDesc, &vertexData, &cube.vertexBuffer))) {
+            ATTOERROR("Could not create vertex buffer");
+            return;
+        }
+
+        cube.isLoaded = true;
+    }
+
     void LeEngine::MeshCreateHex(MeshAsset& hex, f32 outerRadius, f32 innerRadius) {
         glm::vec3 center = glm::vec3(0, 0, 0);
         glm::vec3 normal = glm::vec3(0, 1, 0);
@@ -773,231 +887,444 @@ namespace atto {
         }
     }
 
-    static void ProcessMesh(aiMesh* mesh, const aiScene* scene, MeshData& resultingMesh) {
-        resultingMesh.positions.Resize(mesh->mNumVertices);
-        resultingMesh.normals.Resize(mesh->mNumVertices);
-        resultingMesh.uvs.Resize(mesh->mNumVertices);
-        resultingMesh.indices.Resize(mesh->mNumFaces * 3);
+    static void MeshLoadJobRun(i32 index, void* userData) {
+        MeshLoadJob* job = (MeshLoadJob*)userData;
+        if (job->packEntry != nullptr) {
+            job->data = job->stored.GetNum() > 0 ?
+                job->pack->DecodePayload(*job->packEntry, job->stored.GetData(), job->payload) :
+                job->pack->GetPayload(*job->packEntry, job->payload);
+            job->sizeBytes = job->data != nullptr ? job->packEntry->sizeBytes : 0;
+        }
 
-        for (u32 vertexIndex = 0; vertexIndex < mesh->mNumVertices; vertexIndex++) {
-            glm::vec3 position = {};
-            position.x = mesh->mVertices[vertexIndex].x;
-            position.y = mesh->mVertices[vertexIndex].y;
-            position.z = mesh->mVertices[vertexIndex].z;
+        if (job->data != nullptr && CookedMeshRead(job->data, job->sizeBytes, job->packed)) {
+            job->succeeded = true;
+            return;
+        }
 
-            position = position;
+        // Import, optimise and pack the same way the cooker does. The cooked blob outlives the scratch memory
+        // of whichever thread ran this, so the render thread can read it later.
+        CookSettings settings;
+        const char* path = job->mesh->path.GetCStr();
+
+        // Loose files are only mapped to hash them, Assimp still reads them from path so sidecar files resolve.
+        u64 cacheKey = 0;
+        if (job->derivedData != nullptr) {
+            MappedFile source;
+            const byte* sourceData = job->data;
+            u64 sourceSize = job->sizeBytes;
+            if (sourceData == nullptr && source.Open(path)) {
+                sourceData = source.GetData();
+                sourceSize = source.GetSize();
+            }
 
-            glm::vec3 normal = {};
-            normal.x = mesh->mNormals[vertexIndex].x;
-            normal.y = mesh->mNormals[vertexIndex].y;
-            normal.z = mesh->mNormals[vertexIndex].z;
+            if (sourceData != nullptr) {
+                cacheKey = DerivedDataCache::MakeKey(ASSET_TYPE_MESH, path, sourceData, sourceSize, CookAssetGetFlags(ASSET_TYPE_MESH, settings));
+                if (job->derivedData->Get(cacheKey, job->blob) && CookedMeshRead(job->blob.GetData(), (u64)job->blob.GetNum(), job->packed)) {
+                    job->succeeded = true;
+                    return;
+                }
+            }
+        }
 
-            glm::vec3 tex = {};
-            tex.x = mesh->mTextureCoords[0][vertexIndex].x;
-            tex.y = mesh->mTextureCoords[0][vertexIndex].y;
+        job->succeeded = CookAsset(ASSET_TYPE_MESH, path, job->data, job->sizeBytes, 0, settings, job->blob) &&
+            CookedMeshRead(job->blob.GetData(), (u64)job->blob.GetNum(), job->packed);
 
-            resultingMesh.positions.Add(position);
-            resultingMesh.normals.Add(normal);
-            resultingMesh.uvs.Add(tex);
+        if (job->succeeded && cacheKey != 0) {
+            job->derivedData->Put(cacheKey, job->blob.GetData(), (u64)job->blob.GetNum());
         }
+    }
 
-        for (u32 faceIndex = 0; faceIndex < mesh->mNumFaces; faceIndex++) {
-            aiFace face = mesh->mFaces[faceIndex];
-            for (u32 index = 0; index < face.mNumIndices; index++) {
-                Assert(face.mNumIndices == 3, "Not triangluated");
-                Assert(face.mIndices[index] < UINT16_MAX, "Too many vertices, index too large");
-                resultingMesh.indices.Add((u16)face.mIndices[index]);
-            }
+    // Runs on the main thread from AsyncIO::Poll, the decode and import go to the workers.
+    static void MeshLoadJobReadComplete(const IOCompletion& completion, void* userData) {
+        MeshLoadJob* job = (MeshLoadJob*)userData;
+        if (completion.succeeded == false || completion.bytesRead != completion.sizeBytes) {
+            ATTOWARN("Could not read %s from the pack, using the mapping", job->mesh->path.GetCStr());
+            job->stored.Clear();
         }
-    }
 
-    static void ProcessNode(aiNode* node, const aiScene* scene, List<MeshData>& meshes) {
-        for (u32 i = 0; i < node->mNumMeshes; i++) {
-            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+        job->isReading = false;
+        Jobs::Submit(MeshLoadJobRun, job, &job->counter);
+    }
 
-            MeshData &meshData = meshes.Alloc();
-            meshData.name = mesh->mName.C_Str();
-            
-            ProcessMesh(mesh, scene, meshData);
-            break;
+    void LeEngine::MeshCreate(MeshAsset& mesh) {
+        if (MeshShare(mesh)) {
+            return;
         }
 
-        for (u32 i = 0; i < node->mNumChildren; i++) {
-            ProcessNode(node->mChildren[i], scene, meshes);
-        }
+        const AssetPackEntry* packed = assetPack.Find(mesh.id);
+
+        MeshLoadJob job = {};
+        job.mesh = &mesh;
+        job.pack = &assetPack;
+        job.packEntry = packed;
+        job.derivedData = derivedData.IsOpen() ? &derivedData : nullptr;
+        MeshLoadJobRun(0, &job);
+        MeshFinishLoad(job);
     }
 
-    void LeEngine::MeshDataPackPNT(const MeshData& meshData, const glm::mat3& scalingMatrix, List<f32>& data) {
-        Assert(meshData.positions.GetNum() == meshData.normals.GetNum(), "Positions and normals must be the same size");
-        Assert(meshData.positions.GetNum() == meshData.uvs.GetNum(), "Positions and uvs must be the same size");
+    void LeEngine::MeshCreateAsync(MeshAsset& mesh) {
+        if (MeshShare(mesh)) {
+            return;
+        }
 
-        const i32 vertexCount = meshData.positions.GetNum();
-        for (i32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++) {
-            glm::vec3 position = scalingMatrix * meshData.positions[vertexIndex];
-            
-            data.Add(position.x);
-            data.Add(position.y);
-            data.Add(position.z);
+        if (meshLoadJobs.IsFull()) {
+            MeshCreate(mesh);
+            return;
+        }
 
-            data.Add(meshData.normals[vertexIndex].x);
-            data.Add(meshData.normals[vertexIndex].y);
-            data.Add(meshData.normals[vertexIndex].z);
+        const AssetPackEntry* packed = assetPack.Find(mesh.id);
+
+        MeshLoadJob* job = new MeshLoadJob();
+        job->mesh = &mesh;
+        job->pack = &assetPack;
+        job->packEntry = packed;
+        job->derivedData = derivedData.IsOpen() ? &derivedData : nullptr;
+        mesh.isLoading = true;
+        meshLoadJobs.Add(job);
+
+        // Stored entries stream in through AsyncIO, so a level's worth of meshes can be in flight at once instead
+        // of every worker blocking on page faults in the mapping.
+        if (packed != nullptr && packed->storedSizeBytes > 0 && io.GetBackend() != IO_BACKEND_NONE) {
+            job->stored.SetNum((i32)packed->storedSizeBytes, false);
+            job->isReading = true;
+            const IORead read = IOReadPackEntry(assetPack, *packed, job->stored.GetData(), MeshLoadJobReadComplete, job);
+            io.Submit(&read, 1);
+            return;
+        }
 
-            data.Add(meshData.uvs[vertexIndex].x);
-            data.Add(meshData.uvs[vertexIndex].y);
+        Jobs::Submit(MeshLoadJobRun, job, &job->counter);
+    }
+
+    void LeEngine::MeshWaitForLoad(MeshLoadJob& job) {
+        // The job isn't submitted until its read completes, and completions only arrive through Poll.
+        while (job.isReading) {
+            io.Poll();
+            std::this_thread::yield();
         }
+
+        Jobs::Wait(&job.counter);
     }
 
-    void LeEngine::MeshCreate(MeshAsset& mesh) {
-        Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(mesh.path.GetCStr(), aiProcess_Triangulate | aiProcess_JoinIdenticalVertices );
-        
-        if (scene == nullptr || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-            ATTOFATAL("ERROR::ASSIMP::%s", importer.GetErrorString());
+    void LeEngine::MeshFinishLoad(MeshLoadJob& job) {
+        MeshAsset& mesh = *job.mesh;
+        mesh.isLoading = false;
+        if (job.succeeded == false) {
+            ATTOERROR("Could not load mesh: %s", mesh.path.GetCStr());
             return;
         }
 
-        List<MeshData> meshes;
-        ProcessNode(scene->mRootNode, scene, meshes);
-        
-        const i32 meshCount = meshes.GetNum();
-        Assert(meshCount == 1, "Only one mesh supported right now");
+        // A job for an identical payload may have finished first.
+        if (MeshShare(mesh)) {
+            return;
+        }
 
-        glm::mat3 scalingMatrix = glm::mat3(1);
-        if (mesh.path.EndsWith("fbx")) {
-            scalingMatrix = glm::scale(glm::mat4(1), glm::vec3(0.01f));
+        if (MeshCreateBuffers(mesh, job.packed)) {
+            ATTOTRACE("Loaded %smesh: %s, %d submeshes", job.blob.GetNum() == 0 ? "cooked " : "", mesh.path.GetCStr(), (i32)job.packed.submeshCount);
         }
+    }
 
-        MeshData& meshData = meshes[0];
-        List<f32> vertices;
-        MeshDataPackPNT(meshData, scalingMatrix, vertices);
+    bool LeEngine::MeshCreateBuffers(MeshAsset& mesh, const MeshPacked& packed) {
+        const u32 vertexStride = MeshVertexFormatGetStride(packed.vertexFormat);
 
         // Create vertex buffer
         D3D11_BUFFER_DESC vertexDesc = {};
         vertexDesc.Usage = D3D11_USAGE_IMMUTABLE;
-        vertexDesc.ByteWidth = vertices.GetNum() * sizeof(f32);
+        vertexDesc.ByteWidth = packed.vertexCount * vertexStride;
         vertexDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
         vertexDesc.CPUAccessFlags = 0;
         vertexDesc.MiscFlags = 0;
         
         D3D11_SUBRESOURCE_DATA vertexData = {};
-        vertexData.pSysMem = vertices.GetData();
+        vertexData.pSysMem = packed.vertices;
         
         if (FAILED(renderer.device->CreateBuffer(&vertexDesc, &vertexData, &mesh.vertexBuffer))) {
             ATTOERROR("Could not create vertex buffer");
-            return;
+            return false;
         }
 
-        // Create index buffer
+        // Create index buffer, every submesh shares it
         D3D11_BUFFER_DESC indexDesc = {};
         indexDesc.Usage = D3D11_USAGE_IMMUTABLE;
-        indexDesc.ByteWidth = meshData.indices.GetNum() * sizeof(u16);
+        indexDesc.ByteWidth = packed.indexCount * packed.indexStride;
         indexDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
         indexDesc.CPUAccessFlags = 0;
         indexDesc.MiscFlags = 0;
 
         D3D11_SUBRESOURCE_DATA indexData = {};
-        indexData.pSysMem = meshData.indices.GetData();
+        indexData.pSysMem = packed.indices;
         
         if (FAILED(renderer.device->CreateBuffer(&indexDesc, &indexData, &mesh.indexBuffer))) {
             ATTOERROR("Could not create index buffer");
-            return;
+            return false;
         }
 
         mesh.isLoaded = true;
-        mesh.indexCount = meshData.indices.GetNum();
-        mesh.vertexCount = meshData.positions.GetNum();
-        mesh.vertexStride = sizeof(f32) * (3 + 3 + 2);
+        mesh.indexCount = packed.indexCount;
+        mesh.indexStride = packed.indexStride;
+        mesh.vertexCount = packed.vertexCount;
+        mesh.vertexStride = vertexStride;
+        mesh.vertexFormat = packed.vertexFormat;
+        mesh.quantization = packed.quantization;
+        mesh.submeshes.SetNum((i32)packed.submeshCount);
+        for (u32 submeshIndex = 0; submeshIndex < packed.submeshCount; submeshIndex++) {
+            mesh.submeshes[(i32)submeshIndex] = packed.submeshes[submeshIndex];
+        }
+
+        assetMemory.meshBytes += mesh.GetSizeBytes();
+        if (mesh.payloadOffset != 0 && meshPayloadHolders.Find(mesh.payloadOffset) == nullptr) {
+            meshPayloadHolders.Add(mesh.payloadOffset, &mesh);
+        }
+
+        return true;
+    }
+
+    // Empty payloads start where the next one does, so they are never shared.
+    static u64 AssetPackGetSharedOffset(const AssetPackEntry* packed) {
+        return packed != nullptr && packed->storedSizeBytes > 0 ? packed->offset : 0;
+    }
+
+    bool LeEngine::MeshShare(MeshAsset& mesh) {
+        mesh.payloadOffset = AssetPackGetSharedOffset(assetPack.Find(mesh.id));
+        MeshAsset** holder = mesh.payloadOffset != 0 ? meshPayloadHolders.Find(mesh.payloadOffset) : nullptr;
+        if (holder == nullptr || *holder == &mesh) {
+            return false;
+        }
+
+        const MeshAsset& source = **holder;
+        mesh.vertexBuffer = source.vertexBuffer;
+        mesh.indexBuffer = source.indexBuffer;
+        mesh.vertexCount = source.vertexCount;
+        mesh.vertexStride = source.vertexStride;
+        mesh.indexCount = source.indexCount;
+        mesh.indexStride = source.indexStride;
+        mesh.vertexFormat = source.vertexFormat;
+        mesh.quantization = source.quantization;
+        mesh.submeshes = source.submeshes;
+        mesh.isLoaded = true;
+
+        ATTOTRACE("Loaded mesh: %s, sharing the buffers of %s", mesh.path.GetCStr(), source.path.GetCStr());
+
+        return true;
+    }
+
+    void LeEngine::MeshDestroy(MeshAsset& mesh) {
+        if (mesh.isLoaded == false) {
+            return;
+        }
+
+        if (ReleasePayload(meshAssets, meshPayloadHolders, mesh)) {
+            assetMemory.meshBytes -= mesh.GetSizeBytes();
+        }
 
-        ATTOTRACE("Loaded mesh: %s", mesh.path.GetCStr());
+        mesh.vertexBuffer.Reset();
+        mesh.indexBuffer.Reset();
+        mesh.submeshes.Clear();
+        mesh.vertexCount = 0;
+        mesh.indexCount = 0;
+        mesh.isLoaded = false;
+    }
+
+    ShaderAsset* LeEngine::MeshGetShader(MeshAsset* mesh) {
+        switch (mesh->vertexFormat)
+        {
+        case MESH_VERTEX_FORMAT_QUANTIZED: return &renderer.testingShaderQuantized;
+        case MESH_VERTEX_FORMAT_QUANTIZED_HALF: return &renderer.testingShaderQuantizedHalf;
+        default: return &renderer.testingShader;
+        }
+    }
+
+    static DXGI_FORMAT TextureFormatToDXGI(TextureFormat format) {
+        switch (format)
+        {
+        case TEXTURE_FORMAT_BC1: return DXGI_FORMAT_BC1_UNORM;
+        case TEXTURE_FORMAT_BC3: return DXGI_FORMAT_BC3_UNORM;
+        case TEXTURE_FORMAT_BC4: return DXGI_FORMAT_BC4_UNORM;
+        case TEXTURE_FORMAT_BC7: return DXGI_FORMAT_BC7_UNORM;
+        default: return DXGI_FORMAT_R8G8B8A8_UNORM;
+        }
+    }
+
+    void LeEngine::TextureGetSource(TextureAsset& texture, MappedFile& looseFile, List<byte>& storage, const byte*& data, u64& sizeBytes) {
+        data = nullptr;
+        sizeBytes = 0;
+        const AssetPackEntry* packed = assetPack.Find(texture.id);
+        if (packed != nullptr) {
+            data = assetPack.GetPayload(*packed, storage);
+            sizeBytes = data != nullptr ? packed->sizeBytes : 0;
+        }
+        else if (looseFile.Open(texture.path.GetCStr())) {
+            data = looseFile.GetData();
+            sizeBytes = looseFile.GetSize();
+        }
+    }
+
+    bool LeEngine::TextureShare(TextureAsset& texture) {
+        texture.payloadOffset = AssetPackGetSharedOffset(assetPack.Find(texture.id));
+        TextureAsset** holder = texture.payloadOffset != 0 ? texturePayloadHolders.Find(texture.payloadOffset) : nullptr;
+        if (holder == nullptr || *holder == &texture) {
+            return false;
+        }
+
+        // Same bytes but a different mip setting, it gets its own texture.
+        const TextureAsset& source = **holder;
+        if (source.generateMipMaps != texture.generateMipMaps) {
+            texture.payloadOffset = 0;
+            return false;
+        }
+
+        texture.texture = source.texture;
+        texture.srv = source.srv;
+        texture.width = source.width;
+        texture.height = source.height;
+        texture.channels = source.channels;
+        texture.format = source.format;
+        texture.mipCount = source.mipCount;
+        texture.isLoaded = true;
+
+        ATTOTRACE("Loaded texture: %s, sharing %s", texture.path.GetCStr(), source.path.GetCStr());
+
+        return true;
     }
 
     void LeEngine::TextureCreate(TextureAsset& texture) {
-        stbi_set_flip_vertically_on_load(true);
-        void* pixelData = stbi_load(texture.path.GetCStr(), &texture.width, &texture.height, &texture.channels, 4);
-        if (pixelData == nullptr) {
+        if (TextureShare(texture)) {
+            return;
+        }
+
+        MappedFile looseFile;
+        List<byte> storage;
+        const byte* data = nullptr;
+        u64 sizeBytes = 0;
+        TextureGetSource(texture, looseFile, storage, data, sizeBytes);
+
+        CookedTexture cooked = {};
+        if (data != nullptr && CookedTextureRead(data, sizeBytes, cooked)) {
+            TextureCreateFromCooked(texture, cooked);
+            return;
+        }
+
+        i32 width = 0;
+        i32 height = 0;
+        i32 channels = 0;
+        byte* pixels = data != nullptr ? TextureImport(data, sizeBytes, width, height, channels) : nullptr;
+        TextureCreateFromImage(texture, pixels, width, height, channels);
+        if (pixels != nullptr) {
+            TextureImportFree(pixels);
+        }
+    }
+
+    void LeEngine::TextureCreateFromCooked(TextureAsset& texture, const CookedTexture& cooked) {
+        texture.width = cooked.header->width;
+        texture.height = cooked.header->height;
+        texture.channels = cooked.header->channels;
+        texture.format = (TextureFormat)cooked.header->format;
+        TextureCreateFromLevels(texture, cooked.pixels, cooked.header->mipCount);
+    }
+
+    void LeEngine::TextureCreateFromImage(TextureAsset& texture, const byte* pixels, i32 width, i32 height, i32 channels) {
+        if (pixels == nullptr) {
             ATTOERROR("Could not load texture: %s", texture.path.GetCStr());
             return;
         }
 
-        bool generateMipMaps = true;
-        if (generateMipMaps == false) {
-            D3D11_TEXTURE2D_DESC textureDesc = {};
-            textureDesc.Width = texture.width;
-            textureDesc.Height = texture.height;
-            textureDesc.MipLevels = 1;
-            textureDesc.ArraySize = 1;
-            textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-            textureDesc.SampleDesc.Count = 1;
-            textureDesc.SampleDesc.Quality = 0;
-            textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
-            textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-            textureDesc.CPUAccessFlags = 0;
-            textureDesc.MiscFlags = 0;
-
-            D3D11_SUBRESOURCE_DATA textureData = {};
-            textureData.pSysMem = pixelData;
-            textureData.SysMemPitch = texture.width * 4;
-            textureData.SysMemSlicePitch = 0;
-
-            if (FAILED(renderer.device->CreateTexture2D(&textureDesc, &textureData, &texture.texture))) {
-                ATTOERROR("Could not create texture: %s", texture.path.GetCStr());
-                return;
-            }
+        texture.width = width;
+        texture.height = height;
+        texture.channels = channels;
+        texture.format = TEXTURE_FORMAT_RGBA8;
+        if (channels == 4) {
+            TextureCreateFromLevels(texture, pixels, 1);
+            return;
+        }
 
-            D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc = {};
-            shaderResourceViewDesc.Format = textureDesc.Format;
-            shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-            shaderResourceViewDesc.Texture2D.MostDetailedMip = 0;
-            shaderResourceViewDesc.Texture2D.MipLevels = 1;
+        // There is no RGB8 format and the material shaders read every channel, everything else goes up as RGBA8.
+        List<byte> rgba;
+        rgba.SetNum(width * height * 4);
+        TextureExpandRGBA8(pixels, channels, (u64)width * height, rgba.GetData());
+        TextureCreateFromLevels(texture, rgba.GetData(), 1);
+    }
 
-            if (FAILED(renderer.device->CreateShaderResourceView(texture.texture.Get(), &shaderResourceViewDesc, &texture.srv))) {
-                ATTOERROR("Could not create shader resource view: %s", texture.path.GetCStr());
-                return;
-            }
+    void LeEngine::TextureCreateFromLevels(TextureAsset& texture, const byte* pixels, i32 availableMipCount) {
+        i32 mipCount = texture.generateMipMaps ? TextureMipGetCount(texture.width, texture.height) : 1;
+        if (TextureFormatIsCompressed(texture.format)) {
+            // Block compressed mips can only come from the cooker.
+            mipCount = mipCount < availableMipCount ? mipCount : availableMipCount;
+        }
 
+        if (availableMipCount >= mipCount) {
+            TextureCreateFromMips(texture, pixels, mipCount);
+            return;
         }
-        else {
-            D3D11_TEXTURE2D_DESC textureDesc = {};
-            textureDesc.Width = texture.width;
-            textureDesc.Height = texture.height;
-            textureDesc.MipLevels = 0;
-            textureDesc.ArraySize = 1;
-            textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-            textureDesc.SampleDesc.Count = 1;
-            textureDesc.SampleDesc.Quality = 0;
-            textureDesc.Usage = D3D11_USAGE_DEFAULT;
-            textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
-            textureDesc.CPUAccessFlags = 0;
-            textureDesc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
-
-            if (FAILED(renderer.device->CreateTexture2D(&textureDesc, nullptr, &texture.texture))) {
-                ATTOERROR("Could not create texture: %s", texture.path.GetCStr());
-                return;
-            }
 
-            D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc = {};
-            shaderResourceViewDesc.Format = textureDesc.Format;
-            shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-            shaderResourceViewDesc.Texture2D.MostDetailedMip = 0;
-            shaderResourceViewDesc.Texture2D.MipLevels = -1;
+        // Loose files and textures cooked without mips, filter the chain here on the workers.
+        List<byte> chain;
+        chain.SetNum((i32)TextureMipGetChainSizeBytes(texture.width, texture.height, mipCount));
+        memcpy(chain.GetData(), pixels, (u64)texture.width * texture.height * 4);
+        TextureMipGenerateChain(chain.GetData(), texture.width, texture.height, mipCount, TextureMipSettings());
+        TextureCreateFromMips(texture, chain.GetData(), mipCount);
+    }
 
-            if (FAILED(renderer.device->CreateShaderResourceView(texture.texture.Get(), &shaderResourceViewDesc, &texture.srv))) {
-                ATTOERROR("Could not create shader resource view: %s", texture.path.GetCStr());
-                return;
-            }
+    bool LeEngine::TextureCreateFromMips(TextureAsset& texture, const byte* mips, i32 mipCount) {
+        // Every level is known up front, so the texture is created once and never written again.
+        D3D11_SUBRESOURCE_DATA textureData[D3D11_REQ_MIP_LEVELS] = {};
+        Assert(mipCount >= 1 && mipCount <= D3D11_REQ_MIP_LEVELS, "Invalid mip count");
+        for (i32 mip = 0; mip < mipCount; mip++) {
+            textureData[mip].pSysMem = mips + TextureFormatGetMipOffset(texture.format, texture.width, texture.height, mip);
+            textureData[mip].SysMemPitch = TextureFormatGetRowPitch(texture.format, TextureMipGetSize(texture.width, mip));
+            textureData[mip].SysMemSlicePitch = 0;
+        }
 
-            renderer.context->UpdateSubresource(texture.texture.Get(), 0, nullptr, pixelData, texture.width * 4, 0);
-            renderer.context->GenerateMips(texture.srv.Get());
+        D3D11_TEXTURE2D_DESC textureDesc = {};
+        textureDesc.Width = texture.width;
+        textureDesc.Height = texture.height;
+        textureDesc.MipLevels = mipCount;
+        textureDesc.ArraySize = 1;
+        textureDesc.Format = TextureFormatToDXGI(texture.format);
+        textureDesc.SampleDesc.Count = 1;
+        textureDesc.SampleDesc.Quality = 0;
+        textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+        textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        textureDesc.CPUAccessFlags = 0;
+        textureDesc.MiscFlags = 0;
+
+        if (FAILED(renderer.device->CreateTexture2D(&textureDesc, textureData, &texture.texture))) {
+            ATTOERROR("Could not create texture: %s", texture.path.GetCStr());
+            return false;
         }
 
-        texture.isLoaded = true;
+        D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc = {};
+        shaderResourceViewDesc.Format = textureDesc.Format;
+        shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        shaderResourceViewDesc.Texture2D.MostDetailedMip = 0;
+        shaderResourceViewDesc.Texture2D.MipLevels = mipCount;
+
+        if (FAILED(renderer.device->CreateShaderResourceView(texture.texture.Get(), &shaderResourceViewDesc, &texture.srv))) {
+            ATTOERROR("Could not create shader resource view: %s", texture.path.GetCStr());
+            return false;
+        }
 
-        stbi_image_free(pixelData);
+        texture.isLoaded = true;
+        texture.mipCount = mipCount;
+        assetMemory.textureBytes += texture.GetSizeBytes();
+        if (texture.payloadOffset != 0 && texturePayloadHolders.Find(texture.payloadOffset) == nullptr) {
+            texturePayloadHolders.Add(texture.payloadOffset, &texture);
+        }
         
-        ATTOTRACE("Loaded texture: %s", texture.path.GetCStr());
+        ATTOTRACE("Loaded texture: %s, %s, %d mips", texture.path.GetCStr(), TextureFormatToString(texture.format), mipCount);
+
+        return true;
     }
 
+    void LeEngine::TextureDestroy(TextureAsset& texture) {
+        if (texture.isLoaded == false) {
+            return;
+        }
 
-}
+        if (ReleasePayload(textureAssets, texturePayloadHolders, texture)) {
+            assetMemory.textureBytes -= texture.GetSizeBytes();
+        }
 
+        texture.srv.Reset();
+        texture.texture.Reset();
+        texture.isLoaded = false;
+    }
+}
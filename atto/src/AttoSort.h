@@ -0,0 +1,281 @@
+#pragma once
+
+#include "AttoDefines.h"
+#include "AttoMemory.h"
+
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace atto
+{
+    // Default ordering for IntroSort and StableSort.
+    struct SortLess {
+        template<typename _type_>
+        bool operator()(const _type_& a, const _type_& b) const {
+            return a < b;
+        }
+    };
+
+    // Unstable in place sort. Quicksort with a median of three pivot, insertion sort for small ranges and
+    // heapsort once the recursion gets too deep, so the worst case stays O(n log n). The comparator is a
+    // template parameter so it gets inlined, unlike qsort.
+    template<typename _type_, typename _less_ = SortLess>
+    void IntroSort(_type_* data, i32 count, _less_ less = _less_());
+
+    // Stable merge sort, insertion sorted runs merged bottom up. The temporary buffer comes from the scratch arena.
+    template<typename _type_, typename _less_ = SortLess>
+    void StableSort(_type_* data, i32 count, _less_ less = _less_());
+
+    // Stable LSD radix sort, 8 bits per pass. getKey returns a u32 or u64 per element, passes where every key has
+    // the same digit are skipped. The temporary buffer comes from the scratch arena.
+    template<typename _type_, typename _key_>
+    void RadixSort(_type_* data, i32 count, _key_ getKey);
+
+    // Maps floats/signed integers onto unsigned keys that sort in the same order, for use with RadixSort.
+    inline u32 RadixKeyFromF32(f32 value) {
+        u32 bits = 0;
+        memcpy(&bits, &value, sizeof(bits));
+        const u32 mask = (u32)(-(i32)(bits >> 31)) | 0x80000000;
+        return bits ^ mask;
+    }
+
+    inline u32 RadixKeyFromI32(i32 value) {
+        return (u32)value ^ 0x80000000;
+    }
+
+    namespace SortInternal
+    {
+        constexpr i32 INSERTION_SORT_THRESHOLD = 16;
+
+        template<typename _type_, typename _less_>
+        void InsertionSort(_type_* data, i32 count, _less_& less) {
+            for (i32 i = 1; i < count; i++) {
+                if (less(data[i], data[i - 1]) == false) {
+                    continue;
+                }
+
+                _type_ value = std::move(data[i]);
+                i32 j = i;
+                do {
+                    data[j] = std::move(data[j - 1]);
+                    j--;
+                } while (j > 0 && less(value, data[j - 1]));
+                data[j] = std::move(value);
+            }
+        }
+
+        template<typename _type_, typename _less_>
+        void SiftDown(_type_* data, i32 root, i32 count, _less_& less) {
+            _type_ value = std::move(data[root]);
+            for (;;) {
+                i32 child = root * 2 + 1;
+                if (child >= count) {
+                    break;
+                }
+                if (child + 1 < count && less(data[child], data[child + 1])) {
+                    child++;
+                }
+                if (less(value, data[child]) == false) {
+                    break;
+                }
+                data[root] = std::move(data[child]);
+                root = child;
+            }
+            data[root] = std::move(value);
+        }
+
+        template<typename _type_, typename _less_>
+        void HeapSort(_type_* data, i32 count, _less_& less) {
+            for (i32 i = count / 2 - 1; i >= 0; i--) {
+                SiftDown(data, i, count, less);
+            }
+            for (i32 i = count - 1; i > 0; i--) {
+                std::swap(data[0], data[i]);
+                SiftDown(data, 0, i, less);
+            }
+        }
+
+        template<typename _type_, typename _less_>
+        void IntroSortLoop(_type_* data, i32 count, i32 depthLimit, _less_& less) {
+            while (count > INSERTION_SORT_THRESHOLD) {
+                if (depthLimit == 0) {
+                    HeapSort(data, count, less);
+                    return;
+                }
+                depthLimit--;
+
+                // Median of three into data[0], which also makes sure both scans below stop inside the range.
+                const i32 mid = count / 2;
+                const i32 last = count - 1;
+                if (less(data[mid], data[0])) {
+                    std::swap(data[mid], data[0]);
+                }
+                if (less(data[last], data[mid])) {
+                    std::swap(data[last], data[mid]);
+                    if (less(data[mid], data[0])) {
+                        std::swap(data[mid], data[0]);
+                    }
+                }
+                std::swap(data[0], data[mid]);
+
+                i32 i = 0;
+                i32 j = count;
+                for (;;) {
+                    do { i++; } while (less(data[i], data[0]));
+                    do { j--; } while (less(data[0], data[j]));
+                    if (i >= j) {
+                        break;
+                    }
+                    std::swap(data[i], data[j]);
+                }
+                std::swap(data[0], data[j]);
+
+                // Recurse into the smaller side and loop on the larger one to bound the stack depth.
+                const i32 leftCount = j;
+                const i32 rightCount = count - j - 1;
+                if (leftCount < rightCount) {
+                    IntroSortLoop(data, leftCount, depthLimit, less);
+                    data += j + 1;
+                    count = rightCount;
+                }
+                else {
+                    IntroSortLoop(data + j + 1, rightCount, depthLimit, less);
+                    count = leftCount;
+                }
+            }
+
+            InsertionSort(data, count, less);
+        }
+
+        // Merges the sorted runs [0, mid) and [mid, count). The left run is moved out to temp first.
+        template<typename _type_, typename _less_>
+        void Merge(_type_* data, i32 mid, i32 count, _type_* temp, _less_& less) {
+            for (i32 i = 0; i < mid; i++) {
+                new (temp + i) _type_(std::move(data[i]));
+            }
+
+            i32 left = 0;
+            i32 right = mid;
+            i32 out = 0;
+            while (left < mid && right < count) {
+                if (less(data[right], temp[left])) {
+                    data[out++] = std::move(data[right++]);
+                }
+                else {
+                    data[out++] = std::move(temp[left++]);
+                }
+            }
+            while (left < mid) {
+                data[out++] = std::move(temp[left++]);
+            }
+
+            if constexpr (!std::is_trivially_destructible<_type_>::value) {
+                for (i32 i = 0; i < mid; i++) {
+                    temp[i].~_type_();
+                }
+            }
+        }
+
+        template<typename _type_, typename _key_>
+        void RadixSortPasses(_type_* data, _type_* temp, i32 count, _key_& getKey) {
+            typedef typename std::decay<decltype(getKey(*data))>::type keyType;
+            static_assert(std::is_same<keyType, u32>::value || std::is_same<keyType, u64>::value, "RadixSort keys must be u32 or u64");
+            constexpr i32 passCount = (i32)sizeof(keyType);
+
+            // Histogram every digit in one pass over the data.
+            u32 histograms[passCount][256] = {};
+            for (i32 i = 0; i < count; i++) {
+                const keyType key = getKey(data[i]);
+                for (i32 pass = 0; pass < passCount; pass++) {
+                    histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+                }
+            }
+
+            _type_* src = data;
+            _type_* dst = temp;
+            for (i32 pass = 0; pass < passCount; pass++) {
+                u32* histogram = histograms[pass];
+                const i32 shift = pass * 8;
+
+                if (histogram[(getKey(src[0]) >> shift) & 0xFF] == (u32)count) {
+                    continue;
+                }
+
+                u32 offset = 0;
+                for (i32 digit = 0; digit < 256; digit++) {
+                    const u32 digitCount = histogram[digit];
+                    histogram[digit] = offset;
+                    offset += digitCount;
+                }
+
+                for (i32 i = 0; i < count; i++) {
+                    const u32 digit = (u32)((getKey(src[i]) >> shift) & 0xFF);
+                    dst[histogram[digit]++] = src[i];
+                }
+
+                _type_* swap = src;
+                src = dst;
+                dst = swap;
+            }
+
+            if (src != data) {
+                memcpy(data, src, sizeof(_type_) * (u64)count);
+            }
+        }
+    }
+
+    template<typename _type_, typename _less_>
+    void IntroSort(_type_* data, i32 count, _less_ less) {
+        if (count < 2) {
+            return;
+        }
+
+        i32 depthLimit = 0;
+        for (i32 n = count; n > 1; n >>= 1) {
+            depthLimit += 2;
+        }
+
+        SortInternal::IntroSortLoop(data, count, depthLimit, less);
+    }
+
+    template<typename _type_, typename _less_>
+    void StableSort(_type_* data, i32 count, _less_ less) {
+        constexpr i32 runLength = 32;
+        if (count <= runLength) {
+            SortInternal::InsertionSort(data, count, less);
+            return;
+        }
+
+        for (i32 start = 0; start < count; start += runLength) {
+            const i32 runCount = count - start < runLength ? count - start : runLength;
+            SortInternal::InsertionSort(data + start, runCount, less);
+        }
+
+        ScratchScope scratch;
+        _type_* temp = Memory::AllocateScratchStruct<_type_>(count);
+
+        for (i32 width = runLength; width < count; width *= 2) {
+            for (i32 start = 0; start + width < count; start += width * 2) {
+                const i32 mergeCount = count - start < width * 2 ? count - start : width * 2;
+                // Runs that are already in order don't need merging.
+                if (less(data[start + width], data[start + width - 1])) {
+                    SortInternal::Merge(data + start, width, mergeCount, temp, less);
+                }
+            }
+        }
+    }
+
+    template<typename _type_, typename _key_>
+    void RadixSort(_type_* data, i32 count, _key_ getKey) {
+        static_assert(std::is_trivially_copyable<_type_>::value, "RadixSort copies elements with memcpy");
+        if (count < 2) {
+            return;
+        }
+
+        ScratchScope scratch;
+        _type_* temp = Memory::AllocateScratchStruct<_type_>(count);
+        SortInternal::RadixSortPasses(data, temp, count, getKey);
+    }
+}
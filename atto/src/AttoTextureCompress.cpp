@@ -0,0 +1,826 @@
+#include "AttoTextureCompress.h"
+#include "AttoJobs.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace atto
+{
+    // Levels with fewer blocks than this are compressed on the calling thread.
+    static constexpr i32 COMPRESS_PARALLEL_MIN_BLOCKS = 1024;
+
+    static constexpr i32 BC7_WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    const char* TextureFormatToString(TextureFormat format) {
+        switch (format)
+        {
+        case TEXTURE_FORMAT_RGBA8: return "rgba8";
+        case TEXTURE_FORMAT_BC1: return "bc1";
+        case TEXTURE_FORMAT_BC3: return "bc3";
+        case TEXTURE_FORMAT_BC4: return "bc4";
+        case TEXTURE_FORMAT_BC7: return "bc7";
+        default: return "unknown";
+        }
+    }
+
+    const char* TextureCompressQualityToString(TextureCompressQuality quality) {
+        switch (quality)
+        {
+        case TEXTURE_COMPRESS_QUALITY_FAST: return "fast";
+        case TEXTURE_COMPRESS_QUALITY_DEFAULT: return "default";
+        case TEXTURE_COMPRESS_QUALITY_BEST: return "best";
+        default: return "unknown";
+        }
+    }
+
+    bool TextureFormatIsCompressed(TextureFormat format) {
+        return format != TEXTURE_FORMAT_RGBA8;
+    }
+
+    u32 TextureFormatGetBlockBytes(TextureFormat format) {
+        switch (format)
+        {
+        case TEXTURE_FORMAT_RGBA8: return 4;
+        case TEXTURE_FORMAT_BC1: return 8;
+        case TEXTURE_FORMAT_BC3: return 16;
+        case TEXTURE_FORMAT_BC4: return 8;
+        case TEXTURE_FORMAT_BC7: return 16;
+        default: return 0;
+        }
+    }
+
+    u32 TextureFormatGetRowPitch(TextureFormat format, i32 width) {
+        const u32 units = TextureFormatIsCompressed(format) ? (u32)(width + 3) / 4 : (u32)width;
+        return units * TextureFormatGetBlockBytes(format);
+    }
+
+    u64 TextureFormatGetLevelSizeBytes(TextureFormat format, i32 width, i32 height) {
+        const u64 rows = TextureFormatIsCompressed(format) ? (u64)(height + 3) / 4 : (u64)height;
+        return rows * TextureFormatGetRowPitch(format, width);
+    }
+
+    u64 TextureFormatGetMipOffset(TextureFormat format, i32 width, i32 height, i32 mip) {
+        u64 offset = 0;
+        for (i32 level = 0; level < mip; level++) {
+            const i32 levelWidth = (width >> level) > 0 ? width >> level : 1;
+            const i32 levelHeight = (height >> level) > 0 ? height >> level : 1;
+            offset += TextureFormatGetLevelSizeBytes(format, levelWidth, levelHeight);
+        }
+        return offset;
+    }
+
+    // A 4x4 block as 16 RGBA texels, edge texels repeat past the level.
+    static void BlockLoad(const byte* rgba, i32 width, i32 height, i32 blockX, i32 blockY, byte* block) {
+        for (i32 y = 0; y < 4; y++) {
+            const i32 sourceY = blockY * 4 + y < height ? blockY * 4 + y : height - 1;
+            for (i32 x = 0; x < 4; x++) {
+                const i32 sourceX = blockX * 4 + x < width ? blockX * 4 + x : width - 1;
+                memcpy(block + (y * 4 + x) * 4, rgba + ((u64)sourceY * width + sourceX) * 4, 4);
+            }
+        }
+    }
+
+    static void BlockStore(const byte* block, i32 width, i32 height, i32 blockX, i32 blockY, byte* rgba) {
+        for (i32 y = 0; y < 4 && blockY * 4 + y < height; y++) {
+            for (i32 x = 0; x < 4 && blockX * 4 + x < width; x++) {
+                memcpy(rgba + ((u64)(blockY * 4 + y) * width + blockX * 4 + x) * 4, block + (y * 4 + x) * 4, 4);
+            }
+        }
+    }
+
+    static i32 BlockRound(f32 value, i32 maxValue) {
+        const i32 rounded = (i32)floorf(value + 0.5f);
+        return rounded < 0 ? 0 : (rounded > maxValue ? maxValue : rounded);
+    }
+
+    // Mean and principal axis of the first channelCount channels, by power iteration on the covariance.
+    static void BlockPrincipalAxis(const byte* block, i32 channelCount, f32* mean, f32* axis) {
+        for (i32 channel = 0; channel < channelCount; channel++) {
+            mean[channel] = 0.0f;
+            for (i32 texel = 0; texel < 16; texel++) {
+                mean[channel] += block[texel * 4 + channel];
+            }
+            mean[channel] /= 16.0f;
+        }
+
+        f32 covariance[4][4] = {};
+        for (i32 texel = 0; texel < 16; texel++) {
+            for (i32 row = 0; row < channelCount; row++) {
+                for (i32 column = 0; column < channelCount; column++) {
+                    covariance[row][column] += (block[texel * 4 + row] - mean[row]) * (block[texel * 4 + column] - mean[column]);
+                }
+            }
+        }
+
+        for (i32 channel = 0; channel < channelCount; channel++) {
+            axis[channel] = 1.0f;
+        }
+
+        for (i32 iteration = 0; iteration < 8; iteration++) {
+            f32 next[4] = {};
+            f32 length = 0.0f;
+            for (i32 row = 0; row < channelCount; row++) {
+                for (i32 column = 0; column < channelCount; column++) {
+                    next[row] += covariance[row][column] * axis[column];
+                }
+                length += next[row] * next[row];
+            }
+
+            // A flat block has no direction, any axis does.
+            if (length < 1e-12f) {
+                break;
+            }
+
+            length = 1.0f / sqrtf(length);
+            for (i32 channel = 0; channel < channelCount; channel++) {
+                axis[channel] = next[channel] * length;
+            }
+        }
+    }
+
+    // Endpoints at the extremes of the block along its principal axis.
+    static void BlockFitEndpoints(const byte* block, i32 channelCount, f32* endpoint0, f32* endpoint1) {
+        f32 mean[4] = {};
+        f32 axis[4] = {};
+        BlockPrincipalAxis(block, channelCount, mean, axis);
+
+        f32 minT = 0.0f;
+        f32 maxT = 0.0f;
+        for (i32 texel = 0; texel < 16; texel++) {
+            f32 t = 0.0f;
+            for (i32 channel = 0; channel < channelCount; channel++) {
+                t += (block[texel * 4 + channel] - mean[channel]) * axis[channel];
+            }
+            minT = t < minT ? t : minT;
+            maxT = t > maxT ? t : maxT;
+        }
+
+        for (i32 channel = 0; channel < channelCount; channel++) {
+            endpoint0[channel] = mean[channel] + axis[channel] * maxT;
+            endpoint1[channel] = mean[channel] + axis[channel] * minT;
+        }
+    }
+
+    // Least squares endpoints for fixed indices. weights0 is how much of endpoint 0 every texel gets. Returns false
+    // when every texel uses the same weight and there is nothing to solve.
+    static bool BlockSolveEndpoints(const byte* block, i32 channelCount, const f32* weights0, f32* endpoint0, f32* endpoint1) {
+        f32 aa = 0.0f;
+        f32 ab = 0.0f;
+        f32 bb = 0.0f;
+        f32 ax[4] = {};
+        f32 bx[4] = {};
+        for (i32 texel = 0; texel < 16; texel++) {
+            const f32 a = weights0[texel];
+            const f32 b = 1.0f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (i32 channel = 0; channel < channelCount; channel++) {
+                ax[channel] += a * block[texel * 4 + channel];
+                bx[channel] += b * block[texel * 4 + channel];
+            }
+        }
+
+        const f32 determinant = aa * bb - ab * ab;
+        if (fabsf(determinant) < 1e-6f) {
+            return false;
+        }
+
+        const f32 inverse = 1.0f / determinant;
+        for (i32 channel = 0; channel < channelCount; channel++) {
+            endpoint0[channel] = (ax[channel] * bb - bx[channel] * ab) * inverse;
+            endpoint1[channel] = (bx[channel] * aa - ax[channel] * ab) * inverse;
+        }
+
+        return true;
+    }
+
+    // BC1 colour, also used by BC3.
+
+    static u16 BC1Pack565(const i32* rgb) {
+        return (u16)((rgb[0] << 11) | (rgb[1] << 5) | rgb[2]);
+    }
+
+    static void BC1Unpack565(u16 packed, i32* rgb) {
+        const i32 r = (packed >> 11) & 31;
+        const i32 g = (packed >> 5) & 63;
+        const i32 b = packed & 31;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    // fourColours is always set for BC3, which ignores the endpoint order. Entry 3 of the three colour palette
+    // is transparent black.
+    static void BC1Palette(u16 colour0, u16 colour1, bool fourColours, i32 palette[4][4]) {
+        BC1Unpack565(colour0, palette[0]);
+        BC1Unpack565(colour1, palette[1]);
+        palette[0][3] = 255;
+        palette[1][3] = 255;
+        for (i32 channel = 0; channel < 3; channel++) {
+            if (fourColours) {
+                palette[2][channel] = (2 * palette[0][channel] + palette[1][channel] + 1) / 3;
+                palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel] + 1) / 3;
+            }
+            else {
+                palette[2][channel] = (palette[0][channel] + palette[1][channel] + 1) / 2;
+                palette[3][channel] = 0;
+            }
+        }
+        palette[2][3] = 255;
+        palette[3][3] = fourColours ? 255 : 0;
+    }
+
+    static void BC1Quantize(const f32* endpoint, i32* rgb) {
+        rgb[0] = BlockRound(endpoint[0] * (31.0f / 255.0f), 31);
+        rgb[1] = BlockRound(endpoint[1] * (63.0f / 255.0f), 63);
+        rgb[2] = BlockRound(endpoint[2] * (31.0f / 255.0f), 31);
+    }
+
+    // Picks the nearest palette entry for every texel, returns the total squared error.
+    static i32 BC1AssignIndices(const byte* block, u16 colour0, u16 colour1, i32* indices) {
+        i32 palette[4][4] = {};
+        BC1Palette(colour0, colour1, true, palette);
+
+        i32 totalError = 0;
+        for (i32 texel = 0; texel < 16; texel++) {
+            i32 bestError = INT32_MAX;
+            for (i32 entry = 0; entry < 4; entry++) {
+                i32 error = 0;
+                for (i32 channel = 0; channel < 3; channel++) {
+                    const i32 delta = block[texel * 4 + channel] - palette[entry][channel];
+                    error += delta * delta;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    indices[texel] = entry;
+                }
+            }
+            totalError += bestError;
+        }
+        return totalError;
+    }
+
+    static void BC1EncodeColour(const byte* block, TextureCompressQuality quality, byte* out) {
+        f32 endpoint0[3] = {};
+        f32 endpoint1[3] = {};
+        BlockFitEndpoints(block, 3, endpoint0, endpoint1);
+
+        i32 rgb0[3] = {};
+        i32 rgb1[3] = {};
+        BC1Quantize(endpoint0, rgb0);
+        BC1Quantize(endpoint1, rgb1);
+        u16 colour0 = BC1Pack565(rgb0);
+        u16 colour1 = BC1Pack565(rgb1);
+        i32 indices[16] = {};
+        i32 error = BC1AssignIndices(block, colour0, colour1, indices);
+
+        const i32 iterations = quality == TEXTURE_COMPRESS_QUALITY_FAST ? 0 : (quality == TEXTURE_COMPRESS_QUALITY_DEFAULT ? 2 : 8);
+        static constexpr f32 weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+        for (i32 iteration = 0; iteration < iterations && error > 0; iteration++) {
+            f32 weights0[16] = {};
+            for (i32 texel = 0; texel < 16; texel++) {
+                weights0[texel] = weights[indices[texel]];
+            }
+            if (BlockSolveEndpoints(block, 3, weights0, endpoint0, endpoint1) == false) {
+                break;
+            }
+
+            BC1Quantize(endpoint0, rgb0);
+            BC1Quantize(endpoint1, rgb1);
+            i32 candidateIndices[16] = {};
+            const u16 candidate0 = BC1Pack565(rgb0);
+            const u16 candidate1 = BC1Pack565(rgb1);
+            const i32 candidateError = BC1AssignIndices(block, candidate0, candidate1, candidateIndices);
+            if (candidateError >= error) {
+                break;
+            }
+
+            colour0 = candidate0;
+            colour1 = candidate1;
+            error = candidateError;
+            memcpy(indices, candidateIndices, sizeof(indices));
+        }
+
+        // Nudges every endpoint channel by one step while that keeps helping.
+        if (quality == TEXTURE_COMPRESS_QUALITY_BEST) {
+            bool improved = true;
+            for (i32 pass = 0; pass < 4 && improved && error > 0; pass++) {
+                improved = false;
+                for (i32 endpoint = 0; endpoint < 2; endpoint++) {
+                    for (i32 channel = 0; channel < 3; channel++) {
+                        for (i32 delta = -1; delta <= 1; delta += 2) {
+                            const u16 current = endpoint == 0 ? colour0 : colour1;
+                            i32 candidateRgb[3] = { (current >> 11) & 31, (current >> 5) & 63, current & 31 };
+                            const i32 maxValue = channel == 1 ? 63 : 31;
+                            candidateRgb[channel] += delta;
+                            if (candidateRgb[channel] < 0 || candidateRgb[channel] > maxValue) {
+                                continue;
+                            }
+
+                            const u16 candidate0 = endpoint == 0 ? BC1Pack565(candidateRgb) : colour0;
+                            const u16 candidate1 = endpoint == 1 ? BC1Pack565(candidateRgb) : colour1;
+                            i32 candidateIndices[16] = {};
+                            const i32 candidateError = BC1AssignIndices(block, candidate0, candidate1, candidateIndices);
+                            if (candidateError < error) {
+                                colour0 = candidate0;
+                                colour1 = candidate1;
+                                error = candidateError;
+                                memcpy(indices, candidateIndices, sizeof(indices));
+                                improved = true;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // colour0 > colour1 selects the four colour palette, swapping the endpoints swaps 0/1 and 2/3.
+        if (colour0 < colour1) {
+            const u16 swap = colour0;
+            colour0 = colour1;
+            colour1 = swap;
+            for (i32 texel = 0; texel < 16; texel++) {
+                indices[texel] ^= 1;
+            }
+        }
+        else if (colour0 == colour1) {
+            // Three colour mode, but entry 0 is all the block needs.
+            for (i32 texel = 0; texel < 16; texel++) {
+                indices[texel] = 0;
+            }
+        }
+
+        u32 packedIndices = 0;
+        for (i32 texel = 0; texel < 16; texel++) {
+            packedIndices |= (u32)indices[texel] << (texel * 2);
+        }
+
+        memcpy(out, &colour0, 2);
+        memcpy(out + 2, &colour1, 2);
+        memcpy(out + 4, &packedIndices, 4);
+    }
+
+    static void BC1DecodeColour(const byte* in, bool forceFourColours, byte* block) {
+        u16 colour0 = 0;
+        u16 colour1 = 0;
+        u32 packedIndices = 0;
+        memcpy(&colour0, in, 2);
+        memcpy(&colour1, in + 2, 2);
+        memcpy(&packedIndices, in + 4, 4);
+
+        i32 palette[4][4] = {};
+        BC1Palette(colour0, colour1, forceFourColours || colour0 > colour1, palette);
+        for (i32 texel = 0; texel < 16; texel++) {
+            const i32 index = (packedIndices >> (texel * 2)) & 3;
+            for (i32 channel = 0; channel < 4; channel++) {
+                block[texel * 4 + channel] = (byte)palette[index][channel];
+            }
+        }
+    }
+
+    // BC4 single channel, also the alpha half of BC3.
+
+    static void BC4Palette(i32 value0, i32 value1, i32* palette) {
+        palette[0] = value0;
+        palette[1] = value1;
+        if (value0 > value1) {
+            for (i32 step = 1; step < 7; step++) {
+                palette[step + 1] = ((7 - step) * value0 + step * value1 + 3) / 7;
+            }
+        }
+        else {
+            for (i32 step = 1; step < 5; step++) {
+                palette[step + 1] = ((5 - step) * value0 + step * value1 + 2) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    static i32 BC4AssignIndices(const byte* values, i32 stride, i32 value0, i32 value1, i32* indices) {
+        i32 palette[8] = {};
+        BC4Palette(value0, value1, palette);
+
+        i32 totalError = 0;
+        for (i32 texel = 0; texel < 16; texel++) {
+            i32 bestError = INT32_MAX;
+            for (i32 entry = 0; entry < 8; entry++) {
+                const i32 delta = values[texel * stride] - palette[entry];
+                if (delta * delta < bestError) {
+                    bestError = delta * delta;
+                    indices[texel] = entry;
+                }
+            }
+            totalError += bestError;
+        }
+        return totalError;
+    }
+
+    // values is every stride-th byte, so the red or alpha channel of a block can be encoded in place.
+    static void BC4EncodeChannel(const byte* values, i32 stride, TextureCompressQuality quality, byte* out) {
+        i32 minValue = 255;
+        i32 maxValue = 0;
+        // Range without the values the six value mode stores exactly.
+        i32 innerMin = 255;
+        i32 innerMax = 0;
+        for (i32 texel = 0; texel < 16; texel++) {
+            const i32 value = values[texel * stride];
+            minValue = value < minValue ? value : minValue;
+            maxValue = value > maxValue ? value : maxValue;
+            if (value != 0 && value != 255) {
+                innerMin = value < innerMin ? value : innerMin;
+                innerMax = value > innerMax ? value : innerMax;
+            }
+        }
+
+        i32 value0 = maxValue;
+        i32 value1 = minValue;
+        i32 indices[16] = {};
+        i32 error = BC4AssignIndices(values, stride, value0, value1, indices);
+
+        if (quality != TEXTURE_COMPRESS_QUALITY_FAST && error > 0) {
+            // Six value mode, worth it when the block touches 0 or 255 and has detail in between.
+            if (innerMin <= innerMax && (minValue == 0 || maxValue == 255)) {
+                i32 candidateIndices[16] = {};
+                const i32 candidateError = BC4AssignIndices(values, stride, innerMin, innerMax, candidateIndices);
+                if (candidateError < error) {
+                    value0 = innerMin;
+                    value1 = innerMax;
+                    error = candidateError;
+                    memcpy(indices, candidateIndices, sizeof(indices));
+                }
+            }
+
+            // Pulling the endpoints in a little often fits the interpolated values better.
+            const i32 searchRadius = quality == TEXTURE_COMPRESS_QUALITY_BEST ? 4 : 1;
+            const i32 base0 = value0;
+            const i32 base1 = value1;
+            for (i32 delta0 = -searchRadius; delta0 <= searchRadius; delta0++) {
+                for (i32 delta1 = -searchRadius; delta1 <= searchRadius; delta1++) {
+                    const i32 candidate0 = base0 + delta0;
+                    const i32 candidate1 = base1 + delta1;
+                    // The search must not flip the mode.
+                    if (candidate0 < 0 || candidate0 > 255 || candidate1 < 0 || candidate1 > 255 || (candidate0 > candidate1) != (base0 > base1)) {
+                        continue;
+                    }
+
+                    i32 candidateIndices[16] = {};
+                    const i32 candidateError = BC4AssignIndices(values, stride, candidate0, candidate1, candidateIndices);
+                    if (candidateError < error) {
+                        value0 = candidate0;
+                        value1 = candidate1;
+                        error = candidateError;
+                        memcpy(indices, candidateIndices, sizeof(indices));
+                    }
+                }
+            }
+        }
+
+        u64 packedIndices = 0;
+        for (i32 texel = 0; texel < 16; texel++) {
+            packedIndices |= (u64)indices[texel] << (texel * 3);
+        }
+
+        out[0] = (byte)value0;
+        out[1] = (byte)value1;
+        for (i32 index = 0; index < 6; index++) {
+            out[2 + index] = (byte)(packedIndices >> (index * 8));
+        }
+    }
+
+    static void BC4DecodeChannel(const byte* in, byte* values, i32 stride) {
+        i32 palette[8] = {};
+        BC4Palette(in[0], in[1], palette);
+
+        u64 packedIndices = 0;
+        for (i32 index = 0; index < 6; index++) {
+            packedIndices |= (u64)in[2 + index] << (index * 8);
+        }
+
+        for (i32 texel = 0; texel < 16; texel++) {
+            values[texel * stride] = (byte)palette[(packedIndices >> (texel * 3)) & 7];
+        }
+    }
+
+    // BC7 mode 6, one subset with RGBA endpoints.
+
+    static void BC7Palette(const i32 endpoints[2][4], i32 palette[16][4]) {
+        for (i32 entry = 0; entry < 16; entry++) {
+            for (i32 channel = 0; channel < 4; channel++) {
+                palette[entry][channel] = ((64 - BC7_WEIGHTS_4[entry]) * endpoints[0][channel] + BC7_WEIGHTS_4[entry] * endpoints[1][channel] + 32) >> 6;
+            }
+        }
+    }
+
+    static i32 BC7AssignIndices(const byte* block, const i32 endpoints[2][4], i32* indices) {
+        i32 palette[16][4] = {};
+        BC7Palette(endpoints, palette);
+
+        i32 totalError = 0;
+        for (i32 texel = 0; texel < 16; texel++) {
+            i32 bestError = INT32_MAX;
+            for (i32 entry = 0; entry < 16; entry++) {
+                i32 error = 0;
+                for (i32 channel = 0; channel < 4; channel++) {
+                    const i32 delta = block[texel * 4 + channel] - palette[entry][channel];
+                    error += delta * delta;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    indices[texel] = entry;
+                }
+            }
+            totalError += bestError;
+        }
+        return totalError;
+    }
+
+    // Every endpoint is 7 bits per channel plus one p bit shared by its channels.
+    static void BC7QuantizeEndpoint(const f32* endpoint, i32 pBit, i32* quantized) {
+        for (i32 channel = 0; channel < 4; channel++) {
+            quantized[channel] = (BlockRound((endpoint[channel] - pBit) * 0.5f, 127) << 1) | pBit;
+        }
+    }
+
+    static i32 BC7QuantizeError(const f32* endpoint, const i32* quantized) {
+        f32 error = 0.0f;
+        for (i32 channel = 0; channel < 4; channel++) {
+            error += (endpoint[channel] - quantized[channel]) * (endpoint[channel] - quantized[channel]);
+        }
+        return (i32)error;
+    }
+
+    // Tries the p bits and returns the error of the best quantization of the two float endpoints.
+    static i32 BC7QuantizeEndpoints(const byte* block, const f32 floats[2][4], bool searchPBits, i32 endpoints[2][4], i32* indices) {
+        if (searchPBits == false) {
+            for (i32 endpoint = 0; endpoint < 2; endpoint++) {
+                i32 quantized[2][4] = {};
+                BC7QuantizeEndpoint(floats[endpoint], 0, quantized[0]);
+                BC7QuantizeEndpoint(floats[endpoint], 1, quantized[1]);
+                const i32 best = BC7QuantizeError(floats[endpoint], quantized[1]) < BC7QuantizeError(floats[endpoint], quantized[0]) ? 1 : 0;
+                memcpy(endpoints[endpoint], quantized[best], sizeof(quantized[best]));
+            }
+            return BC7AssignIndices(block, endpoints, indices);
+        }
+
+        i32 bestError = INT32_MAX;
+        for (i32 pBits = 0; pBits < 4; pBits++) {
+            i32 candidate[2][4] = {};
+            BC7QuantizeEndpoint(floats[0], pBits & 1, candidate[0]);
+            BC7QuantizeEndpoint(floats[1], pBits >> 1, candidate[1]);
+            i32 candidateIndices[16] = {};
+            const i32 error = BC7AssignIndices(block, candidate, candidateIndices);
+            if (error < bestError) {
+                bestError = error;
+                memcpy(endpoints, candidate, sizeof(candidate));
+                memcpy(indices, candidateIndices, sizeof(candidateIndices));
+            }
+        }
+        return bestError;
+    }
+
+    static void BC7WriteBits(byte* out, u32& bitOffset, u32 value, u32 bitCount) {
+        for (u32 bit = 0; bit < bitCount; bit++, bitOffset++) {
+            if ((value >> bit) & 1) {
+                out[bitOffset >> 3] |= (byte)(1 << (bitOffset & 7));
+            }
+        }
+    }
+
+    static u32 BC7ReadBits(const byte* in, u32& bitOffset, u32 bitCount) {
+        u32 value = 0;
+        for (u32 bit = 0; bit < bitCount; bit++, bitOffset++) {
+            value |= (u32)((in[bitOffset >> 3] >> (bitOffset & 7)) & 1) << bit;
+        }
+        return value;
+    }
+
+    static void BC7EncodeMode6(const byte* block, TextureCompressQuality quality, byte* out) {
+        f32 floats[2][4] = {};
+        BlockFitEndpoints(block, 4, floats[0], floats[1]);
+
+        const bool searchPBits = quality == TEXTURE_COMPRESS_QUALITY_BEST;
+        i32 endpoints[2][4] = {};
+        i32 indices[16] = {};
+        i32 error = BC7QuantizeEndpoints(block, floats, searchPBits, endpoints, indices);
+
+        const i32 iterations = quality == TEXTURE_COMPRESS_QUALITY_FAST ? 0 : (quality == TEXTURE_COMPRESS_QUALITY_DEFAULT ? 2 : 6);
+        for (i32 iteration = 0; iteration < iterations && error > 0; iteration++) {
+            f32 weights0[16] = {};
+            for (i32 texel = 0; texel < 16; texel++) {
+                weights0[texel] = (64 - BC7_WEIGHTS_4[indices[texel]]) / 64.0f;
+            }
+            if (BlockSolveEndpoints(block, 4, weights0, floats[0], floats[1]) == false) {
+                break;
+            }
+
+            i32 candidate[2][4] = {};
+            i32 candidateIndices[16] = {};
+            const i32 candidateError = BC7QuantizeEndpoints(block, floats, searchPBits, candidate, candidateIndices);
+            if (candidateError >= error) {
+                break;
+            }
+
+            error = candidateError;
+            memcpy(endpoints, candidate, sizeof(candidate));
+            memcpy(indices, candidateIndices, sizeof(candidateIndices));
+        }
+
+        // The first index only has 3 bits, its top bit is implied zero. Swapping the endpoints flips the indices.
+        if (indices[0] & 8) {
+            for (i32 channel = 0; channel < 4; channel++) {
+                const i32 swap = endpoints[0][channel];
+                endpoints[0][channel] = endpoints[1][channel];
+                endpoints[1][channel] = swap;
+            }
+            for (i32 texel = 0; texel < 16; texel++) {
+                indices[texel] = 15 - indices[texel];
+            }
+        }
+
+        memset(out, 0, 16);
+        u32 bitOffset = 0;
+        BC7WriteBits(out, bitOffset, 1 << 6, 7);
+        for (i32 channel = 0; channel < 4; channel++) {
+            BC7WriteBits(out, bitOffset, (u32)endpoints[0][channel] >> 1, 7);
+            BC7WriteBits(out, bitOffset, (u32)endpoints[1][channel] >> 1, 7);
+        }
+        BC7WriteBits(out, bitOffset, (u32)endpoints[0][0] & 1, 1);
+        BC7WriteBits(out, bitOffset, (u32)endpoints[1][0] & 1, 1);
+        for (i32 texel = 0; texel < 16; texel++) {
+            BC7WriteBits(out, bitOffset, (u32)indices[texel], texel == 0 ? 3 : 4);
+        }
+        Assert(bitOffset == 128, "BC7 mode 6 is exactly one block");
+    }
+
+    static void BC7DecodeMode6(const byte* in, byte* block) {
+        u32 bitOffset = 0;
+        if (BC7ReadBits(in, bitOffset, 7) != (1 << 6)) {
+            // Only mode 6 is ever written, anything else decodes to the BC7 error colour, transparent black.
+            memset(block, 0, 64);
+            return;
+        }
+
+        i32 endpoints[2][4] = {};
+        for (i32 channel = 0; channel < 4; channel++) {
+            endpoints[0][channel] = (i32)BC7ReadBits(in, bitOffset, 7) << 1;
+            endpoints[1][channel] = (i32)BC7ReadBits(in, bitOffset, 7) << 1;
+        }
+        const i32 pBit0 = (i32)BC7ReadBits(in, bitOffset, 1);
+        const i32 pBit1 = (i32)BC7ReadBits(in, bitOffset, 1);
+        for (i32 channel = 0; channel < 4; channel++) {
+            endpoints[0][channel] |= pBit0;
+            endpoints[1][channel] |= pBit1;
+        }
+
+        i32 palette[16][4] = {};
+        BC7Palette(endpoints, palette);
+        for (i32 texel = 0; texel < 16; texel++) {
+            const u32 index = BC7ReadBits(in, bitOffset, texel == 0 ? 3 : 4);
+            for (i32 channel = 0; channel < 4; channel++) {
+                block[texel * 4 + channel] = (byte)palette[index][channel];
+            }
+        }
+    }
+
+    static void CompressBlock(const byte* block, const TextureCompressSettings& settings, byte* out) {
+        switch (settings.format)
+        {
+        case TEXTURE_FORMAT_BC1:
+        {
+            BC1EncodeColour(block, settings.quality, out);
+        }break;
+        case TEXTURE_FORMAT_BC3:
+        {
+            BC4EncodeChannel(block + 3, 4, settings.quality, out);
+            BC1EncodeColour(block, settings.quality, out + 8);
+        }break;
+        case TEXTURE_FORMAT_BC4:
+        {
+            BC4EncodeChannel(block, 4, settings.quality, out);
+        }break;
+        case TEXTURE_FORMAT_BC7:
+        {
+            BC7EncodeMode6(block, settings.quality, out);
+        }break;
+        default:
+        {
+            Assert(false, "Not a block compressed format");
+        }break;
+        }
+    }
+
+    struct CompressJob {
+        const byte*                 rgba;
+        byte*                       blocks;
+        i32                         width;
+        i32                         height;
+        i32                         blocksWide;
+        i32                         blocksHigh;
+        i32                         bandCount;
+        TextureCompressSettings     settings;
+    };
+
+    static void CompressBand(i32 bandIndex, void* userData) {
+        const CompressJob& job = *(const CompressJob*)userData;
+        const u32 blockBytes = TextureFormatGetBlockBytes(job.settings.format);
+        const i32 rowsPerBand = (job.blocksHigh + job.bandCount - 1) / job.bandCount;
+        const i32 firstRow = bandIndex * rowsPerBand;
+        const i32 lastRow = firstRow + rowsPerBand < job.blocksHigh ? firstRow + rowsPerBand : job.blocksHigh;
+
+        byte block[64] = {};
+        for (i32 blockY = firstRow; blockY < lastRow; blockY++) {
+            for (i32 blockX = 0; blockX < job.blocksWide; blockX++) {
+                BlockLoad(job.rgba, job.width, job.height, blockX, blockY, block);
+                CompressBlock(block, job.settings, job.blocks + ((u64)blockY * job.blocksWide + blockX) * blockBytes);
+            }
+        }
+    }
+
+    void TextureCompress(const byte* rgba, i32 width, i32 height, byte* blocks, const TextureCompressSettings& settings) {
+        Assert(TextureFormatIsCompressed(settings.format), "Nothing to compress");
+
+        CompressJob job = {};
+        job.rgba = rgba;
+        job.blocks = blocks;
+        job.width = width;
+        job.height = height;
+        job.blocksWide = (width + 3) / 4;
+        job.blocksHigh = (height + 3) / 4;
+        job.settings = settings;
+
+        const i32 workerCount = Jobs::GetWorkerCount();
+        if (workerCount > 0 && job.blocksWide * job.blocksHigh >= COMPRESS_PARALLEL_MIN_BLOCKS) {
+            job.bandCount = (workerCount + 1) * 4 < job.blocksHigh ? (workerCount + 1) * 4 : job.blocksHigh;
+            Jobs::ParallelFor(job.bandCount, CompressBand, &job);
+        }
+        else {
+            job.bandCount = 1;
+            CompressBand(0, &job);
+        }
+    }
+
+    void TextureDecompress(const byte* blocks, i32 width, i32 height, TextureFormat format, byte* rgba) {
+        Assert(TextureFormatIsCompressed(format), "Nothing to decompress");
+
+        const u32 blockBytes = TextureFormatGetBlockBytes(format);
+        const i32 blocksWide = (width + 3) / 4;
+        const i32 blocksHigh = (height + 3) / 4;
+        byte block[64] = {};
+        for (i32 blockY = 0; blockY < blocksHigh; blockY++) {
+            for (i32 blockX = 0; blockX < blocksWide; blockX++) {
+                const byte* in = blocks + ((u64)blockY * blocksWide + blockX) * blockBytes;
+                switch (format)
+                {
+                case TEXTURE_FORMAT_BC1:
+                {
+                    BC1DecodeColour(in, false, block);
+                }break;
+                case TEXTURE_FORMAT_BC3:
+                {
+                    BC1DecodeColour(in + 8, true, block);
+                    BC4DecodeChannel(in, block + 3, 4);
+                }break;
+                case TEXTURE_FORMAT_BC4:
+                {
+                    BC4DecodeChannel(in, block, 4);
+                    for (i32 texel = 0; texel < 16; texel++) {
+                        block[texel * 4 + 1] = block[texel * 4];
+                        block[texel * 4 + 2] = block[texel * 4];
+                        block[texel * 4 + 3] = 255;
+                    }
+                }break;
+                case TEXTURE_FORMAT_BC7:
+                {
+                    BC7DecodeMode6(in, block);
+                }break;
+                default:
+                {
+                    Assert(false, "Not a block compressed format");
+                }break;
+                }
+
+                BlockStore(block, width, height, blockX, blockY, rgba);
+            }
+        }
+    }
+
+    f32 TextureComputePSNR(const byte* a, const byte* b, i32 width, i32 height, i32 channelCount) {
+        u64 squaredError = 0;
+        const u64 texelCount = (u64)width * height;
+        for (u64 texel = 0; texel < texelCount; texel++) {
+            for (i32 channel = 0; channel < channelCount; channel++) {
+                const i32 delta = (i32)a[texel * 4 + channel] - (i32)b[texel * 4 + channel];
+                squaredError += (u64)(delta * delta);
+            }
+        }
+
+        if (squaredError == 0) {
+            return INFINITY;
+        }
+
+        const f64 meanSquaredError = (f64)squaredError / ((f64)texelCount * channelCount);
+        return (f32)(10.0 * log10(255.0 * 255.0 / meanSquaredError));
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "AttoDefines.h"
+
+namespace atto
+{
+    // CPU block compression for RGBA8 texels, meant for the cooker. Textures are split into 4x4 blocks, levels
+    // are compressed in bands of block rows on the job workers. The decoder and PSNR exist so the output can be
+    // validated without a GPU.
+
+    enum TextureFormat : u32 {
+        TEXTURE_FORMAT_RGBA8 = 0,
+        // 565 colour endpoints and 2 bit indices, opaque. 8 bytes per block.
+        TEXTURE_FORMAT_BC1,
+        // BC1 colour plus a BC4 alpha block. 16 bytes per block.
+        TEXTURE_FORMAT_BC3,
+        // Red only, 8 bit endpoints and 3 bit indices. 8 bytes per block, for single channel data.
+        TEXTURE_FORMAT_BC4,
+        // RGBA with 7777 + p bit endpoints and 4 bit indices (mode 6 only). 16 bytes per block.
+        TEXTURE_FORMAT_BC7,
+        TEXTURE_FORMAT_COUNT,
+    };
+
+    // How hard the encoder searches for endpoints. Fast is a single fit, best refines the endpoints and tries
+    // the neighbouring quantized values too.
+    enum TextureCompressQuality : u32 {
+        TEXTURE_COMPRESS_QUALITY_FAST = 0,
+        TEXTURE_COMPRESS_QUALITY_DEFAULT,
+        TEXTURE_COMPRESS_QUALITY_BEST,
+        TEXTURE_COMPRESS_QUALITY_COUNT,
+    };
+
+    struct TextureCompressSettings {
+        TextureFormat           format = TEXTURE_FORMAT_BC7;
+        TextureCompressQuality  quality = TEXTURE_COMPRESS_QUALITY_DEFAULT;
+    };
+
+    const char*     TextureFormatToString(TextureFormat format);
+    const char*     TextureCompressQualityToString(TextureCompressQuality quality);
+    bool            TextureFormatIsCompressed(TextureFormat format);
+    // Bytes per texel for RGBA8, per 4x4 block for the compressed formats.
+    u32             TextureFormatGetBlockBytes(TextureFormat format);
+    // Bytes from one row of texels, or one row of blocks, to the next.
+    u32             TextureFormatGetRowPitch(TextureFormat format, i32 width);
+    u64             TextureFormatGetLevelSizeBytes(TextureFormat format, i32 width, i32 height);
+    // Mip chains are stored level after level, the same way TextureMipGetOffset lays out RGBA8.
+    u64             TextureFormatGetMipOffset(TextureFormat format, i32 width, i32 height, i32 mip);
+
+    // rgba is width * height RGBA8 texels, blocks gets TextureFormatGetLevelSizeBytes bytes. Sizes that are not
+    // a multiple of 4 repeat the edge texels into the padding.
+    void            TextureCompress(const byte* rgba, i32 width, i32 height, byte* blocks, const TextureCompressSettings& settings);
+    // Decodes the blocks TextureCompress writes. BC1 and BC4 decode as opaque, BC4 to grey.
+    void            TextureDecompress(const byte* blocks, i32 width, i32 height, TextureFormat format, byte* rgba);
+
+    // Peak signal to noise ratio in dB over the first channelCount channels of every texel. Infinite when equal.
+    f32             TextureComputePSNR(const byte* a, const byte* b, i32 width, i32 height, i32 channelCount);
+}
@@ -0,0 +1,480 @@
+#include "AttoTextureMips.h"
+#include "AttoJobs.h"
+#include "AttoMemory.h"
+
+#include <cmath>
+#include <cstring>
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define MIP_TARGET_AVX2
+#else
+#define MIP_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace atto
+{
+    static constexpr f32 MIP_FILTER_RADIUS = 3.0f;
+    static constexpr f32 MIP_KAISER_ALPHA = 4.0f;
+    static constexpr f32 MIP_PI = 3.14159265358979f;
+    // Levels smaller than this are not worth splitting across the workers.
+    static constexpr i32 MIP_PARALLEL_MIN_TEXELS = 128 * 128;
+    static constexpr i32 MIP_SRGB_GUESS_COUNT = 4096;
+
+    struct MipTables {
+        // Byte to linear value. sRGB colour in the first 256 entries, plain unorm in the second, which alpha and
+        // linear textures use.
+        f32     decode[512];
+        // srgbThresholds[i] is the smallest linear value that encodes to i.
+        f32     srgbThresholds[256];
+        // Lowest possible encoding for a linear value, indexed by value * (MIP_SRGB_GUESS_COUNT - 1).
+        byte    srgbGuess[MIP_SRGB_GUESS_COUNT];
+    };
+
+    static f32 MipSrgbToLinear(f32 value) {
+        return value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    static MipTables MipBuildTables() {
+        MipTables tables = {};
+        for (i32 value = 0; value < 256; value++) {
+            tables.decode[value] = MipSrgbToLinear(value / 255.0f);
+            tables.decode[256 + value] = value / 255.0f;
+            tables.srgbThresholds[value] = value == 0 ? 0.0f : MipSrgbToLinear((value - 0.5f) / 255.0f);
+        }
+
+        i32 encoded = 0;
+        for (i32 guess = 0; guess < MIP_SRGB_GUESS_COUNT; guess++) {
+            const f32 linear = (f32)guess / (MIP_SRGB_GUESS_COUNT - 1);
+            while (encoded < 255 && linear >= tables.srgbThresholds[encoded + 1]) {
+                encoded++;
+            }
+            tables.srgbGuess[guess] = (byte)encoded;
+        }
+
+        return tables;
+    }
+
+    static const MipTables& MipGetTables() {
+        static const MipTables tables = MipBuildTables();
+        return tables;
+    }
+
+    static byte MipEncodeSrgb(const MipTables& tables, f32 linear) {
+        if (!(linear > 0.0f)) {
+            return 0;
+        }
+        if (linear >= 1.0f) {
+            return 255;
+        }
+
+        i32 encoded = tables.srgbGuess[(i32)(linear * (MIP_SRGB_GUESS_COUNT - 1))];
+        while (encoded < 255 && linear >= tables.srgbThresholds[encoded + 1]) {
+            encoded++;
+        }
+        return (byte)encoded;
+    }
+
+    static byte MipEncodeUnorm(f32 value) {
+        value = value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f;
+        return (byte)(value * 255.0f + 0.5f);
+    }
+
+    const char* TextureMipFilterToString(TextureMipFilter filter) {
+        switch (filter)
+        {
+        case TEXTURE_MIP_FILTER_BOX: return "box";
+        case TEXTURE_MIP_FILTER_KAISER: return "kaiser";
+        case TEXTURE_MIP_FILTER_LANCZOS: return "lanczos";
+        default: return "unknown";
+        }
+    }
+
+    const char* TextureMipKernelToString(TextureMipKernel kernel) {
+        switch (kernel)
+        {
+        case TEXTURE_MIP_KERNEL_AUTO: return "auto";
+        case TEXTURE_MIP_KERNEL_SCALAR: return "scalar";
+        case TEXTURE_MIP_KERNEL_SSE: return "sse";
+        case TEXTURE_MIP_KERNEL_AVX2: return "avx2";
+        default: return "unknown";
+        }
+    }
+
+    static bool MipCpuHasAVX2() {
+#if defined(_MSC_VER)
+        i32 info[4] = {};
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+
+        // The OS has to save the ymm registers too, not just the CPU support them.
+        __cpuid(info, 1);
+        const bool hasAVX = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0;
+        if (hasAVX == false || (_xgetbv(0) & 6) != 6) {
+            return false;
+        }
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    TextureMipKernel TextureMipGetBestKernel() {
+        // SSE2 is part of x64, only AVX2 has to be checked.
+        static const TextureMipKernel best = MipCpuHasAVX2() ? TEXTURE_MIP_KERNEL_AVX2 : TEXTURE_MIP_KERNEL_SSE;
+        return best;
+    }
+
+    i32 TextureMipGetCount(i32 width, i32 height) {
+        i32 size = width > height ? width : height;
+        i32 count = 1;
+        while (size > 1) {
+            size >>= 1;
+            count++;
+        }
+        return count;
+    }
+
+    i32 TextureMipGetSize(i32 size, i32 mip) {
+        size >>= mip;
+        return size > 0 ? size : 1;
+    }
+
+    u64 TextureMipGetOffset(i32 width, i32 height, i32 mip) {
+        u64 offset = 0;
+        for (i32 level = 0; level < mip; level++) {
+            offset += (u64)TextureMipGetSize(width, level) * TextureMipGetSize(height, level) * 4;
+        }
+        return offset;
+    }
+
+    u64 TextureMipGetChainSizeBytes(i32 width, i32 height, i32 mipCount) {
+        return TextureMipGetOffset(width, height, mipCount);
+    }
+
+    static f32 MipSinc(f32 x) {
+        if (fabsf(x) < 1e-6f) {
+            return 1.0f;
+        }
+        x *= MIP_PI;
+        return sinf(x) / x;
+    }
+
+    // Modified Bessel function of the first kind, order 0. The series converges quickly for the alphas used here.
+    static f32 MipBesselI0(f32 x) {
+        f32 sum = 1.0f;
+        f32 term = 1.0f;
+        const f32 halfSquared = x * x * 0.25f;
+        for (i32 k = 1; k < 32 && term > sum * 1e-8f; k++) {
+            term *= halfSquared / (f32)(k * k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    static f32 MipFilterEvaluate(TextureMipFilter filter, f32 x) {
+        if (fabsf(x) >= MIP_FILTER_RADIUS) {
+            return 0.0f;
+        }
+
+        switch (filter)
+        {
+        case TEXTURE_MIP_FILTER_KAISER:
+        {
+            const f32 t = x / MIP_FILTER_RADIUS;
+            return MipSinc(x) * MipBesselI0(MIP_KAISER_ALPHA * sqrtf(1.0f - t * t)) / MipBesselI0(MIP_KAISER_ALPHA);
+        }
+        case TEXTURE_MIP_FILTER_LANCZOS:
+        {
+            return MipSinc(x) * MipSinc(x / MIP_FILTER_RADIUS);
+        }
+        default:
+        {
+            return 0.0f;
+        }
+        }
+    }
+
+    // The same number of taps for every destination texel, padded with zero weights, so the kernels have no
+    // edge cases. Indices are clamped to the source, which repeats the edge texels.
+    struct MipTaps {
+        i32     count;
+        i32*    indices;
+        f32*    weights;
+    };
+
+    static void MipComputeTaps(i32 sourceSize, i32 destinationSize, TextureMipFilter filter, MipTaps& taps) {
+        if (sourceSize == destinationSize) {
+            taps.count = 1;
+            taps.indices = Memory::AllocateScratchStruct<i32>(destinationSize);
+            taps.weights = Memory::AllocateScratchStruct<f32>(destinationSize);
+            for (i32 index = 0; index < destinationSize; index++) {
+                taps.indices[index] = index;
+                taps.weights[index] = 1.0f;
+            }
+            return;
+        }
+
+        // Filters are defined in destination texels, scale stretches them over the source.
+        const f32 scale = (f32)sourceSize / destinationSize;
+        const f32 support = (filter == TEXTURE_MIP_FILTER_BOX ? 0.5f : MIP_FILTER_RADIUS) * scale;
+        taps.count = (i32)ceilf(support * 2.0f) + 1;
+        taps.indices = Memory::AllocateScratchStruct<i32>(destinationSize * taps.count);
+        taps.weights = Memory::AllocateScratchStruct<f32>(destinationSize * taps.count);
+
+        for (i32 index = 0; index < destinationSize; index++) {
+            const f32 center = (index + 0.5f) * scale;
+            const i32 first = (i32)floorf(center - support);
+            i32* indices = taps.indices + index * taps.count;
+            f32* weights = taps.weights + index * taps.count;
+
+            f32 sum = 0.0f;
+            for (i32 tap = 0; tap < taps.count; tap++) {
+                const i32 source = first + tap;
+                f32 weight = 0.0f;
+                if (filter == TEXTURE_MIP_FILTER_BOX) {
+                    // How much of the source texel lies under the box.
+                    const f32 left = (f32)source > center - support ? (f32)source : center - support;
+                    const f32 right = (f32)(source + 1) < center + support ? (f32)(source + 1) : center + support;
+                    weight = right > left ? right - left : 0.0f;
+                }
+                else {
+                    weight = MipFilterEvaluate(filter, (source + 0.5f - center) / scale);
+                }
+
+                indices[tap] = source < 0 ? 0 : (source >= sourceSize ? sourceSize - 1 : source);
+                weights[tap] = weight;
+                sum += weight;
+            }
+
+            for (i32 tap = 0; tap < taps.count; tap++) {
+                weights[tap] /= sum;
+            }
+        }
+    }
+
+    // Per kernel building blocks. They all evaluate the same operations in the same order, so the results match
+    // the scalar reference bit for bit.
+
+    static void MipDecodeRowScalar(const MipTables& tables, const byte* row, i32 count, i32 colourOffset, f32* decoded) {
+        for (i32 index = 0; index < count; index += 4) {
+            decoded[index + 0] = tables.decode[colourOffset + row[index + 0]];
+            decoded[index + 1] = tables.decode[colourOffset + row[index + 1]];
+            decoded[index + 2] = tables.decode[colourOffset + row[index + 2]];
+            decoded[index + 3] = tables.decode[256 + row[index + 3]];
+        }
+    }
+
+    static void MipAccumulateRowScalar(f32* accumulated, const f32* row, i32 count, f32 weight) {
+        for (i32 index = 0; index < count; index++) {
+            accumulated[index] += weight * row[index];
+        }
+    }
+
+    static void MipFilterRowScalar(const f32* row, const MipTaps& taps, i32 destinationWidth, f32* filtered) {
+        for (i32 x = 0; x < destinationWidth; x++) {
+            const i32* indices = taps.indices + x * taps.count;
+            const f32* weights = taps.weights + x * taps.count;
+            for (i32 channel = 0; channel < 4; channel++) {
+                f32 sum = 0.0f;
+                for (i32 tap = 0; tap < taps.count; tap++) {
+                    sum += weights[tap] * row[indices[tap] * 4 + channel];
+                }
+                filtered[x * 4 + channel] = sum;
+            }
+        }
+    }
+
+    static void MipAccumulateRowSSE(f32* accumulated, const f32* row, i32 count, f32 weight) {
+        const __m128 w = _mm_set1_ps(weight);
+        i32 index = 0;
+        for (; index + 4 <= count; index += 4) {
+            const __m128 sum = _mm_add_ps(_mm_loadu_ps(accumulated + index), _mm_mul_ps(w, _mm_loadu_ps(row + index)));
+            _mm_storeu_ps(accumulated + index, sum);
+        }
+        MipAccumulateRowScalar(accumulated + index, row + index, count - index, weight);
+    }
+
+    // One texel is exactly one register, all four channels are filtered together.
+    static void MipFilterRowSSE(const f32* row, const MipTaps& taps, i32 firstX, i32 destinationWidth, f32* filtered) {
+        for (i32 x = firstX; x < destinationWidth; x++) {
+            const i32* indices = taps.indices + x * taps.count;
+            const f32* weights = taps.weights + x * taps.count;
+            __m128 sum = _mm_setzero_ps();
+            for (i32 tap = 0; tap < taps.count; tap++) {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[tap]), _mm_loadu_ps(row + indices[tap] * 4)));
+            }
+            _mm_storeu_ps(filtered + x * 4, sum);
+        }
+    }
+
+    // Two texels at a time, the alpha lane picks the unorm half of the table.
+    MIP_TARGET_AVX2 static void MipDecodeRowAVX2(const MipTables& tables, const byte* row, i32 count, i32 colourOffset, f32* decoded) {
+        const __m256i offsets = _mm256_setr_epi32(colourOffset, colourOffset, colourOffset, 256, colourOffset, colourOffset, colourOffset, 256);
+        i32 index = 0;
+        for (; index + 8 <= count; index += 8) {
+            const __m256i bytes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(row + index)));
+            _mm256_storeu_ps(decoded + index, _mm256_i32gather_ps(tables.decode, _mm256_add_epi32(bytes, offsets), 4));
+        }
+        MipDecodeRowScalar(tables, row + index, count - index, colourOffset, decoded + index);
+    }
+
+    MIP_TARGET_AVX2 static void MipAccumulateRowAVX2(f32* accumulated, const f32* row, i32 count, f32 weight) {
+        const __m256 w = _mm256_set1_ps(weight);
+        i32 index = 0;
+        for (; index + 8 <= count; index += 8) {
+            const __m256 sum = _mm256_add_ps(_mm256_loadu_ps(accumulated + index), _mm256_mul_ps(w, _mm256_loadu_ps(row + index)));
+            _mm256_storeu_ps(accumulated + index, sum);
+        }
+        MipAccumulateRowScalar(accumulated + index, row + index, count - index, weight);
+    }
+
+    // Two destination texels per register, one in each 128 bit lane.
+    MIP_TARGET_AVX2 static void MipFilterRowAVX2(const f32* row, const MipTaps& taps, i32 destinationWidth, f32* filtered) {
+        i32 x = 0;
+        for (; x + 2 <= destinationWidth; x += 2) {
+            const i32* indices0 = taps.indices + x * taps.count;
+            const f32* weights0 = taps.weights + x * taps.count;
+            const i32* indices1 = indices0 + taps.count;
+            const f32* weights1 = weights0 + taps.count;
+            __m256 sum = _mm256_setzero_ps();
+            for (i32 tap = 0; tap < taps.count; tap++) {
+                const __m256 texels = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(row + indices0[tap] * 4)), _mm_loadu_ps(row + indices1[tap] * 4), 1);
+                const __m256 weights = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(weights0[tap])), _mm_set1_ps(weights1[tap]), 1);
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(weights, texels));
+            }
+            _mm256_storeu_ps(filtered + x * 4, sum);
+        }
+        MipFilterRowSSE(row, taps, x, destinationWidth, filtered);
+    }
+
+    struct MipDownsampleJob {
+        const byte*         source;
+        i32                 sourceWidth;
+        i32                 sourceHeight;
+        byte*               destination;
+        i32                 destinationWidth;
+        i32                 destinationHeight;
+        MipTaps             horizontal;
+        MipTaps             vertical;
+        bool                srgb;
+        TextureMipKernel    kernel;
+        i32                 bandCount;
+    };
+
+    static void MipDownsampleBand(i32 bandIndex, void* userData) {
+        const MipDownsampleJob& job = *(const MipDownsampleJob*)userData;
+        const MipTables& tables = MipGetTables();
+        const i32 colourOffset = job.srgb ? 0 : 256;
+        const i32 rowFloats = job.sourceWidth * 4;
+        const i32 rowsPerBand = (job.destinationHeight + job.bandCount - 1) / job.bandCount;
+        const i32 firstRow = bandIndex * rowsPerBand;
+        const i32 lastRow = firstRow + rowsPerBand < job.destinationHeight ? firstRow + rowsPerBand : job.destinationHeight;
+
+        ScratchScope scratch;
+        // Decoded source rows, direct mapped by row index. Every destination row reads at most vertical.count
+        // consecutive rows, so they never evict each other and each source row is decoded about once per band.
+        const i32 cacheCount = job.vertical.count + 1;
+        f32* cacheRows = Memory::AllocateScratchStruct<f32>(cacheCount * rowFloats);
+        i32* cacheTags = Memory::AllocateScratchStruct<i32>(cacheCount);
+        for (i32 slot = 0; slot < cacheCount; slot++) {
+            cacheTags[slot] = -1;
+        }
+
+        f32* accumulated = Memory::AllocateScratchStruct<f32>(rowFloats);
+        f32* filtered = Memory::AllocateScratchStruct<f32>(job.destinationWidth * 4);
+
+        for (i32 y = firstRow; y < lastRow; y++) {
+            memset(accumulated, 0, sizeof(f32) * rowFloats);
+
+            for (i32 tap = 0; tap < job.vertical.count; tap++) {
+                const f32 weight = job.vertical.weights[y * job.vertical.count + tap];
+                if (weight == 0.0f) {
+                    continue;
+                }
+
+                const i32 sourceRow = job.vertical.indices[y * job.vertical.count + tap];
+                const i32 slot = sourceRow % cacheCount;
+                f32* decoded = cacheRows + (u64)slot * rowFloats;
+                if (cacheTags[slot] != sourceRow) {
+                    const byte* row = job.source + (u64)sourceRow * rowFloats;
+                    if (job.kernel == TEXTURE_MIP_KERNEL_AVX2) {
+                        MipDecodeRowAVX2(tables, row, rowFloats, colourOffset, decoded);
+                    }
+                    else {
+                        MipDecodeRowScalar(tables, row, rowFloats, colourOffset, decoded);
+                    }
+                    cacheTags[slot] = sourceRow;
+                }
+
+                switch (job.kernel)
+                {
+                case TEXTURE_MIP_KERNEL_AVX2: MipAccumulateRowAVX2(accumulated, decoded, rowFloats, weight); break;
+                case TEXTURE_MIP_KERNEL_SSE: MipAccumulateRowSSE(accumulated, decoded, rowFloats, weight); break;
+                default: MipAccumulateRowScalar(accumulated, decoded, rowFloats, weight); break;
+                }
+            }
+
+            switch (job.kernel)
+            {
+            case TEXTURE_MIP_KERNEL_AVX2: MipFilterRowAVX2(accumulated, job.horizontal, job.destinationWidth, filtered); break;
+            case TEXTURE_MIP_KERNEL_SSE: MipFilterRowSSE(accumulated, job.horizontal, 0, job.destinationWidth, filtered); break;
+            default: MipFilterRowScalar(accumulated, job.horizontal, job.destinationWidth, filtered); break;
+            }
+
+            byte* destination = job.destination + (u64)y * job.destinationWidth * 4;
+            for (i32 x = 0; x < job.destinationWidth; x++) {
+                for (i32 channel = 0; channel < 3; channel++) {
+                    const f32 value = filtered[x * 4 + channel];
+                    destination[x * 4 + channel] = job.srgb ? MipEncodeSrgb(tables, value) : MipEncodeUnorm(value);
+                }
+                destination[x * 4 + 3] = MipEncodeUnorm(filtered[x * 4 + 3]);
+            }
+        }
+    }
+
+    void TextureMipDownsample(const byte* source, i32 sourceWidth, i32 sourceHeight, byte* destination, i32 destinationWidth, i32 destinationHeight,
+                              const TextureMipSettings& settings) {
+        Assert(destinationWidth <= sourceWidth && destinationHeight <= sourceHeight, "Mips only ever get smaller");
+
+        ScratchScope scratch;
+        MipDownsampleJob job = {};
+        job.source = source;
+        job.sourceWidth = sourceWidth;
+        job.sourceHeight = sourceHeight;
+        job.destination = destination;
+        job.destinationWidth = destinationWidth;
+        job.destinationHeight = destinationHeight;
+        job.srgb = settings.srgb;
+        job.kernel = settings.kernel == TEXTURE_MIP_KERNEL_AUTO ? TextureMipGetBestKernel() : settings.kernel;
+        MipComputeTaps(sourceWidth, destinationWidth, settings.filter, job.horizontal);
+        MipComputeTaps(sourceHeight, destinationHeight, settings.filter, job.vertical);
+
+        const i32 workerCount = Jobs::GetWorkerCount();
+        if (workerCount > 0 && destinationWidth * destinationHeight >= MIP_PARALLEL_MIN_TEXELS) {
+            // A few bands per thread so an unlucky worker doesn't hold everyone up.
+            job.bandCount = (workerCount + 1) * 4 < destinationHeight ? (workerCount + 1) * 4 : destinationHeight;
+            Jobs::ParallelFor(job.bandCount, MipDownsampleBand, &job);
+        }
+        else {
+            job.bandCount = 1;
+            MipDownsampleBand(0, &job);
+        }
+    }
+
+    void TextureMipGenerateChain(byte* chain, i32 width, i32 height, i32 mipCount, const TextureMipSettings& settings) {
+        Assert(mipCount >= 1 && mipCount <= TextureMipGetCount(width, height), "Invalid mip count");
+
+        for (i32 mip = 1; mip < mipCount; mip++) {
+            const byte* source = chain + TextureMipGetOffset(width, height, mip - 1);
+            byte* destination = chain + TextureMipGetOffset(width, height, mip);
+            TextureMipDownsample(source, TextureMipGetSize(width, mip - 1), TextureMipGetSize(height, mip - 1),
+                destination, TextureMipGetSize(width, mip), TextureMipGetSize(height, mip), settings);
+        }
+    }
+}
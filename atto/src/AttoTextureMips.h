@@ -0,0 +1,55 @@
+#pragma once
+
+#include "AttoDefines.h"
+
+namespace atto
+{
+    // CPU mip chain generation for RGBA8 textures. Levels are filtered separably in linear space and large levels
+    // are split into row bands that run on the job workers, so this is safe to call from the cooker and at load time.
+
+    enum TextureMipFilter : u32 {
+        // Averages the texels each destination texel covers. Cheapest, slightly blurry on odd sizes.
+        TEXTURE_MIP_FILTER_BOX = 0,
+        // Kaiser windowed sinc, radius 3. Sharp with very little ringing, the default.
+        TEXTURE_MIP_FILTER_KAISER,
+        // Lanczos 3. Sharpest, rings a little around hard edges.
+        TEXTURE_MIP_FILTER_LANCZOS,
+        TEXTURE_MIP_FILTER_COUNT,
+    };
+
+    // Which implementation runs the filters. Every kernel produces exactly the same texels as the scalar one,
+    // which is the reference the others are tested against.
+    enum TextureMipKernel : u32 {
+        TEXTURE_MIP_KERNEL_AUTO = 0,
+        TEXTURE_MIP_KERNEL_SCALAR,
+        TEXTURE_MIP_KERNEL_SSE,
+        TEXTURE_MIP_KERNEL_AVX2,
+        TEXTURE_MIP_KERNEL_COUNT,
+    };
+
+    struct TextureMipSettings {
+        TextureMipFilter    filter = TEXTURE_MIP_FILTER_KAISER;
+        // Colour channels are sRGB encoded and get averaged in linear space. Alpha is always linear.
+        bool                srgb = true;
+        TextureMipKernel    kernel = TEXTURE_MIP_KERNEL_AUTO;
+    };
+
+    const char*         TextureMipFilterToString(TextureMipFilter filter);
+    const char*         TextureMipKernelToString(TextureMipKernel kernel);
+    // The fastest kernel the CPU supports, what TEXTURE_MIP_KERNEL_AUTO resolves to.
+    TextureMipKernel    TextureMipGetBestKernel();
+
+    // Every level halves both sizes, rounding down, until 1x1.
+    i32                 TextureMipGetCount(i32 width, i32 height);
+    i32                 TextureMipGetSize(i32 size, i32 mip);
+    // Levels are stored one after another as tightly packed RGBA8 rows.
+    u64                 TextureMipGetOffset(i32 width, i32 height, i32 mip);
+    u64                 TextureMipGetChainSizeBytes(i32 width, i32 height, i32 mipCount);
+
+    // Filters one RGBA8 level down to the next.
+    void                TextureMipDownsample(const byte* source, i32 sourceWidth, i32 sourceHeight, byte* destination, i32 destinationWidth, i32 destinationHeight,
+                                             const TextureMipSettings& settings);
+    // chain holds TextureMipGetChainSizeBytes bytes with level 0 already filled in, levels 1 to mipCount - 1 are
+    // written, each from the one before it.
+    void                TextureMipGenerateChain(byte* chain, i32 width, i32 height, i32 mipCount, const TextureMipSettings& settings);
+}
@@ -15,8 +15,6 @@
 * -- FONT: Add support for text wrapping (MAYBE)
 * 
 * -- ASSETS: Locked down asset paths
-* -- ASSETS: Add threading to asset loading
-* -- ASSETS: Pack asset files
 * 
 */
 
@@ -50,6 +48,7 @@ int main(const int argc, const char** argv) {
     f64 lagMS = 0.0f;
 
     while (Application::AppIsRunning(app)) {
+        Memory::ResetFrame();
         Application::UpdateApp(app);
         f64 currentTimeMS = glfwGetTime() * 1000.0;
         f64 elapsedMS = currentTimeMS - lastTimeMS;
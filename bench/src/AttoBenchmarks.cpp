@@ -0,0 +1,780 @@
+#include "AttoBenchmarks.h"
+#include "AttoLib.h"
+#include "AttoAssetImport.h"
+#include "AttoAssetPack.h"
+#include "AttoAsyncIO.h"
+#include "AttoCompression.h"
+#include "AttoJobs.h"
+#include "AttoMappedFile.h"
+#include "AttoMeshQuantize.h"
+#include "AttoTextureCompress.h"
+#include "AttoTextureMips.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+
+namespace atto
+{
+    typedef std::chrono::high_resolution_clock BenchmarkClock;
+
+    // Results are written here so the optimizer can't throw the measured work away.
+    static volatile i64 benchmarkSink = 0;
+
+    static f64 BenchmarkElapsedNS(BenchmarkClock::time_point start) {
+        return (f64)std::chrono::duration_cast<std::chrono::nanoseconds>(BenchmarkClock::now() - start).count();
+    }
+
+    // Roughly the size and layout of a registered asset, so the linear scan touches as much memory as FindAsset used to.
+    struct BenchmarkAssetEntry {
+        u32         id;
+        bool        isLoaded;
+        LargeString path;
+    };
+
+    void BenchmarkAssetLookup() {
+        const i32 maxAssetCount = 20000;
+        const i32 assetCounts[] = { 100, 2000, maxAssetCount };
+
+        BenchmarkAssetEntry* entries = new BenchmarkAssetEntry[maxAssetCount];
+        FixedHashMap<u32, i32, 65536>* lookup = new FixedHashMap<u32, i32, 65536>();
+        u32* queries = new u32[maxAssetCount];
+
+        for (i32 countIndex = 0; countIndex < 3; countIndex++) {
+            const i32 assetCount = assetCounts[countIndex];
+
+            lookup->Clear();
+            for (i32 assetIndex = 0; assetIndex < assetCount; assetIndex++) {
+                BenchmarkAssetEntry& entry = entries[assetIndex];
+                entry.path = StringFormat::Large("assets/benchmark/asset_%d", assetIndex);
+                entry.id = StringHash::Hash(entry.path.GetCStr());
+                entry.isLoaded = false;
+                lookup->Add(entry.id, assetIndex);
+            }
+
+            // Query in a scrambled order so neither approach gets to walk memory linearly.
+            for (i32 queryIndex = 0; queryIndex < assetCount; queryIndex++) {
+                queries[queryIndex] = entries[(i32)(((u64)queryIndex * 7919) % (u64)assetCount)].id;
+            }
+
+            const i32 linearLookups = glm::max(1000, 20000000 / assetCount);
+            i64 linearChecksum = 0;
+            BenchmarkClock::time_point start = BenchmarkClock::now();
+            for (i32 lookupIndex = 0; lookupIndex < linearLookups; lookupIndex++) {
+                const u32 id = queries[lookupIndex % assetCount];
+                for (i32 assetIndex = 0; assetIndex < assetCount; assetIndex++) {
+                    if (entries[assetIndex].id == id) {
+                        linearChecksum += assetIndex;
+                        break;
+                    }
+                }
+            }
+            const f64 linearNS = BenchmarkElapsedNS(start) / (f64)linearLookups;
+
+            const i32 hashLookups = 2000000;
+            i64 hashChecksum = 0;
+            start = BenchmarkClock::now();
+            for (i32 lookupIndex = 0; lookupIndex < hashLookups; lookupIndex++) {
+                const i32* assetIndex = lookup->Find(queries[lookupIndex % assetCount]);
+                hashChecksum += *assetIndex;
+            }
+            const f64 hashNS = BenchmarkElapsedNS(start) / (f64)hashLookups;
+
+            benchmarkSink = linearChecksum + hashChecksum;
+
+            ATTOINFO("Asset lookup, %5d assets: linear %9.2f ns, hashed %6.2f ns (%.1fx)",
+                assetCount, linearNS, hashNS, linearNS / hashNS);
+        }
+
+        delete[] queries;
+        delete lookup;
+        delete[] entries;
+    }
+
+    // Render sort key style elements, 64 bit key plus a payload.
+    struct BenchmarkSortItem {
+        u64 key;
+        u32 payload;
+    };
+
+    static i32 BenchmarkSortCompare(const void* a, const void* b) {
+        const u64 keyA = ((const BenchmarkSortItem*)a)->key;
+        const u64 keyB = ((const BenchmarkSortItem*)b)->key;
+        return keyA < keyB ? -1 : (keyA > keyB ? 1 : 0);
+    }
+
+    static void BenchmarkSortFill(BenchmarkSortItem* items, i32 count) {
+        u64 state = 0x9E3779B97F4A7C15ull;
+        for (i32 itemIndex = 0; itemIndex < count; itemIndex++) {
+            state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+            items[itemIndex].key = state;
+            items[itemIndex].payload = (u32)itemIndex;
+        }
+    }
+
+    bool BenchmarkSort() {
+        const i32 itemCounts[] = { 1000, 10000, 100000 };
+        const i32 maxItemCount = 100000;
+        const char* methodNames[] = { "qsort", "intro", "stable", "radix" };
+
+        BenchmarkSortItem* items = new BenchmarkSortItem[maxItemCount];
+        bool passed = true;
+
+        for (i32 countIndex = 0; countIndex < 3; countIndex++) {
+            const i32 itemCount = itemCounts[countIndex];
+            const i32 iterations = glm::max(5, 2000000 / itemCount);
+            f64 elapsedNS[4] = {};
+
+            for (i32 iteration = 0; iteration < iterations; iteration++) {
+                for (i32 method = 0; method < 4; method++) {
+                    BenchmarkSortFill(items, itemCount);
+
+                    BenchmarkClock::time_point start = BenchmarkClock::now();
+                    switch (method) {
+                        case 0: qsort(items, (size_t)itemCount, sizeof(BenchmarkSortItem), BenchmarkSortCompare); break;
+                        case 1: IntroSort(items, itemCount, [](const BenchmarkSortItem& a, const BenchmarkSortItem& b) { return a.key < b.key; }); break;
+                        case 2: StableSort(items, itemCount, [](const BenchmarkSortItem& a, const BenchmarkSortItem& b) { return a.key < b.key; }); break;
+                        case 3: RadixSort(items, itemCount, [](const BenchmarkSortItem& item) { return item.key; }); break;
+                    }
+                    elapsedNS[method] += BenchmarkElapsedNS(start);
+
+                    for (i32 itemIndex = 1; itemIndex < itemCount; itemIndex++) {
+                        if (items[itemIndex - 1].key > items[itemIndex].key) {
+                            ATTOERROR("Sort, %s left %d items unsorted at %d", methodNames[method], itemCount, itemIndex);
+                            passed = false;
+                            break;
+                        }
+                    }
+                    benchmarkSink = benchmarkSink + items[itemCount / 2].payload;
+                }
+            }
+
+            const f64 scale = 1.0 / (1000.0 * iterations);
+            ATTOINFO("Sort, %6d items: qsort %8.1f us, intro %8.1f us, stable %8.1f us, radix %8.1f us",
+                itemCount, elapsedNS[0] * scale, elapsedNS[1] * scale, elapsedNS[2] * scale, elapsedNS[3] * scale);
+        }
+
+        delete[] items;
+
+        return passed;
+    }
+
+    template<typename _hash_>
+    static void BenchmarkAssetHashRun(const char* name, const TransientList<LargeString>& paths, u64 totalBytes, _hash_ hash) {
+        const i32 pathCount = paths.GetCount();
+        const i32 iterations = glm::max(10, (i32)(200000000 / glm::max(totalBytes, (u64)1)));
+
+        // Unsigned, 64 bit hashes overflow a signed sum.
+        u64 checksum = 0;
+        BenchmarkClock::time_point start = BenchmarkClock::now();
+        for (i32 iteration = 0; iteration < iterations; iteration++) {
+            for (i32 pathIndex = 0; pathIndex < pathCount; pathIndex++) {
+                const LargeString& path = paths[pathIndex];
+                checksum += (u64)hash(path.GetCStr(), (u32)path.GetLength());
+            }
+        }
+        const f64 elapsedNS = BenchmarkElapsedNS(start);
+        benchmarkSink = (i64)checksum;
+
+        // Count ids shared by more than one path.
+        ScratchScope scratch;
+        TransientList<u64> hashes(Memory::GetScratchArena(), pathCount);
+        for (i32 pathIndex = 0; pathIndex < pathCount; pathIndex++) {
+            hashes.Add((u64)hash(paths[pathIndex].GetCStr(), (u32)paths[pathIndex].GetLength()));
+        }
+        RadixSort(hashes.GetData(), hashes.GetCount(), [](u64 value) { return value; });
+
+        i32 collisions = 0;
+        for (i32 hashIndex = 1; hashIndex < hashes.GetCount(); hashIndex++) {
+            if (hashes[hashIndex] == hashes[hashIndex - 1]) {
+                collisions++;
+            }
+        }
+
+        const f64 bytesHashed = (f64)totalBytes * (f64)iterations;
+        ATTOINFO("Asset hash %-8s: %7.1f ns per path, %8.1f MB/s, %d collisions",
+            name, elapsedNS / ((f64)pathCount * iterations), bytesHashed / (elapsedNS / 1e9) / (1024.0 * 1024.0), collisions);
+    }
+
+    void BenchmarkAssetHash(const char* assetPath) {
+        ScratchScope scratch;
+        TransientList<LargeString> paths(Memory::GetScratchArena(), 256);
+
+        // Hash what RegisterAssets hashes, forward slashes and no extension.
+        u64 totalBytes = 0;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(assetPath)) {
+            if (entry.is_regular_file() == false) {
+                continue;
+            }
+
+            LargeString path = LargeString::FromLiteral(entry.path().string().c_str());
+            path.BackSlashesToSlashes();
+            path.StripFileExtension();
+            totalBytes += (u64)path.GetLength();
+            paths.Add(path);
+        }
+
+        if (paths.IsEmpty()) {
+            ATTOWARN("Asset hash benchmark, no files found in %s", assetPath);
+            return;
+        }
+
+        ATTOINFO("Asset hash benchmark over %d paths, %llu bytes", paths.GetCount(), totalBytes);
+        BenchmarkAssetHashRun("DEK", paths, totalBytes, [](const char* str, u32 length) { return (u64)StringHash::DEKHash(str, length); });
+        BenchmarkAssetHashRun("XXH32", paths, totalBytes, [](const char* str, u32 length) { return (u64)StringHash::XXHash32(str, length); });
+        BenchmarkAssetHashRun("FNV1a64", paths, totalBytes, [](const char* str, u32 length) { return StringHash::FNV1a64(str, length); });
+    }
+
+    static void BenchmarkMeshQuantizeFill(f32* vertices, i32 vertexCount) {
+        u64 state = 0x9E3779B97F4A7C15ull;
+        auto next = [&state]() {
+            state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+            return (f32)(state >> 40) * (1.0f / 16777216.0f);
+        };
+
+        // Building sized positions, tiling uvs and normals spread over the whole sphere.
+        for (i32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++) {
+            f32* vertex = vertices + vertexIndex * MESH_PNT_FLOATS_PER_VERTEX;
+            vertex[0] = next() * 8.0f - 4.0f;
+            vertex[1] = next() * 12.0f;
+            vertex[2] = next() * 8.0f - 4.0f;
+
+            const f32 z = next() * 2.0f - 1.0f;
+            const f32 angle = next() * 2.0f * glm::pi<f32>();
+            const f32 radius = glm::sqrt(1.0f - z * z);
+            vertex[3] = radius * glm::cos(angle);
+            vertex[4] = radius * glm::sin(angle);
+            vertex[5] = z;
+
+            vertex[6] = next() * 4.0f - 1.0f;
+            vertex[7] = next() * 4.0f - 1.0f;
+        }
+    }
+
+    bool BenchmarkMeshQuantize() {
+        const i32 vertexCount = 1 << 16;
+        const i32 iterations = 20;
+        bool passed = true;
+
+        ScratchScope scratch;
+        f32* source = Memory::AllocateScratchStruct<f32>(vertexCount * MESH_PNT_FLOATS_PER_VERTEX);
+        f32* decoded = Memory::AllocateScratchStruct<f32>(vertexCount * MESH_PNT_FLOATS_PER_VERTEX);
+        MeshQuantizedVertex* encoded = Memory::AllocateScratchStruct<MeshQuantizedVertex>(vertexCount);
+        BenchmarkMeshQuantizeFill(source, vertexCount);
+
+        const MeshVertexFormat formats[] = { MESH_VERTEX_FORMAT_QUANTIZED, MESH_VERTEX_FORMAT_QUANTIZED_HALF };
+        for (const MeshVertexFormat format : formats) {
+            MeshQuantization quantization = {};
+            MeshQuantizationCompute(source, vertexCount, format, quantization);
+
+            BenchmarkClock::time_point start = BenchmarkClock::now();
+            for (i32 iteration = 0; iteration < iterations; iteration++) {
+                MeshEncodeQuantized(source, vertexCount, format, quantization, encoded);
+            }
+            const f64 encodeNS = BenchmarkElapsedNS(start);
+
+            start = BenchmarkClock::now();
+            for (i32 iteration = 0; iteration < iterations; iteration++) {
+                MeshDecodeQuantized(encoded, vertexCount, format, quantization, decoded);
+            }
+            const f64 decodeNS = BenchmarkElapsedNS(start);
+            benchmarkSink = benchmarkSink + encoded[vertexCount / 2].position[0];
+
+            // Position error is relative to the bounds for unorm16 and to the distance from the centre for halves.
+            f32 maxPositionError = 0.0f;
+            f32 maxNormalErrorDegrees = 0.0f;
+            f32 maxUVError = 0.0f;
+            for (i32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++) {
+                const f32* a = source + vertexIndex * MESH_PNT_FLOATS_PER_VERTEX;
+                const f32* b = decoded + vertexIndex * MESH_PNT_FLOATS_PER_VERTEX;
+                for (i32 axis = 0; axis < 3; axis++) {
+                    const f32 range = format == MESH_VERTEX_FORMAT_QUANTIZED ? quantization.positionScale[axis] : glm::max(glm::abs(a[axis] - quantization.positionOffset[axis]), 1.0f);
+                    maxPositionError = glm::max(maxPositionError, glm::abs(a[axis] - b[axis]) / range);
+                }
+
+                const f32 cosine = glm::clamp(a[3] * b[3] + a[4] * b[4] + a[5] * b[5], -1.0f, 1.0f);
+                maxNormalErrorDegrees = glm::max(maxNormalErrorDegrees, glm::degrees(glm::acos(cosine)));
+
+                for (i32 axis = 0; axis < 2; axis++) {
+                    maxUVError = glm::max(maxUVError, glm::abs(a[6 + axis] - b[6 + axis]) / quantization.uvScale[axis]);
+                }
+            }
+
+            // Half a step of the format, with some slack for float rounding. Octahedral snorm16 is good to about 0.04 degrees.
+            const f32 unormBound = 0.5f / 65535.0f * 1.05f;
+            const f32 positionBound = format == MESH_VERTEX_FORMAT_QUANTIZED ? unormBound : 1.0f / 2048.0f;
+            const f32 normalBoundDegrees = 0.05f;
+            if (maxPositionError > positionBound || maxNormalErrorDegrees > normalBoundDegrees || maxUVError > unormBound) {
+                ATTOERROR("Mesh quantize %s is outside its error bounds, position %.2e of %.2e, normal %.4f of %.4f deg, uv %.2e of %.2e",
+                    MeshVertexFormatToString(format), maxPositionError, positionBound, maxNormalErrorDegrees, normalBoundDegrees, maxUVError, unormBound);
+                passed = false;
+            }
+
+            const f64 scale = 1.0 / ((f64)vertexCount * iterations);
+            ATTOINFO("Mesh quantize %-9s: encode %5.2f ns, decode %5.2f ns per vertex, max error position %.2e, normal %.4f deg, uv %.2e, %u -> %u bytes",
+                MeshVertexFormatToString(format), encodeNS * scale, decodeNS * scale, maxPositionError, maxNormalErrorDegrees, maxUVError,
+                MeshVertexFormatGetStride(MESH_VERTEX_FORMAT_PNT), MeshVertexFormatGetStride(format));
+        }
+
+        return passed;
+    }
+
+    bool BenchmarkTextureMips() {
+        // Odd sized on purpose so the non power of two paths get exercised too.
+        const i32 width = 1023;
+        const i32 height = 769;
+        const i32 mipCount = TextureMipGetCount(width, height);
+        const u64 chainBytes = TextureMipGetChainSizeBytes(width, height, mipCount);
+
+        ScratchScope scratch;
+        byte* reference = Memory::AllocateScratchStruct<byte>((i32)chainBytes);
+        byte* chain = Memory::AllocateScratchStruct<byte>((i32)chainBytes);
+
+        // Gradients with noise and hard edges, which is what makes the windowed sinc filters ring.
+        u64 state = 0x9E3779B97F4A7C15ull;
+        for (i32 y = 0; y < height; y++) {
+            for (i32 x = 0; x < width; x++) {
+                state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+                byte* texel = reference + ((u64)y * width + x) * 4;
+                texel[0] = (byte)(x * 255 / width);
+                texel[1] = ((x / 16 + y / 16) & 1) != 0 ? 230 : 20;
+                texel[2] = (byte)(state >> 56);
+                texel[3] = (byte)(y * 255 / height);
+            }
+        }
+        memcpy(chain, reference, (u64)width * height * 4);
+
+        bool passed = true;
+        for (u32 filter = 0; filter < TEXTURE_MIP_FILTER_COUNT; filter++) {
+            f64 scalarNS = 0.0;
+            for (u32 kernel = TEXTURE_MIP_KERNEL_SCALAR; kernel < TEXTURE_MIP_KERNEL_COUNT; kernel++) {
+                if (kernel == TEXTURE_MIP_KERNEL_AVX2 && TextureMipGetBestKernel() != TEXTURE_MIP_KERNEL_AVX2) {
+                    continue;
+                }
+
+                TextureMipSettings settings = {};
+                settings.filter = (TextureMipFilter)filter;
+                settings.kernel = (TextureMipKernel)kernel;
+
+                // The scalar chain is the reference, every other kernel has to match it exactly.
+                byte* result = kernel == TEXTURE_MIP_KERNEL_SCALAR ? reference : chain;
+                const BenchmarkClock::time_point start = BenchmarkClock::now();
+                TextureMipGenerateChain(result, width, height, mipCount, settings);
+                const f64 elapsedNS = BenchmarkElapsedNS(start);
+                if (kernel == TEXTURE_MIP_KERNEL_SCALAR) {
+                    scalarNS = elapsedNS;
+                }
+
+                const u64 firstMipOffset = TextureMipGetOffset(width, height, 1);
+                if (memcmp(result + firstMipOffset, reference + firstMipOffset, chainBytes - firstMipOffset) != 0) {
+                    ATTOERROR("Texture mips %s %s does not match the scalar reference", TextureMipFilterToString(settings.filter),
+                        TextureMipKernelToString(settings.kernel));
+                    passed = false;
+                }
+                benchmarkSink = benchmarkSink + result[chainBytes - 1];
+
+                ATTOINFO("Texture mips %-7s %-6s: %dx%d, %d levels, %7.2f ms, %.2fx scalar", TextureMipFilterToString(settings.filter),
+                    TextureMipKernelToString(settings.kernel), width, height, mipCount, elapsedNS / 1000000.0, scalarNS / elapsedNS);
+            }
+        }
+
+        return passed;
+    }
+
+    bool BenchmarkTextureCompress() {
+        const i32 width = 512;
+        const i32 height = 256;
+        const i32 iterations = 4;
+
+        ScratchScope scratch;
+        byte* source = Memory::AllocateScratchStruct<byte>(width * height * 4);
+        byte* decoded = Memory::AllocateScratchStruct<byte>(width * height * 4);
+        byte* blocks = Memory::AllocateScratchStruct<byte>((i32)TextureFormatGetLevelSizeBytes(TEXTURE_FORMAT_BC7, width, height));
+
+        // Smooth gradients, hard edges and a little noise, roughly what albedo textures look like to the encoder.
+        u64 state = 0x9E3779B97F4A7C15ull;
+        for (i32 y = 0; y < height; y++) {
+            for (i32 x = 0; x < width; x++) {
+                state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+                byte* texel = source + ((u64)y * width + x) * 4;
+                texel[0] = (byte)(128.0f + 100.0f * glm::sin(x * 0.05f));
+                texel[1] = ((x / 16 + y / 16) & 1) != 0 ? 200 : 40;
+                texel[2] = (byte)((x + y) / 4 + ((state >> 60) & 7));
+                texel[3] = (byte)(y * 255 / height);
+            }
+        }
+
+        // Floors well below what the encoder reaches on this image, they catch broken encoders, not small regressions.
+        const TextureFormat formats[] = { TEXTURE_FORMAT_BC1, TEXTURE_FORMAT_BC3, TEXTURE_FORMAT_BC4, TEXTURE_FORMAT_BC7 };
+        const f32 minimumPSNR[] = { 38.0f, 38.0f, 50.0f, 42.0f };
+        bool passed = true;
+        for (i32 formatIndex = 0; formatIndex < 4; formatIndex++) {
+            const TextureFormat format = formats[formatIndex];
+            const i32 channelCount = format == TEXTURE_FORMAT_BC4 ? 1 : (format == TEXTURE_FORMAT_BC1 ? 3 : 4);
+            f32 previousPSNR = 0.0f;
+            for (u32 quality = 0; quality < TEXTURE_COMPRESS_QUALITY_COUNT; quality++) {
+                TextureCompressSettings settings = {};
+                settings.format = format;
+                settings.quality = (TextureCompressQuality)quality;
+
+                const BenchmarkClock::time_point start = BenchmarkClock::now();
+                for (i32 iteration = 0; iteration < iterations; iteration++) {
+                    TextureCompress(source, width, height, blocks, settings);
+                }
+                const f64 elapsedNS = BenchmarkElapsedNS(start) / iterations;
+
+                TextureDecompress(blocks, width, height, format, decoded);
+                const f32 psnr = TextureComputePSNR(source, decoded, width, height, channelCount);
+                benchmarkSink = benchmarkSink + blocks[0];
+
+                if (psnr < minimumPSNR[formatIndex]) {
+                    ATTOERROR("Texture compress %s %s: %.2f dB is below the %.2f dB floor", TextureFormatToString(format),
+                        TextureCompressQualityToString(settings.quality), psnr, minimumPSNR[formatIndex]);
+                    passed = false;
+                }
+                // Higher quality settings must not compress worse.
+                if (psnr < previousPSNR - 0.01f) {
+                    ATTOERROR("Texture compress %s %s: %.2f dB is worse than the previous quality's %.2f dB", TextureFormatToString(format),
+                        TextureCompressQualityToString(settings.quality), psnr, previousPSNR);
+                    passed = false;
+                }
+                previousPSNR = psnr;
+
+                ATTOINFO("Texture compress %s %-7s: %7.2f ms, %6.2f MTexels/s, %.2f dB PSNR", TextureFormatToString(format),
+                    TextureCompressQualityToString(settings.quality), elapsedNS / 1000000.0, (f64)width * height * 1000.0 / elapsedNS, psnr);
+            }
+        }
+
+        return passed;
+    }
+
+    bool BenchmarkTextureExpand() {
+        const i32 texelCount = 1024 * 1024;
+        const i32 iterations = 8;
+        bool passed = true;
+
+        ScratchScope scratch;
+        byte* source = Memory::AllocateScratchStruct<byte>(texelCount * 3);
+        byte* expanded = Memory::AllocateScratchStruct<byte>(texelCount * 4);
+        byte* reference = Memory::AllocateScratchStruct<byte>(texelCount * 4);
+        u64 state = 0x9E3779B97F4A7C15ull;
+        for (i32 index = 0; index < texelCount * 3; index++) {
+            state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+            source[index] = (byte)(state >> 56);
+        }
+
+        for (i32 channels = 1; channels <= 3; channels++) {
+            BenchmarkClock::time_point start = BenchmarkClock::now();
+            for (i32 iteration = 0; iteration < iterations; iteration++) {
+                for (i32 texel = 0; texel < texelCount; texel++) {
+                    const byte* in = source + (u64)texel * channels;
+                    byte* out = reference + (u64)texel * 4;
+                    out[0] = in[0];
+                    out[1] = channels == 3 ? in[1] : in[0];
+                    out[2] = channels == 3 ? in[2] : in[0];
+                    out[3] = channels == 2 ? in[1] : 255;
+                }
+            }
+            const f64 scalarNS = BenchmarkElapsedNS(start) / iterations;
+
+            start = BenchmarkClock::now();
+            for (i32 iteration = 0; iteration < iterations; iteration++) {
+                TextureExpandRGBA8(source, channels, texelCount, expanded);
+            }
+            const f64 simdNS = BenchmarkElapsedNS(start) / iterations;
+
+            if (memcmp(expanded, reference, (u64)texelCount * 4) != 0) {
+                ATTOERROR("Texture expand %d channels does not match the scalar reference", channels);
+                passed = false;
+            }
+            benchmarkSink = benchmarkSink + expanded[texelCount];
+
+            const f64 outputMB = (f64)texelCount * 4 / (1024.0 * 1024.0);
+            ATTOINFO("Texture expand %d channels to RGBA8: scalar %8.1f MB/s, simd %8.1f MB/s, %.2fx",
+                channels, outputMB / (scalarNS / 1e9), outputMB / (simdNS / 1e9), scalarNS / simdNS);
+        }
+
+        return passed;
+    }
+
+    void BenchmarkTextureDecode(const char* assetPath) {
+        List<LargeString> paths;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(assetPath)) {
+            const std::string extension = entry.path().extension().string();
+            if (entry.is_regular_file() && (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".bmp")) {
+                paths.Add(LargeString::FromLiteral(entry.path().string().c_str()));
+            }
+        }
+
+        const i32 imageCount = paths.GetNum();
+        if (imageCount == 0) {
+            ATTOWARN("Texture decode benchmark, no images found in %s", assetPath);
+            return;
+        }
+
+        // Mapped and touched up front, only decoding is timed.
+        MappedFile* files = new MappedFile[imageCount];
+        List<TextureImportRequest> requests;
+        requests.SetNum(imageCount);
+        u64 sourceBytes = 0;
+        for (i32 imageIndex = 0; imageIndex < imageCount; imageIndex++) {
+            TextureImportRequest& request = requests[imageIndex];
+            request = {};
+            if (files[imageIndex].Open(paths[imageIndex].GetCStr())) {
+                request.data = files[imageIndex].GetData();
+                request.sizeBytes = files[imageIndex].GetSize();
+                for (u64 offset = 0; offset < request.sizeBytes; offset += 4096) {
+                    benchmarkSink = benchmarkSink + request.data[offset];
+                }
+                sourceBytes += request.sizeBytes;
+            }
+        }
+
+        ATTOINFO("Texture decode benchmark over %d images, %llu bytes", imageCount, sourceBytes);
+
+        // One untimed pass so the first thread count doesn't pay for warming up the allocator and the workers.
+        TextureImportBatch(requests.GetData(), imageCount);
+        for (i32 imageIndex = 0; imageIndex < imageCount; imageIndex++) {
+            if (requests[imageIndex].pixels != nullptr) {
+                TextureImportFree(requests[imageIndex].pixels);
+                requests[imageIndex].pixels = nullptr;
+            }
+        }
+
+        const i32 maxThreadCount = Jobs::GetWorkerCount() + 1;
+        const i32 iterations = 3;
+        f64 singleThreadNS = 0.0;
+        for (i32 threadCount = 1; ; threadCount = threadCount * 2 < maxThreadCount ? threadCount * 2 : maxThreadCount) {
+            u64 decodedBytes = 0;
+            i32 failedCount = 0;
+            const BenchmarkClock::time_point start = BenchmarkClock::now();
+            for (i32 iteration = 0; iteration < iterations; iteration++) {
+                TextureImportBatch(requests.GetData(), imageCount, threadCount);
+                for (i32 imageIndex = 0; imageIndex < imageCount; imageIndex++) {
+                    TextureImportRequest& request = requests[imageIndex];
+                    if (request.pixels == nullptr) {
+                        failedCount++;
+                        continue;
+                    }
+
+                    decodedBytes += (u64)request.width * request.height * request.channels;
+                    TextureImportFree(request.pixels);
+                    request.pixels = nullptr;
+                }
+            }
+            const f64 elapsedNS = BenchmarkElapsedNS(start);
+            if (threadCount == 1) {
+                singleThreadNS = elapsedNS;
+            }
+
+            ATTOINFO("Texture decode %2d threads: %8.1f MB/s decoded, %7.1f MB/s source, %.2fx, %d failed", threadCount,
+                (f64)decodedBytes / (elapsedNS / 1e9) / (1024.0 * 1024.0), (f64)sourceBytes * iterations / (elapsedNS / 1e9) / (1024.0 * 1024.0),
+                singleThreadNS / elapsedNS, failedCount / iterations);
+
+            if (threadCount == maxThreadCount) {
+                break;
+            }
+        }
+
+        delete[] files;
+    }
+
+    bool BenchmarkCompression(const char* packPath) {
+        AssetPack pack;
+        if (pack.Open(packPath) == false) {
+            return false;
+        }
+
+        // Decoded once up front, so every level starts from the same bytes whatever the pack was written with.
+        List<byte> source;
+        List<u64> payloadSizes;
+        List<byte> storage;
+        const i32 entryCount = pack.GetEntryCount();
+        for (i32 entryIndex = 0; entryIndex < entryCount; entryIndex++) {
+            const AssetPackEntry& entry = pack.GetEntry(entryIndex);
+            if (entry.type != ASSET_TYPE_MESH && entry.type != ASSET_TYPE_TEXTURE) {
+                continue;
+            }
+
+            const byte* payload = pack.GetPayload(entry, storage);
+            if (payload == nullptr || entry.sizeBytes == 0) {
+                continue;
+            }
+
+            const i32 offset = source.GetNum();
+            source.SetNum(offset + (i32)entry.sizeBytes);
+            memcpy(source.GetData() + offset, payload, entry.sizeBytes);
+            payloadSizes.Add(entry.sizeBytes);
+        }
+
+        const u64 sourceBytes = (u64)source.GetNum();
+        if (sourceBytes == 0) {
+            ATTOWARN("Compression benchmark, no mesh or texture payloads in %s", packPath);
+            return true;
+        }
+
+        ATTOINFO("Compression benchmark over %d payloads, %llu bytes", payloadSizes.GetNum(), sourceBytes);
+
+        const i32 iterations = 3;
+        const f64 sourceMB = (f64)sourceBytes / (1024.0 * 1024.0);
+        const i32 payloadCount = payloadSizes.GetNum();
+        List<byte> compressed;
+        List<byte> decompressed;
+        List<u64> compressedSizes;
+        compressedSizes.SetNum(payloadCount);
+        decompressed.SetNum((i32)sourceBytes);
+        bool passed = true;
+        for (u32 level = LZ_LEVEL_FAST; level < LZ_LEVEL_COUNT; level++) {
+            // One block per payload on a single thread, the way a loader without chunking would see them.
+            compressed.SetNum((i32)(LZCompressBound(sourceBytes) + (u64)payloadCount * 16));
+            u64 compressedBytes = 0;
+            BenchmarkClock::time_point start = BenchmarkClock::now();
+            for (i32 iteration = 0; iteration < iterations; iteration++) {
+                compressedBytes = 0;
+                u64 offset = 0;
+                for (i32 payloadIndex = 0; payloadIndex < payloadCount; payloadIndex++) {
+                    compressedSizes[payloadIndex] = LZCompress(source.GetData() + offset, payloadSizes[payloadIndex],
+                        compressed.GetData() + compressedBytes, (LZLevel)level);
+                    compressedBytes += compressedSizes[payloadIndex];
+                    offset += payloadSizes[payloadIndex];
+                }
+            }
+            const f64 compressNS = BenchmarkElapsedNS(start) / iterations;
+
+            bool decoded = true;
+            start = BenchmarkClock::now();
+            for (i32 iteration = 0; iteration < iterations; iteration++) {
+                u64 offset = 0;
+                u64 compressedOffset = 0;
+                for (i32 payloadIndex = 0; payloadIndex < payloadCount; payloadIndex++) {
+                    decoded &= LZDecompress(compressed.GetData() + compressedOffset, compressedSizes[payloadIndex],
+                        decompressed.GetData() + offset, payloadSizes[payloadIndex]);
+                    compressedOffset += compressedSizes[payloadIndex];
+                    offset += payloadSizes[payloadIndex];
+                }
+            }
+            const f64 decompressNS = BenchmarkElapsedNS(start) / iterations;
+
+            if (decoded == false || memcmp(decompressed.GetData(), source.GetData(), sourceBytes) != 0) {
+                ATTOERROR("LZ %s round trip does not match the source", LZLevelToString((LZLevel)level));
+                passed = false;
+            }
+            memset(decompressed.GetData(), 0, sourceBytes);
+
+            // Chunked as the pack stores them, chunks are decoded on every worker.
+            start = BenchmarkClock::now();
+            LZCompressChunks(source.GetData(), sourceBytes, compressed, (LZLevel)level);
+            const f64 chunkedCompressNS = BenchmarkElapsedNS(start);
+
+            start = BenchmarkClock::now();
+            for (i32 iteration = 0; iteration < iterations; iteration++) {
+                decoded &= LZDecompressChunks(compressed.GetData(), (u64)compressed.GetNum(), decompressed.GetData(), sourceBytes);
+            }
+            const f64 chunkedDecompressNS = BenchmarkElapsedNS(start) / iterations;
+
+            if (decoded == false || memcmp(decompressed.GetData(), source.GetData(), sourceBytes) != 0) {
+                ATTOERROR("LZ %s chunked round trip does not match the source", LZLevelToString((LZLevel)level));
+                passed = false;
+            }
+            benchmarkSink = benchmarkSink + (i64)compressedBytes + decompressed[(i32)(sourceBytes / 2)];
+
+            ATTOINFO("LZ %s: ratio %.3f, compress %7.1f MB/s, decompress %6.2f GB/s, chunked ratio %.3f, compress %7.1f MB/s, decompress %6.2f GB/s on %d threads",
+                LZLevelToString((LZLevel)level), (f64)compressedBytes / sourceBytes, sourceMB / (compressNS / 1e9), sourceMB / 1024.0 / (decompressNS / 1e9),
+                (f64)compressed.GetNum() / sourceBytes, sourceMB / (chunkedCompressNS / 1e9), sourceMB / 1024.0 / (chunkedDecompressNS / 1e9), Jobs::GetWorkerCount() + 1);
+        }
+
+        return passed;
+    }
+
+    struct BenchmarkIOContext {
+        i32 completed;
+        i32 failed;
+    };
+
+    static void BenchmarkIOComplete(const IOCompletion& completion, void* userData) {
+        BenchmarkIOContext& context = *(BenchmarkIOContext*)userData;
+        context.completed++;
+        context.failed += (completion.succeeded && completion.bytesRead == completion.sizeBytes) ? 0 : 1;
+    }
+
+    bool BenchmarkAsyncIO(const char* packPath) {
+        AssetPack pack;
+        if (pack.Open(packPath) == false) {
+            return false;
+        }
+
+        // Every entry over and over, so there are always more reads than IO_MAX_IN_FLIGHT. The pack is in the page
+        // cache after the first pass, this measures what each path costs per read rather than the disk.
+        const i32 entryCount = pack.GetEntryCount();
+        const i32 repeats = entryCount > 0 ? (1024 + entryCount - 1) / entryCount : 0;
+        const i32 readCount = entryCount * repeats;
+        if (readCount == 0) {
+            ATTOWARN("Async IO benchmark, %s is empty", packPath);
+            return true;
+        }
+
+        List<u64> readOffsets;
+        u64 totalBytes = 0;
+        for (i32 readIndex = 0; readIndex < readCount; readIndex++) {
+            readOffsets.Add(totalBytes);
+            totalBytes += pack.GetEntry(readIndex % entryCount).storedSizeBytes;
+        }
+
+        List<byte> expected;
+        List<byte> destination;
+        expected.SetNum((i32)totalBytes);
+        destination.SetNum((i32)totalBytes);
+
+        // Blocking reads one after another, the way loading worked before AsyncIO.
+        BenchmarkClock::time_point start = BenchmarkClock::now();
+        FILE* file = fopen(packPath, "rb");
+        for (i32 readIndex = 0; readIndex < readCount && file != nullptr; readIndex++) {
+            const AssetPackEntry& entry = pack.GetEntry(readIndex % entryCount);
+            fseek(file, (long)entry.offset, SEEK_SET);
+            fread(expected.GetData() + readOffsets[readIndex], 1, (size_t)entry.storedSizeBytes, file);
+        }
+        if (file != nullptr) {
+            fclose(file);
+        }
+        const f64 blockingNS = BenchmarkElapsedNS(start);
+
+        const f64 totalMB = (f64)totalBytes / (1024.0 * 1024.0);
+        ATTOINFO("Async IO benchmark, %d reads, %.2f MB, blocking %.2f ms", readCount, totalMB, blockingNS / 1e6);
+
+        bool passed = true;
+        for (i32 useRing = 1; useRing >= 0; useRing--) {
+            AsyncIO io;
+            io.Initialize(useRing == 1);
+            if (useRing == 1 && io.GetBackend() != IO_BACKEND_IO_URING) {
+                continue;
+            }
+
+            memset(destination.GetData(), 0, totalBytes);
+            List<IORead> reads;
+            BenchmarkIOContext context = {};
+            for (i32 readIndex = 0; readIndex < readCount; readIndex++) {
+                const AssetPackEntry& entry = pack.GetEntry(readIndex % entryCount);
+                reads.Add(IOReadPackEntry(pack, entry, destination.GetData() + readOffsets[readIndex], BenchmarkIOComplete, &context));
+            }
+
+            start = BenchmarkClock::now();
+            io.Submit(reads.GetData(), readCount);
+            i32 pollCount = 0;
+            while (context.completed < readCount) {
+                io.Poll();
+                pollCount++;
+            }
+            const f64 asyncNS = BenchmarkElapsedNS(start);
+
+            if (context.failed != 0 || memcmp(destination.GetData(), expected.GetData(), totalBytes) != 0) {
+                ATTOERROR("Async IO %s, %d reads failed or read different bytes than a blocking read", IOBackendToString(io.GetBackend()), context.failed);
+                passed = false;
+            }
+            benchmarkSink = benchmarkSink + destination[(i32)(totalBytes / 2)];
+
+            ATTOINFO("Async IO %s: %.2f ms, %.0f MB/s, %d polls", IOBackendToString(io.GetBackend()), asyncNS / 1e6, totalMB / (asyncNS / 1e9), pollCount);
+        }
+
+        return passed;
+    }
+}
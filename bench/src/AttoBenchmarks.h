@@ -0,0 +1,25 @@
+#pragma once
+
+namespace atto
+{
+    // Micro benchmarks, results are written to the log. The ones returning bool also check their results against
+    // a reference or a tolerance, they log an error for every check that fails and return false.
+    void BenchmarkAssetLookup();
+    // Also checks that every method sorts.
+    bool BenchmarkSort();
+    void BenchmarkAssetHash(const char* assetPath);
+    // Also checks the round trip error of every format against its bound.
+    bool BenchmarkMeshQuantize();
+    // Also checks that every SIMD kernel matches the scalar reference exactly.
+    bool BenchmarkTextureMips();
+    // Also checks every format against a PSNR floor, through the decoder.
+    bool BenchmarkTextureCompress();
+    // Also checks the SIMD RGBA expansion against the scalar loop.
+    bool BenchmarkTextureExpand();
+    // Decodes every image under assetPath with 1, 2, 4 ... threads.
+    void BenchmarkTextureDecode(const char* assetPath);
+    // Every LZ level over the mesh and texture payloads in the pack, also checks that they round trip.
+    bool BenchmarkCompression(const char* packPath);
+    // Reads every pack entry several times with blocking reads and through each AsyncIO backend, also checks the bytes.
+    bool BenchmarkAsyncIO(const char* packPath);
+}
@@ -0,0 +1,106 @@
+#include "AttoLib.h"
+#include "AttoBenchmarks.h"
+#include "AttoJobs.h"
+
+#include <cstdio>
+#include <filesystem>
+
+/*
+* AttoBench, checks and micro benchmarks for the engine code that doesn't need a window or a device.
+*
+* Without arguments only the checks that need no data run: every sort against sortedness, the quantized vertex
+* formats against their round trip error bounds, every SIMD mip kernel against the scalar reference bit for bit,
+* BC1/BC3/BC4/BC7 against PSNR floors and the SIMD RGBA expansion against the scalar loop. The exit code is 1 when
+* any of them fails, so the run can gate a build.
+*
+* -bench also runs the remaining benchmarks. Asset hashing and texture decoding read the files under -root, LZ
+* and AsyncIO read the pack from -out of AttoCook. Missing data skips those benchmarks, failing checks in them
+* still fail the run.
+*
+* Usage: AttoBench [-bench] [-root assets/] [-pack assets.pack] [-jobs N]
+*/
+
+namespace atto
+{
+    void Application::ConsoleWrite(const char* output, u8 level) {
+        fputs(output, level <= (u8)LogLevel::WARN ? stderr : stdout);
+    }
+
+    void Application::DisplayFatalError(const char* output) {
+    }
+}
+
+using namespace atto;
+
+int main(const int argc, const char** argv) {
+    // Logger keeps its whole message buffer inline, megabytes that don't fit on the main thread's stack.
+    static Logger logger;
+    Memory::Initialize(Megabytes(1), Megabytes(256));
+
+    LargeString assetRoot = LargeString::FromLiteral("assets/");
+    LargeString packPath = LargeString::FromLiteral("assets.pack");
+    i32 workerCount = -1;
+    bool runBenchmarks = false;
+    for (i32 argIndex = 1; argIndex < argc; argIndex++) {
+        const char* arg = argv[argIndex];
+        const bool hasValue = argIndex + 1 < argc;
+        if (strcmp(arg, "-bench") == 0) {
+            runBenchmarks = true;
+        }
+        else if (strcmp(arg, "-root") == 0 && hasValue) {
+            assetRoot = LargeString::FromLiteral(argv[++argIndex]);
+        }
+        else if (strcmp(arg, "-pack") == 0 && hasValue) {
+            packPath = LargeString::FromLiteral(argv[++argIndex]);
+        }
+        else if (strcmp(arg, "-jobs") == 0 && hasValue) {
+            workerCount = atoi(argv[++argIndex]);
+        }
+        else {
+            ATTOERROR("Usage: AttoBench [-bench] [-root assets/] [-pack assets.pack] [-jobs N]");
+            return 1;
+        }
+    }
+
+    Jobs::Initialize(workerCount);
+
+    i32 failedCount = 0;
+    failedCount += BenchmarkSort() ? 0 : 1;
+    failedCount += BenchmarkMeshQuantize() ? 0 : 1;
+    failedCount += BenchmarkTextureMips() ? 0 : 1;
+    failedCount += BenchmarkTextureCompress() ? 0 : 1;
+    failedCount += BenchmarkTextureExpand() ? 0 : 1;
+
+    if (runBenchmarks) {
+        BenchmarkAssetLookup();
+
+        std::error_code error;
+        if (std::filesystem::is_directory(assetRoot.GetCStr(), error)) {
+            BenchmarkAssetHash(assetRoot.GetCStr());
+            BenchmarkTextureDecode(assetRoot.GetCStr());
+        }
+        else {
+            ATTOWARN("Asset root %s does not exist, skipping the asset hash and texture decode benchmarks", assetRoot.GetCStr());
+        }
+
+        if (std::filesystem::is_regular_file(packPath.GetCStr(), error)) {
+            failedCount += BenchmarkCompression(packPath.GetCStr()) ? 0 : 1;
+            failedCount += BenchmarkAsyncIO(packPath.GetCStr()) ? 0 : 1;
+        }
+        else {
+            ATTOWARN("No asset pack at %s, skipping the compression and async IO benchmarks", packPath.GetCStr());
+        }
+    }
+
+    if (failedCount > 0) {
+        ATTOERROR("%d benchmarks failed their checks", failedCount);
+    }
+    else {
+        ATTOINFO("All checks passed");
+    }
+
+    Jobs::Shutdown();
+    Memory::Shutdown();
+
+    return failedCount == 0 ? 0 : 1;
+}
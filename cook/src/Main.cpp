@@ -0,0 +1,375 @@
+#include "AttoLib.h"
+#include "AttoAssetCooked.h"
+#include "AttoAssetPack.h"
+#include "AttoCompression.h"
+#include "AttoJobs.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+/*
+* AttoCook, turns the loose asset tree into the pack the engine ships with.
+* 
+* Meshes, textures and fonts are cooked into runtime ready blobs (see AttoAssetCooked.h), anything else is
+* packed as it is. Cooked blobs are cached next to the asset root, a blob whose header still matches the size
+* and write time of its source is reused, so only changed sources are cooked again. Cooking runs on every core.
+* 
+* Meshes are reordered for the vertex cache and vertex fetch, -overdraw also sorts them for less overdraw and
+* -meshstats logs ACMR/ATVR before and after for every mesh that is cooked, add -force to see all of them.
+* -vertexformat picks the mesh vertex format, 32 byte pnt floats (default) or the 16 byte quantized / half formats.
+* Textures get their full mip chain, -mipfilter picks the filter (kaiser by default) or turns mips off with none.
+* Colour is averaged in linear space, -linearmips treats the texels as plain unorm instead, for data textures.
+* -texformat block compresses every texture (rgba8 by default), -texquality trades cooking time for quality and
+* -texstats logs the PSNR of every texture that is compressed.
+* Pack payloads are LZ compressed when that makes them smaller, -compress picks the level (fast by default) or
+* stores everything as is with none. Byte identical payloads are stored once and the bytes saved are logged.
+* 
+* Usage: AttoCook [-root assets/] [-out assets.pack] [-cache assets.cooked/] [-jobs N] [-force] [-overdraw] [-meshstats]
+*                 [-vertexformat pnt|quantized|half] [-mipfilter box|kaiser|lanczos|none] [-linearmips]
+*                 [-texformat rgba8|bc1|bc3|bc4|bc7] [-texquality fast|default|best] [-texstats] [-compress none|fast|high]
+*/
+
+namespace atto
+{
+    void Application::ConsoleWrite(const char* output, u8 level) {
+        fputs(output, level <= (u8)LogLevel::WARN ? stderr : stdout);
+    }
+
+    void Application::DisplayFatalError(const char* output) {
+    }
+
+    enum CookResult {
+        COOK_RESULT_NONE = 0,
+        COOK_RESULT_UP_TO_DATE,
+        COOK_RESULT_COOKED,
+        COOK_RESULT_PASS_THROUGH,
+        COOK_RESULT_FAILED,
+    };
+
+    struct CookItem {
+        AssetManifestEntry  source;
+        LargeString         cookedPath;
+        CookResult          result;
+    };
+
+    struct CookContext {
+        List<CookItem>          items;
+        CookSettings            settings;
+        bool                    force;
+    };
+
+    static bool CookIsUpToDate(const CookItem& item, const CookSettings& settings) {
+        std::ifstream file(item.cookedPath.GetCStr(), std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        CookedAssetHeader header = {};
+        file.read((char*)&header, sizeof(header));
+        if (file.gcount() != sizeof(header) || CookedAssetGetHeader((const byte*)&header, sizeof(header)) == nullptr) {
+            return false;
+        }
+
+        return header.type == (u32)item.source.type && header.cookFlags == CookAssetGetFlags(item.source.type, settings) &&
+            header.sourceSizeBytes == item.source.sizeBytes && header.sourceWriteTime == item.source.writeTime;
+    }
+
+    static bool CookWriteBlob(const CookItem& item, const List<byte>& blob) {
+        std::error_code error;
+        const std::filesystem::path cookedPath(item.cookedPath.GetCStr());
+        std::filesystem::create_directories(cookedPath.parent_path(), error);
+
+        // Written to the side and moved into place, a cook that dies half way must not leave a blob with a valid header.
+        const LargeString tempPath = StringFormat::Large("%s.tmp", item.cookedPath.GetCStr());
+        std::ofstream file(tempPath.GetCStr(), std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            ATTOERROR("Could not open file %s", tempPath.GetCStr());
+            return false;
+        }
+
+        file.write((const char*)blob.GetData(), blob.GetNum());
+        file.close();
+        if (file.fail()) {
+            ATTOERROR("Could not write %s", tempPath.GetCStr());
+            return false;
+        }
+
+        std::filesystem::rename(tempPath.GetCStr(), cookedPath, error);
+        if (error) {
+            ATTOERROR("Could not move %s into place", tempPath.GetCStr());
+            return false;
+        }
+
+        return true;
+    }
+
+    // Job entry point, userData is the CookContext.
+    static void CookItemJob(i32 index, void* userData) {
+        CookContext& context = *(CookContext*)userData;
+        CookItem& item = context.items[index];
+
+        if (item.source.type == ASSET_TYPE_AUDIO) {
+            item.result = COOK_RESULT_PASS_THROUGH;
+            return;
+        }
+
+        if (context.force == false && CookIsUpToDate(item, context.settings)) {
+            item.result = COOK_RESULT_UP_TO_DATE;
+            return;
+        }
+
+        MappedFile source;
+        if (source.Open(item.source.path.GetCStr()) == false) {
+            item.result = COOK_RESULT_FAILED;
+            return;
+        }
+
+        List<byte> blob;
+        if (CookAsset(item.source.type, item.source.path.GetCStr(), source.GetData(), source.GetSize(), item.source.writeTime, context.settings, blob) == false) {
+            item.result = COOK_RESULT_FAILED;
+            return;
+        }
+
+        item.result = CookWriteBlob(item, blob) ? COOK_RESULT_COOKED : COOK_RESULT_FAILED;
+        if (item.result == COOK_RESULT_COOKED) {
+            ATTOINFO("Cooked %s", item.source.path.GetCStr());
+        }
+    }
+
+    static void CookScan(const char* assetRoot, const char* cacheRoot, List<CookItem>& items) {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(assetRoot)) {
+            if (entry.is_regular_file() == false) {
+                continue;
+            }
+
+            const AssetType type = AssetTypeFromExtension(entry.path().extension().string().c_str());
+            if (type == ASSET_TYPE_INVALID) {
+                continue;
+            }
+
+            // Same path and id rules as the engine's loose asset scan.
+            LargeString path = LargeString::FromLiteral(entry.path().string().c_str());
+            path.BackSlashesToSlashes();
+
+            CookItem item = {};
+            item.source.type = type;
+            item.source.path = StringAtom::Intern(path.GetCStr());
+            item.source.id = AssetIdFromPath(path.GetCStr());
+            item.source.sizeBytes = (u64)entry.file_size();
+            item.source.writeTime = (i64)entry.last_write_time().time_since_epoch().count();
+            LargeString relativePath = LargeString::FromLiteral(entry.path().lexically_relative(assetRoot).string().c_str());
+            relativePath.BackSlashesToSlashes();
+            item.cookedPath = StringFormat::Large("%s%s.cooked", cacheRoot, relativePath.GetCStr());
+            items.Add(item);
+        }
+    }
+
+    static bool CookWritePack(const char* packPath, const List<CookItem>& items, LZLevel compression) {
+        AssetPackWriter writer;
+        if (writer.Begin(packPath, compression) == false) {
+            return false;
+        }
+
+        List<byte> blob;
+        const i32 itemCount = items.GetNum();
+        for (i32 itemIndex = 0; itemIndex < itemCount; itemIndex++) {
+            const CookItem& item = items[itemIndex];
+            const bool useCooked = item.result == COOK_RESULT_UP_TO_DATE || item.result == COOK_RESULT_COOKED;
+
+            MappedFile payload;
+            if (payload.Open(useCooked ? item.cookedPath.GetCStr() : item.source.path.GetCStr()) == false) {
+                return false;
+            }
+
+            const byte* data = payload.GetData();
+            if (useCooked && payload.GetSize() >= sizeof(CookedAssetHeader)) {
+                // The write time is only for the cache. Without it byte identical sources cook to byte identical
+                // blobs, which the pack stores once.
+                blob.SetNum((i32)payload.GetSize());
+                memcpy(blob.GetData(), payload.GetData(), payload.GetSize());
+                ((CookedAssetHeader*)blob.GetData())->sourceWriteTime = 0;
+                data = blob.GetData();
+            }
+
+            if (writer.Add(item.source.id, item.source.type, item.source.path.GetCStr(), data, payload.GetSize()) == false) {
+                return false;
+            }
+        }
+
+        if (writer.End() == false) {
+            return false;
+        }
+
+        ATTOINFO("Wrote %s, %.2f MB of payloads stored in %.2f MB (%s)", packPath,
+            (f64)writer.GetRawBytes() / (1024.0 * 1024.0), (f64)writer.GetStoredBytes() / (1024.0 * 1024.0), LZLevelToString(compression));
+        if (writer.GetDuplicateCount() > 0) {
+            ATTOINFO("%d duplicate payloads stored once, %.2f MB saved", writer.GetDuplicateCount(), (f64)writer.GetDuplicateBytes() / (1024.0 * 1024.0));
+        }
+
+        return true;
+    }
+}
+
+using namespace atto;
+
+int main(const int argc, const char** argv) {
+    // Logger keeps its whole message buffer inline, megabytes that don't fit on the main thread's stack.
+    static Logger logger;
+    Memory::Initialize(Megabytes(1), Megabytes(256));
+
+    LargeString assetRoot = LargeString::FromLiteral("assets/");
+    LargeString packPath = LargeString::FromLiteral("assets.pack");
+    LargeString cacheRoot = {};
+    i32 workerCount = -1;
+    bool force = false;
+    LZLevel compression = LZ_LEVEL_FAST;
+    CookSettings settings = {};
+    for (i32 argIndex = 1; argIndex < argc; argIndex++) {
+        const char* arg = argv[argIndex];
+        const bool hasValue = argIndex + 1 < argc;
+        if (strcmp(arg, "-root") == 0 && hasValue) {
+            assetRoot = LargeString::FromLiteral(argv[++argIndex]);
+        }
+        else if (strcmp(arg, "-out") == 0 && hasValue) {
+            packPath = LargeString::FromLiteral(argv[++argIndex]);
+        }
+        else if (strcmp(arg, "-cache") == 0 && hasValue) {
+            cacheRoot = LargeString::FromLiteral(argv[++argIndex]);
+        }
+        else if (strcmp(arg, "-jobs") == 0 && hasValue) {
+            workerCount = atoi(argv[++argIndex]);
+        }
+        else if (strcmp(arg, "-force") == 0) {
+            force = true;
+        }
+        else if (strcmp(arg, "-overdraw") == 0) {
+            settings.meshOptimize.flags |= MESH_OPTIMIZE_OVERDRAW;
+        }
+        else if (strcmp(arg, "-meshstats") == 0) {
+            settings.meshOptimize.report = true;
+        }
+        else if (strcmp(arg, "-vertexformat") == 0 && hasValue) {
+            const char* formatName = argv[++argIndex];
+            settings.meshVertexFormat = MESH_VERTEX_FORMAT_COUNT;
+            for (u32 format = 0; format < MESH_VERTEX_FORMAT_COUNT; format++) {
+                if (strcmp(formatName, MeshVertexFormatToString((MeshVertexFormat)format)) == 0) {
+                    settings.meshVertexFormat = (MeshVertexFormat)format;
+                }
+            }
+            if (settings.meshVertexFormat == MESH_VERTEX_FORMAT_COUNT) {
+                ATTOERROR("Unknown vertex format %s", formatName);
+                return 1;
+            }
+        }
+        else if (strcmp(arg, "-mipfilter") == 0 && hasValue) {
+            const char* filterName = argv[++argIndex];
+            settings.textureMips = strcmp(filterName, "none") != 0;
+            settings.textureMipSettings.filter = settings.textureMips ? TEXTURE_MIP_FILTER_COUNT : TEXTURE_MIP_FILTER_KAISER;
+            for (u32 filter = 0; filter < TEXTURE_MIP_FILTER_COUNT; filter++) {
+                if (strcmp(filterName, TextureMipFilterToString((TextureMipFilter)filter)) == 0) {
+                    settings.textureMipSettings.filter = (TextureMipFilter)filter;
+                }
+            }
+            if (settings.textureMipSettings.filter == TEXTURE_MIP_FILTER_COUNT) {
+                ATTOERROR("Unknown mip filter %s", filterName);
+                return 1;
+            }
+        }
+        else if (strcmp(arg, "-linearmips") == 0) {
+            settings.textureMipSettings.srgb = false;
+        }
+        else if (strcmp(arg, "-texformat") == 0 && hasValue) {
+            const char* formatName = argv[++argIndex];
+            settings.textureFormat = TEXTURE_FORMAT_COUNT;
+            for (u32 format = 0; format < TEXTURE_FORMAT_COUNT; format++) {
+                if (strcmp(formatName, TextureFormatToString((TextureFormat)format)) == 0) {
+                    settings.textureFormat = (TextureFormat)format;
+                }
+            }
+            if (settings.textureFormat == TEXTURE_FORMAT_COUNT) {
+                ATTOERROR("Unknown texture format %s", formatName);
+                return 1;
+            }
+        }
+        else if (strcmp(arg, "-texquality") == 0 && hasValue) {
+            const char* qualityName = argv[++argIndex];
+            settings.textureCompressQuality = TEXTURE_COMPRESS_QUALITY_COUNT;
+            for (u32 quality = 0; quality < TEXTURE_COMPRESS_QUALITY_COUNT; quality++) {
+                if (strcmp(qualityName, TextureCompressQualityToString((TextureCompressQuality)quality)) == 0) {
+                    settings.textureCompressQuality = (TextureCompressQuality)quality;
+                }
+            }
+            if (settings.textureCompressQuality == TEXTURE_COMPRESS_QUALITY_COUNT) {
+                ATTOERROR("Unknown texture quality %s", qualityName);
+                return 1;
+            }
+        }
+        else if (strcmp(arg, "-texstats") == 0) {
+            settings.textureReport = true;
+        }
+        else if (strcmp(arg, "-compress") == 0 && hasValue) {
+            const char* levelName = argv[++argIndex];
+            compression = LZ_LEVEL_COUNT;
+            for (u32 level = 0; level < LZ_LEVEL_COUNT; level++) {
+                if (strcmp(levelName, LZLevelToString((LZLevel)level)) == 0) {
+                    compression = (LZLevel)level;
+                }
+            }
+            if (compression == LZ_LEVEL_COUNT) {
+                ATTOERROR("Unknown compression level %s", levelName);
+                return 1;
+            }
+        }
+        else {
+            ATTOERROR("Usage: AttoCook [-root assets/] [-out assets.pack] [-cache assets.cooked/] [-jobs N] [-force] [-overdraw] [-meshstats] "
+                "[-vertexformat pnt|quantized|half] [-mipfilter box|kaiser|lanczos|none] [-linearmips] "
+                "[-texformat rgba8|bc1|bc3|bc4|bc7] [-texquality fast|default|best] [-texstats] [-compress none|fast|high]");
+            return 1;
+        }
+    }
+
+    // Defaults to a sibling of the asset root, like the asset manifest.
+    if (cacheRoot.GetLength() == 0) {
+        i32 rootLength = assetRoot.GetLength();
+        while (rootLength > 0 && (assetRoot.GetCStr()[rootLength - 1] == '/' || assetRoot.GetCStr()[rootLength - 1] == '\\')) {
+            rootLength--;
+        }
+        cacheRoot = StringFormat::Large("%.*s.cooked/", rootLength, assetRoot.GetCStr());
+    }
+
+    std::error_code error;
+    if (std::filesystem::is_directory(assetRoot.GetCStr(), error) == false) {
+        ATTOERROR("Asset root %s does not exist", assetRoot.GetCStr());
+        return 1;
+    }
+
+    const std::chrono::high_resolution_clock::time_point cookStart = std::chrono::high_resolution_clock::now();
+
+    Jobs::Initialize(workerCount);
+
+    CookContext context = {};
+    context.force = force;
+    context.settings = settings;
+    CookScan(assetRoot.GetCStr(), cacheRoot.GetCStr(), context.items);
+    Jobs::ParallelFor(context.items.GetNum(), CookItemJob, &context);
+
+    i32 resultCounts[COOK_RESULT_FAILED + 1] = {};
+    const i32 itemCount = context.items.GetNum();
+    for (i32 itemIndex = 0; itemIndex < itemCount; itemIndex++) {
+        resultCounts[context.items[itemIndex].result]++;
+    }
+
+    const bool packWritten = CookWritePack(packPath.GetCStr(), context.items, compression);
+
+    const f64 cookMS = (f64)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - cookStart).count() / 1000.0;
+    ATTOINFO("%d assets, %d cooked, %d up to date, %d packed as is, %d failed, %d threads, %.2f ms",
+        itemCount, resultCounts[COOK_RESULT_COOKED], resultCounts[COOK_RESULT_UP_TO_DATE], resultCounts[COOK_RESULT_PASS_THROUGH],
+        resultCounts[COOK_RESULT_FAILED], Jobs::GetWorkerCount() + 1, cookMS);
+
+    Jobs::Shutdown();
+    Memory::Shutdown();
+
+    return packWritten && resultCounts[COOK_RESULT_FAILED] == 0 ? 0 : 1;
+}
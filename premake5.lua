@@ -95,6 +95,115 @@ project "Atto"
         links { "assimp" }
         
 
+project "AttoCook"
+    location("cook")
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+    exceptionhandling "Off"
+    rtti "Off"
+    warnings "Default"
+    flags { "FatalWarnings", "MultiProcessorCompile" }
+    debugdir "bin"
+
+    targetdir("bin/%{cfg.architecture}")
+    -- Own object directory, both projects have a Main.cpp.
+    objdir("tmp/%{cfg.architecture}/cook")
+
+    disablewarnings { 
+        "4100", -- Unused formal parameter.
+    }
+
+    includedirs
+    {
+        path.join(ASSIMP_DIR, "include"),
+        STB_DIR,
+        GLM_DIR,
+        "atto/src/"
+    }
+
+    libdirs
+    {
+        path.join(ASSIMP_DIR, "lib"),
+    }
+
+    -- Only the engine files that don't need a window or a device.
+    files {
+        "cook/src/**.h",
+        "cook/src/**.cpp",
+        "atto/src/AttoAssetCooked.cpp",
+        "atto/src/AttoAssetImport.cpp",
+        "atto/src/AttoAssetPack.cpp",
+        "atto/src/AttoCompression.cpp",
+        "atto/src/AttoContainers.cpp",
+        "atto/src/AttoJobs.cpp",
+        "atto/src/AttoLog.cpp",
+        "atto/src/AttoMappedFile.cpp",
+        "atto/src/AttoMemory.cpp",
+        "atto/src/AttoMeshOptimize.cpp",
+        "atto/src/AttoMeshQuantize.cpp",
+        "atto/src/AttoTextureCompress.cpp",
+        "atto/src/AttoTextureMips.cpp",
+    }
+
+    links { "assimp" }
+
+project "AttoBench"
+    location("bench")
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+    exceptionhandling "Off"
+    rtti "Off"
+    warnings "Default"
+    flags { "FatalWarnings", "MultiProcessorCompile" }
+    debugdir "bin"
+
+    targetdir("bin/%{cfg.architecture}")
+    objdir("tmp/%{cfg.architecture}/bench")
+
+    disablewarnings { 
+        "4100", -- Unused formal parameter.
+    }
+
+    includedirs
+    {
+        path.join(ASSIMP_DIR, "include"),
+        STB_DIR,
+        GLM_DIR,
+        "atto/src/"
+    }
+
+    libdirs
+    {
+        path.join(ASSIMP_DIR, "lib"),
+    }
+
+    -- The cooker's files plus AsyncIO, everything runs headless so the checks can gate a build on any platform.
+    files {
+        "bench/src/**.h",
+        "bench/src/**.cpp",
+        "atto/src/AttoAssetCooked.cpp",
+        "atto/src/AttoAssetImport.cpp",
+        "atto/src/AttoAssetPack.cpp",
+        "atto/src/AttoAsyncIO.cpp",
+        "atto/src/AttoCompression.cpp",
+        "atto/src/AttoContainers.cpp",
+        "atto/src/AttoJobs.cpp",
+        "atto/src/AttoLog.cpp",
+        "atto/src/AttoMappedFile.cpp",
+        "atto/src/AttoMemory.cpp",
+        "atto/src/AttoMeshOptimize.cpp",
+        "atto/src/AttoMeshQuantize.cpp",
+        "atto/src/AttoTextureCompress.cpp",
+        "atto/src/AttoTextureMips.cpp",
+    }
+
+    links { "assimp" }
+
+    filter "system:linux"
+        links { "pthread" }
+
 project "glfw"
     location(GLFW_DIR)
     kind "StaticLib"